@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace tch {
+
+// 自动化服务：按行接收JSON-RPC 2.0请求，在内存中的多个文档上执行open/command/query/export/close。
+// 不同文档的请求在工作线程上并发处理，同一文档的请求按到达顺序依次执行；响应按完成顺序返回，以id对应请求
+class AutomationServer {
+public:
+    static constexpr std::size_t kMaxRequestLength = 64 * 1024 * 1024; // 单行请求的最大长度
+
+    // 从标准输入读取请求，响应写到标准输出，输入结束或收到shutdown后返回进程退出码
+    static int runStdio();
+
+    // 在Unix域套接字上监听，每个连接一个读取线程，收到shutdown后返回进程退出码
+    static int runSocket(const std::string& socketPath);
+
+private:
+    // 私有构造函数，防止实例化
+    AutomationServer() {}
+};
+
+} // namespace tch
@@ -0,0 +1,55 @@
+#pragma once
+#include "Progress.h"
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace tch {
+
+class Document;
+
+// 后台命令：耗时的命令（加载、导出、阵列等）在工作线程上持有文档的读锁执行，进度显示在状态栏，Esc取消，
+// 结果回到主线程持有写锁提交。同一时刻只有一个后台命令，执行期间其他命令被拒绝，文档不会被修改
+class BackgroundCommand {
+public:
+    // 在主线程上提交结果，输出消息并返回命令是否成功
+    using Commit = std::function<bool()>;
+    
+    // 在工作线程上执行的部分：只读取文档，不输出消息，定期检查progress是否已取消，返回提交结果的函数
+    using Work = std::function<Commit(ProgressMonitor& progress)>;
+    
+    // 启用后台执行，只在交互界面的主循环开始前启用；未启用时（脚本、无界面模式、自动化服务）命令在当前线程上同步执行
+    static void setAsyncEnabled(bool enabled);
+    
+    // 执行命令。后台执行时立即返回true，结果在之后的poll中提交
+    static bool run(const std::string& name, std::shared_ptr<Document> document, Work work);
+    
+    // 是否有后台命令正在执行，只在主线程上调用
+    static bool isRunning();
+    
+    // 请求取消正在执行的后台命令，没有正在执行的命令时返回false
+    static bool cancel();
+    
+    // 主线程每帧调用一次：后台命令完成后提交结果
+    static void poll();
+    
+    // 取消并等待正在执行的后台命令结束，程序退出前调用
+    static void shutdown();
+    
+    // 正在执行的后台命令名称
+    static const std::string& getName();
+    
+    // 正在执行的后台命令的完成比例
+    static float getProgress();
+
+private:
+    struct Task;
+    
+    // 私有构造函数，防止实例化
+    BackgroundCommand() {}
+    
+    static bool s_asyncEnabled;          // 是否启用后台执行
+    static std::unique_ptr<Task> s_task; // 正在执行的后台命令
+};
+
+} // namespace tch
@@ -1,93 +1,139 @@
 #pragma once
+#include "command/CommandTokenizer.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tch {
 
+struct CommandDesc;
+
 // 命令解析器
 class CommandParser {
 public:
     // 解析命令
-    static bool parseCommand(const std::string& command);
+    static bool parseCommand(std::string_view command);
     
     // 执行命令
     static bool executeCommand(const std::string& commandName, const std::vector<std::string>& arguments);
     
     // 显示帮助信息
     static void showHelp();
+    
+    // 补全命令名，返回以prefix开头的命令名与别名
+    static std::vector<std::string> completeCommand(const std::string& prefix);
+    
+    // 按命令名或别名查找命令（不区分大小写），找不到时返回空
+    static const CommandDesc* findCommand(std::string_view name);
 
 private:
-    // 分割命令行参数
-    static std::vector<std::string> splitArguments(const std::string& command);
+    // 按规范化的命令名分发命令
+    static bool dispatchCommand(std::string_view normalizedName, CommandArgs arguments);
+    
+    // 注册内置命令，首次分发前调用，线程安全
+    static void registerBuiltinCommands();
+    
+    // 注册内置命令的实际实现，只执行一次
+    static void registerBuiltinCommandsOnce();
+    
+    // 标记当前文档内容已变更
+    static void markCurrentDocumentModified();
     
     // 执行绘制直线命令
-    static bool executeLineCommand(const std::vector<std::string>& arguments);
+    static bool executeLineCommand(CommandArgs arguments);
     
     // 执行绘制圆命令
-    static bool executeCircleCommand(const std::vector<std::string>& arguments);
+    static bool executeCircleCommand(CommandArgs arguments);
     
     // 执行绘制矩形命令
-    static bool executeRectCommand(const std::vector<std::string>& arguments);
+    static bool executeRectCommand(CommandArgs arguments);
+    
+    // 执行选择命令
+    static bool executeSelectCommand(CommandArgs arguments);
+    
+    // 执行快速选择命令
+    static bool executeQuickSelectCommand(CommandArgs arguments);
     
     // 执行平移命令
-    static bool executeTranslateCommand(const std::vector<std::string>& arguments);
+    static bool executeTranslateCommand(CommandArgs arguments);
     
     // 执行旋转命令
-    static bool executeRotateCommand(const std::vector<std::string>& arguments);
+    static bool executeRotateCommand(CommandArgs arguments);
     
     // 执行缩放命令
-    static bool executeScaleCommand(const std::vector<std::string>& arguments);
+    static bool executeScaleCommand(CommandArgs arguments);
+    
+    // 执行阵列命令
+    static bool executeArrayCommand(CommandArgs arguments);
     
     // 执行创建图层命令
-    static bool executeLayerCommand(const std::vector<std::string>& arguments);
+    static bool executeLayerCommand(CommandArgs arguments);
     
     // 执行删除图层命令
-    static bool executeDeleteLayerCommand(const std::vector<std::string>& arguments);
+    static bool executeDeleteLayerCommand(CommandArgs arguments);
     
     // 执行切换图层命令
-    static bool executeSwitchLayerCommand(const std::vector<std::string>& arguments);
+    static bool executeSwitchLayerCommand(CommandArgs arguments);
     
     // 执行设置颜色命令
-    static bool executeColorCommand(const std::vector<std::string>& arguments);
+    static bool executeColorCommand(CommandArgs arguments);
     
     // 执行撤销命令
-    static bool executeUndoCommand(const std::vector<std::string>& arguments);
+    static bool executeUndoCommand(CommandArgs arguments);
     
     // 执行重做命令
-    static bool executeRedoCommand(const std::vector<std::string>& arguments);
+    static bool executeRedoCommand(CommandArgs arguments);
+    
+    // 执行开始事务命令
+    static bool executeBeginCommand(CommandArgs arguments);
+    
+    // 执行提交事务命令
+    static bool executeEndCommand(CommandArgs arguments);
     
     // 执行加载命令
-    static bool executeLoadCommand(const std::vector<std::string>& arguments);
+    static bool executeLoadCommand(CommandArgs arguments);
+    
+    // 执行导出命令
+    static bool executeExportCommand(CommandArgs arguments);
     
     // 执行退出命令
-    static bool executeExitCommand(const std::vector<std::string>& arguments);
+    static bool executeExitCommand(CommandArgs arguments);
     
     // 执行属性栏命令
-    static bool executePropertiesCommand(const std::vector<std::string>& arguments);
+    static bool executePropertiesCommand(CommandArgs arguments);
     
     // 执行关闭属性栏命令
-    static bool executePropertiesCloseCommand(const std::vector<std::string>& arguments);
+    static bool executePropertiesCloseCommand(CommandArgs arguments);
     
     // 执行选项命令
-    static bool executeOptionsCommand(const std::vector<std::string>& arguments);
+    static bool executeOptionsCommand(CommandArgs arguments);
     
     // 执行帮助命令
-    static bool executeHelpCommand(const std::vector<std::string>& arguments);
+    static bool executeHelpCommand(CommandArgs arguments);
     
     // 执行新建文件命令
-    static bool executeNewCommand(const std::vector<std::string>& arguments);
+    static bool executeNewCommand(CommandArgs arguments);
     
     // 执行打开文件命令
-    static bool executeOpenCommand(const std::vector<std::string>& arguments);
+    static bool executeOpenCommand(CommandArgs arguments);
     
     // 执行保存文件命令
-    static bool executeSaveCommand(const std::vector<std::string>& arguments);
+    static bool executeSaveCommand(CommandArgs arguments);
     
     // 执行另存为命令
-    static bool executeSaveAsCommand(const std::vector<std::string>& arguments);
+    static bool executeSaveAsCommand(CommandArgs arguments);
     
     // 执行关闭文件命令
-    static bool executeCloseCommand(const std::vector<std::string>& arguments);
+    static bool executeCloseCommand(CommandArgs arguments);
+    
+    // 执行按键绑定命令
+    static bool executeBindCommand(CommandArgs arguments);
+    
+    // 执行解除按键绑定命令
+    static bool executeUnbindCommand(CommandArgs arguments);
+    
+    // 执行重新加载按键绑定命令
+    static bool executeKeymapCommand(CommandArgs arguments);
 };
 
 } // namespace tch
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+#include "command/CommandTokenizer.h"
+#include "command/InteractiveTool.h"
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tch {
+
+// 命令处理函数，参数不含命令名
+using CommandHandler = std::function<bool(CommandArgs)>;
+
+// 交互工具工厂，创建不带参数执行命令时逐步取点的协程
+using ToolFactory = std::function<ToolTask()>;
+
+// 命令描述
+struct CommandDesc {
+    static constexpr std::size_t kUnlimitedArgs = std::numeric_limits<std::size_t>::max();
+    
+    std::string name;                 // 命令名
+    std::vector<std::string> aliases; // 别名
+    std::size_t minArgs = 0;          // 最少参数个数
+    std::size_t maxArgs = 0;          // 最多参数个数
+    std::string usage;                // 参数说明，如"X1 Y1 X2 Y2"
+    std::string help;                 // 帮助文本
+    CommandHandler handler;           // 处理函数
+    bool uiOnly = false;              // 依赖界面或文件标签页，在线程绑定的文档（自动化服务）上不可用
+    bool transparent = false;         // 不修改文档，可以在交互工具等待输入时执行而不中断工具
+    ToolFactory tool;                 // 交互工具，不带参数执行时在交互界面中启动，为空表示不支持
+};
+
+// 命令注册表：命令名与别名统一规范化为大写后存入哈希表，分发只需一次查找
+class CommandRegistry {
+public:
+    // 注册命令，名称或别名与已有命令冲突时返回false
+    static bool registerCommand(CommandDesc desc);
+    
+    // 按规范化（大写）名称或别名查找命令，未找到返回nullptr
+    static const CommandDesc* find(std::string_view normalizedName);
+    
+    // 获取全部命令，按注册顺序排列
+    static const std::vector<CommandDesc>& getCommands();
+    
+    // 补全：返回以prefix开头的命令名与别名，按字典序排列
+    static std::vector<std::string> complete(std::string_view prefix);
+    
+    // 规范化命令名（转为大写）
+    static std::string normalize(std::string_view name);
+    
+    // 格式化命令用法，如"LINE X1 Y1 X2 Y2"
+    static std::string formatUsage(const CommandDesc& desc);
+
+private:
+    // 字符串哈希，支持以string_view直接查找
+    struct KeyHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>{}(key);
+        }
+    };
+    
+    // 私有构造函数，防止实例化
+    CommandRegistry() {}
+    
+    static std::vector<CommandDesc> s_commands;                                                 // 命令列表
+    static std::unordered_map<std::string, std::size_t, KeyHash, std::equal_to<>> s_lookup;     // 名称/别名到命令下标的映射
+    static std::vector<std::string> s_sortedKeys;                                               // 排序后的名称与别名，用于补全
+};
+
+} // namespace tch
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace tch {
+
+// 命令参数：指向原始命令行的只读视图，处理函数执行期间有效
+using CommandArgs = std::span<const std::string_view>;
+
+// 命令行解析错误
+enum class ParseError {
+    None,              // 无错误
+    Empty,             // 空参数
+    InvalidNumber,     // 不是有效的数值
+    OutOfRange,        // 数值超出范围
+    InvalidPoint,      // 不是有效的坐标（x,y 或 @dx,dy）
+    UnterminatedQuote, // 引号未闭合
+    MissingArgument,   // 缺少参数
+    ExtraArgument      // 多余的参数
+};
+
+// 坐标参数
+struct PointToken {
+    glm::vec2 value{0.0f}; // 坐标值
+    bool relative = false; // 是否为相对坐标（@dx,dy）
+};
+
+// 词法单元缓冲区：前kInlineCapacity个单元存放在对象内部，超出后才转存到堆上
+class TokenBuffer {
+public:
+    static constexpr std::size_t kInlineCapacity = 16;
+    
+    // 追加一个单元
+    void push(std::string_view token);
+    
+    // 清空
+    void clear();
+    
+    // 单元个数
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    
+    // 获取第index个单元
+    std::string_view operator[](std::size_t index) const { return data()[index]; }
+    
+    // 获取全部单元
+    CommandArgs tokens() const { return CommandArgs(data(), m_size); }
+
+private:
+    const std::string_view* data() const { return m_overflow.empty() ? m_inline.data() : m_overflow.data(); }
+    
+    std::array<std::string_view, kInlineCapacity> m_inline; // 内部存储
+    std::vector<std::string_view> m_overflow;              // 超出内部容量后的存储
+    std::size_t m_size = 0;                                 // 单元个数
+};
+
+// 命令行词法分析与数值解析：单元为指向原始命令行的视图，不超过内部容量时不分配内存，出错时返回错误码而不抛出异常
+namespace CommandTokenizer {
+    // 按空白分割命令行，双引号内的空白不分割（引号不计入单元）
+    ParseError tokenize(std::string_view line, TokenBuffer& out);
+    
+    // 解析数值，整个单元必须是有效的有限数值
+    ParseError parseNumber(std::string_view token, float& out);
+    
+    // 解析整数，整个单元必须是有效的十进制整数
+    ParseError parseInteger(std::string_view token, int& out);
+    
+    // 解析坐标：x,y 为绝对坐标，@dx,dy 为相对上一个点的坐标
+    ParseError parsePoint(std::string_view token, PointToken& out);
+    
+    // 单元是否为坐标写法（含逗号或以@开头）
+    bool isPointToken(std::string_view token);
+    
+    // 获取错误描述
+    const char* describeError(ParseError error);
+} // namespace CommandTokenizer
+
+} // namespace tch
@@ -0,0 +1,19 @@
+#pragma once
+#include "command/InteractiveTool.h"
+
+namespace tch {
+
+// 绘图命令的交互工具：不带参数输入LINE、CIRCLE、RECT时启动，逐步取点后以完整参数执行对应的命令，
+// 撤销步骤与修改标记和直接在命令行输入参数时一致
+namespace DrawingTools {
+    // 直线：连续取点画线，Undo撤销上一段，Close闭合到第一个点，空输入结束
+    ToolTask line();
+    
+    // 圆：圆心与半径，Diameter改为输入直径
+    ToolTask circle();
+    
+    // 矩形：两个对角点
+    ToolTask rect();
+} // namespace DrawingTools
+
+} // namespace tch
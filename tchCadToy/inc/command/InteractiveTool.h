@@ -0,0 +1,184 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace tch {
+
+class Document;
+
+// 交互工具收到的输入类型
+enum class ToolInputKind {
+    None,     // 空输入（直接回车），通常表示结束
+    Point,    // 点：鼠标点击或命令栏输入的坐标
+    Distance, // 距离：数值，或点到基点的距离
+    Keyword   // 关键字：提示中列出的选项之一
+};
+
+// 交互工具收到的输入
+struct ToolInput {
+    ToolInputKind kind = ToolInputKind::None; // 输入类型
+    glm::vec2 point{0.0f};                    // kind为Point时的点
+    float distance = 0.0f;                    // kind为Distance时的距离
+    std::string keyword;                      // kind为Keyword时的关键字（大写）
+};
+
+// 交互工具等待的输入
+struct ToolRequest {
+    ToolInputKind kind = ToolInputKind::Point; // 等待的输入类型：Point或Distance
+    std::string prompt;                        // 显示在命令栏的提示
+    std::optional<glm::vec2> base;             // 相对坐标（@dx,dy）与距离的基点，为空时为文档中上一个输入的点
+    std::vector<std::string> keywords;         // 可选的关键字（大写），输入唯一前缀即可
+};
+
+// 交互工具：以C++20协程编写的命令，每次co_await一个输入时挂起，由ToolScheduler在输入到达后恢复。
+// 等待期间不占用任何每帧开销，取消时销毁协程帧，局部变量随之析构
+class ToolTask {
+public:
+    struct promise_type {
+        ToolTask get_return_object() {
+            return ToolTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        
+        // 创建后先挂起，由调度器在主循环中首次恢复
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        
+        // 结束后保持挂起，由调度器销毁
+        std::suspend_always final_suspend() noexcept { return {}; }
+        
+        void return_void() {}
+        
+        // 异常保存到调度器恢复之后再处理
+        void unhandled_exception() { exception = std::current_exception(); }
+        
+        std::exception_ptr exception; // 工具执行中抛出的异常
+    };
+    
+    using Handle = std::coroutine_handle<promise_type>;
+    
+    explicit ToolTask(Handle handle) : m_handle(handle) {}
+    ToolTask(ToolTask&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    ToolTask(const ToolTask&) = delete;
+    ToolTask& operator=(const ToolTask&) = delete;
+    ToolTask& operator=(ToolTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    ~ToolTask() { reset(); }
+    
+    // 恢复执行，直到下一次co_await或结束
+    void resume() { m_handle.resume(); }
+    
+    // 是否已结束
+    bool done() const { return !m_handle || m_handle.done(); }
+    
+    // 执行中抛出的异常，未抛出时为空
+    std::exception_ptr exception() const { return m_handle ? m_handle.promise().exception : nullptr; }
+    
+    // 销毁协程帧
+    void reset() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = {};
+        }
+    }
+
+private:
+    Handle m_handle; // 协程句柄
+};
+
+// 等待输入的awaiter：挂起时向调度器登记请求，恢复时取回调度器收到的输入
+struct ToolInputAwaiter {
+    ToolRequest request; // 等待的输入
+    
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<>);
+    ToolInput await_resume();
+};
+
+// 交互工具调度器：同一时刻只有一个交互工具。输入（命令栏文本或画布上的鼠标点击）只登记下来，
+// 由主循环每帧调用的poll在绘制之前恢复工具，工具中的业务逻辑不在输入回调或界面绘制中执行
+class ToolScheduler {
+public:
+    // 启用交互工具，只在交互界面的主循环开始前启用；未启用时（脚本、无界面模式、自动化服务）不带参数的绘图命令只输出用法
+    static void setEnabled(bool enabled);
+    
+    // 是否启用交互工具
+    static bool isEnabled();
+    
+    // 启动交互工具，取代正在执行的工具；工具在下一次poll时开始执行
+    static bool start(const std::string& name, ToolTask task);
+    
+    // 是否有交互工具正在执行
+    static bool isActive();
+    
+    // 是否正在执行交互工具自身的代码（poll恢复工具期间），此时执行的命令属于工具
+    static bool isResuming();
+    
+    // 当前交互工具的名称，没有交互工具时为空
+    static const std::string& getName();
+    
+    // 当前的提示，没有交互工具时为空
+    static const std::string& getPrompt();
+    
+    // 提交命令栏输入：解析为等待的点、距离或关键字，空文本表示结束；
+    // 无法解析时若为透明命令（不修改文档的命令）则直接执行，工具继续等待。工具未在等待输入时返回false
+    static bool submitText(std::string_view text);
+    
+    // 提交画布上点击的点，等待距离时换算为到基点的距离；工具未在等待点或距离时返回false
+    static bool submitPoint(const glm::vec2& point);
+    
+    // 取消正在执行的交互工具，没有交互工具时返回false
+    static bool cancel();
+    
+    // 主循环每帧调用一次：有输入时恢复交互工具；当前文件切换后取消工具
+    static void poll();
+    
+    // 等待一个点
+    static ToolInputAwaiter getPoint(std::string prompt, std::optional<glm::vec2> base = std::nullopt, std::vector<std::string> keywords = {});
+    
+    // 等待一个距离，可以输入数值或点（到基点的距离）
+    static ToolInputAwaiter getDistance(std::string prompt, const glm::vec2& base, std::vector<std::string> keywords = {});
+
+private:
+    friend struct ToolInputAwaiter;
+    
+    // 私有构造函数，防止实例化
+    ToolScheduler() {}
+    
+    // 登记工具等待的输入
+    static void beginWait(ToolRequest request);
+    
+    // 取回收到的输入
+    static ToolInput takeInput();
+    
+    // 登记收到的输入，在下一次poll时恢复工具
+    static void deliver(ToolInput input);
+    
+    // 解析命令栏输入，无法解析时返回false
+    static bool parseInput(std::string_view text, ToolInput& out);
+    
+    // 结束工具并销毁协程帧
+    static void finish();
+    
+    static bool s_enabled;                      // 是否启用交互工具
+    static std::optional<ToolTask> s_task;      // 正在执行的工具
+    static std::string s_name;                  // 工具名（启动工具的命令名）
+    static std::shared_ptr<Document> s_document; // 工具启动时的当前文档
+    static ToolRequest s_request;               // 工具等待的输入
+    static ToolInput s_input;                   // 收到的输入
+    static bool s_waiting;                      // 工具是否在等待输入
+    static bool s_resumePending;                // 下一次poll时是否恢复工具
+    static bool s_resuming;                     // 是否正在恢复工具
+};
+
+} // namespace tch
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tch {
+
+// 脚本执行结果
+struct ScriptResult {
+    // 失败的命令
+    struct Failure {
+        std::size_t line = 0; // 行号，从1开始
+        std::string command;  // 命令文本
+        std::string message;  // 命令的最后一条输出
+    };
+    
+    std::size_t commands = 0;        // 执行的命令数
+    std::size_t failedCommands = 0;  // 失败的命令数
+    double seconds = 0.0;            // 执行耗时（秒），不含读取文件
+    std::vector<Failure> failures;   // 失败命令明细，最多保留ScriptRunner::kMaxReportedFailures条
+    std::deque<std::string> output;  // 最近的命令输出，最多保留ScriptRunner::kMaxDeferredOutput条
+    std::size_t totalOutput = 0;     // 命令输出总条数
+    
+    // 每秒执行的命令数
+    double commandsPerSecond() const;
+    
+    // 一行摘要，包含命令数、失败数与吞吐量
+    std::string summary() const;
+};
+
+// 脚本执行器：逐行把命令直接交给CommandParser，不经过命令栏。
+// 执行期间命令输出只做收集，不更新命令历史与界面，结束后由调用方统一发布
+class ScriptRunner {
+public:
+    static constexpr std::size_t kMaxReportedFailures = 20; // 保留的失败明细条数
+    static constexpr std::size_t kMaxDeferredOutput = 200;  // 保留的最近输出条数
+    
+    // 执行脚本文件
+    static bool runFile(const std::string& scriptPath, ScriptResult& result);
+    
+    // 执行脚本文本：每行一条命令，空行与以;或#开头的注释行被忽略。全部命令成功时返回true
+    static bool runScript(std::string_view script, ScriptResult& result);
+    
+    // 把执行结果写入当前文件的命令历史
+    static void publishToCommandHistory(const ScriptResult& result);
+
+private:
+    // 私有构造函数，防止实例化
+    ScriptRunner() {}
+    
+    // 收集命令输出
+    static void collectOutput(const std::string& message);
+    
+    static thread_local ScriptResult* s_activeResult; // 当前线程正在执行的脚本结果
+};
+
+} // namespace tch
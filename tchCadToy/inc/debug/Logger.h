@@ -1,22 +1,109 @@
 #pragma once
 #include <iostream>
 #include <fstream>
+#include <array>
+#include <cstddef>
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <source_location>
 #include <format>
 #include <mutex>
+#include <condition_variable>
 #include <memory>
 #include <vector>
 #include <chrono>
 #include <thread>
-#include <queue>
 #include <functional>
+#include <iterator>
 #include <atomic>
 #include <filesystem>
+#include "BinaryLog.h"
+#include "LogLine.h"
+#include "MpscRing.h"
+#include "SysConfig.h"
 
 namespace tch {
 
+// How a deferred log argument is captured into the log buffer and read back on the log thread.
+// Arithmetic values are copied as they are, strings are copied as length + characters because
+// the caller's buffer may be gone by the time the message is formatted. Other types are not
+// supported, messages with such arguments are formatted on the calling thread.
+template <typename T, typename = void>
+struct LogArgCodec
+{
+    static constexpr bool kSupported = false;
+};
+
+template <typename T>
+struct LogArgCodec<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+{
+    static constexpr bool kSupported = true;
+    static size_t size(const T&) { return sizeof(T); }
+    static std::byte* encode(std::byte* out, const T& value)
+    {
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+    static T decode(const std::byte*& in)
+    {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+struct LogStringCodec
+{
+    static constexpr bool kSupported = true;
+    static size_t size(std::string_view str) { return sizeof(uint32_t) + str.size(); }
+    static std::byte* encode(std::byte* out, std::string_view str)
+    {
+        uint32_t length = static_cast<uint32_t>(str.size());
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), str.data(), str.size());
+        return out + sizeof(length) + str.size();
+    }
+    static std::string_view decode(const std::byte*& in)
+    {
+        uint32_t length = 0;
+        std::memcpy(&length, in, sizeof(length));
+        std::string_view str(reinterpret_cast<const char*>(in + sizeof(length)), length);
+        in += sizeof(length) + length;
+        return str;
+    }
+};
+
+template <> struct LogArgCodec<std::string> : LogStringCodec {};
+template <> struct LogArgCodec<std::string_view> : LogStringCodec {};
+
+template <>
+struct LogArgCodec<const char*> : LogStringCodec
+{
+    static size_t size(const char* str) { return LogStringCodec::size(str ? str : ""); }
+    static std::byte* encode(std::byte* out, const char* str) { return LogStringCodec::encode(out, str ? str : ""); }
+};
+
+template <> struct LogArgCodec<char*> : LogArgCodec<const char*> {};
+
+// The file name part of a path, pointing into the path instead of copying it.
+// constexpr so that the LOG_* macros strip the path at compile time.
+constexpr const char* logFileName(const char* path)
+{
+    const char* name = path;
+    for (const char* p = path; *p != '\0'; ++p) {
+        if (*p == '/' || *p == '\\') {
+            name = p + 1;
+        }
+    }
+    return name;
+}
+
 class Logger
 {
 public:
@@ -30,17 +117,45 @@ public:
         Fatal,              // something is definitely wrong, better to kill the program.
         FinalLevel = 100    // no meaning, for comparing, do not use.
     };
-
+    
+    // the lowest level the LOG_* macros are compiled in for, set by the TCH_LOG_MIN_LEVEL CMake option.
+    // calls below it are removed at compile time and setLowestOutputLevel cannot bring them back.
+    static constexpr LogLevel kCompiledLowestLevel = static_cast<LogLevel>(TCH_LOG_MIN_LEVEL);
+    static_assert(kCompiledLowestLevel >= Trace && kCompiledLowestLevel <= Fatal, "TCH_LOG_MIN_LEVEL must be a level from Trace to Fatal");
+    
+    // what an async log call does when the log queue is full
+    enum class OverflowPolicy
+    {
+        Block,              // wait until the log thread frees a slot, nothing is lost.
+        Drop,               // drop the new message silently.
+        Count               // drop the new message, the log thread reports how many were dropped.
+    };
+    
     struct LogConfig
     {
         LogLevel lowestLevel = Trace;
         bool coloredOutput = true;
         bool asyncLogging = false;
+        OverflowPolicy overflowPolicy = OverflowPolicy::Block;
         size_t maxLogFileSize = 10 * 1024 * 1024; // 10MB
         int maxLogFiles = 5;
         std::string logFilePattern = "log_{}.txt";
     };
-
+    
+    // where a log call is; the LOG_* macros build one per call site at compile time
+    struct LogSite
+    {
+        constexpr LogSite() = default;
+        constexpr LogSite(const std::source_location& loc)
+            : location(loc)
+            , fileName(logFileName(loc.file_name()))
+        {
+        }
+        
+        std::source_location location;
+        const char* fileName = "";
+    };
+    
     Logger(std::ostream& os = std::cout, const LogConfig& config = LogConfig());
     Logger(const std::string& logFile, const LogConfig& config = LogConfig());
     ~Logger();
@@ -49,6 +164,7 @@ public:
     void setLowestOutputLevel(LogLevel level);
     void setColoredOutput(bool enabled);
     void setAsyncLogging(bool enabled);
+    void setOverflowPolicy(OverflowPolicy policy);
     void setLogFileSizeLimit(size_t size);
     void setLogFileCountLimit(int count);
     void setLogFilePattern(const std::string& pattern);
@@ -57,10 +173,24 @@ public:
     void blockLevel(LogLevel level);
     void unblockLevel(LogLevel level);
     
+    // whether a message of this level would be written, the LOG_* macros check it before capturing anything
+    bool isLevelEnabled(LogLevel level) const
+    {
+        return static_cast<unsigned>(level) < 32 && ((m_enabledLevels.load(std::memory_order_relaxed) >> level) & 1u) != 0;
+    }
+    
     // Output stream management
     void addOutputStream(std::ostream& os);
     void removeOutputStream(std::ostream& os);
     
+    // Messages dropped because the async log queue was full
+    size_t getDroppedMessageCount() const;
+    
+    // Binary log: every message written is also appended to this file in the compact format of BinaryLog.h,
+    // with format strings and call sites stored once; tchLogDecoder turns it back into text
+    bool openBinaryLogFile(const std::string& path);
+    void closeBinaryLogFile();
+    
     // Log functions
     void trace(const std::string& str, const std::source_location& loc = std::source_location::current());
     void debug(const std::string& str, const std::source_location& loc = std::source_location::current());
@@ -68,16 +198,47 @@ public:
     void warning(const std::string& str, const std::source_location& loc = std::source_location::current());
     void error(const std::string& str, const std::source_location& loc = std::source_location::current());
     void fatal(const std::string& str, const std::source_location& loc = std::source_location::current());
+    
+    // Deferred log function used by the LOG_* macros: with async logging, the format string pointer and the
+    // arguments are captured into the log queue and formatted on the log thread
+    template <size_t N, typename... Args>
+    void logFormat(LogLevel level, const LogSite& site, const char (&format)[N], const Args&... args);
 
 private:
+    // formats the captured arguments of a deferred message, appending to out
+    using LogArgFormatter = void (*)(std::string& out, const char* format, const std::byte* args);
+    // writes the captured arguments of a deferred message to the binary log as they are
+    using LogArgPacker = void (*)(BinaryLogWriter& out, const std::byte* args);
+    
+    static constexpr size_t kLogArgCapacity = 128;
+    
     struct LogMessage
     {
-        LogLevel level;
-        std::string message;
-        std::source_location location;
+        LogLevel level = Info;
+        std::string message;                         // formatted message, unused when formatArgs is set
+        const char* format = nullptr;                // format string literal of a deferred message
+        LogArgFormatter formatArgs = nullptr;        // set for deferred messages
+        LogArgPacker packArgs = nullptr;             // set for deferred messages
+        std::array<std::byte, kLogArgCapacity> args; // captured arguments of a deferred message
+        LogSite site;
         std::chrono::system_clock::time_point timestamp;
     };
-
+    
+    // async log queue: lock-free for producers, drained in batches by the log thread
+    static constexpr size_t kLogQueueCapacity = 4096;
+    static constexpr size_t kLogDrainBatch = 256;
+    static constexpr size_t kLogWakeThreshold = kLogQueueCapacity / 4;         // wake the log thread early when this many messages are queued
+    static constexpr std::chrono::milliseconds kLogDrainInterval{ 10 };       // otherwise the log thread drains the queue this often
+    using LogQueue = MpscRing<LogMessage, kLogQueueCapacity>;
+    
+    // what to do with a message that does not fit in the full log queue
+    enum class QueueFullAction
+    {
+        Retry,              // a slot may be free now, try again.
+        Discard,            // drop the message.
+        WriteDirectly       // the log thread is stopping, write the message on the calling thread.
+    };
+    
     std::mutex m_mutex; // for thread safety
     std::vector<std::reference_wrapper<std::ostream>> m_outputStreams;
     std::unique_ptr<std::ofstream> m_logFileStream;
@@ -93,49 +254,183 @@ private:
     bool m_bBlockWarning = false;
     bool m_bBlockError = false;
     bool m_bBlockFatal = false;
+    std::atomic<uint32_t> m_enabledLevels{ 0 };     // bit per level, computed from the lowest level and the blocked levels
     
     // Asynchronous logging
     std::atomic<bool> m_running{ true };
     std::unique_ptr<std::thread> m_logThread;
-    std::queue<LogMessage> m_logQueue;
-    std::condition_variable m_logCondition;
+    std::unique_ptr<LogQueue> m_logQueue;           // allocated when async logging is first enabled
+    std::mutex m_wakeMutex;                         // only used to put the log thread to sleep and wake it
+    std::condition_variable m_wakeCondition;
+    bool m_wakeRequested = false;
+    std::atomic<size_t> m_pendingDropped{ 0 };      // dropped messages not reported yet (Count policy)
+    std::atomic<size_t> m_droppedMessages{ 0 };     // all dropped messages
+    
+    // Line assembly, only used with m_mutex held
+    std::string m_lineBuffer;                       // reused for every line or batch of lines
+    LogLineFormatter m_lineFormatter;               // caches the timestamp text of the current second
+    size_t m_logFileSize = 0;                       // bytes in the current log file, counted as they are written
+    
+    // Binary log, only used with m_mutex held
+    std::unique_ptr<std::ofstream> m_binaryLogStream;
+    BinaryLogWriter m_binaryLog;                    // encodes a batch, written to m_binaryLogStream with the text lines
     
     // help functions
-    static std::string stripFilePath(const char* file);
-    std::string getLevelString(LogLevel level);
-    std::string resetColor();
-    std::string getTimestamp();
+    const char* getLevelString(LogLevel level) const;
+    const char* resetColor() const;
     
     // Log file management
     void checkLogFileSize();
     void rotateLogFiles();
     
-    // Log thread function
+    // Log thread management
+    void startLogThread();
+    void stopLogThread();
+    void wakeLogThread();
     void logThreadFunc();
     
+    // Fill a slot of the async log queue in place, applying the overflow policy when it is full;
+    // urgent messages wake the log thread at once instead of waiting for the next drain
+    template <typename Fill>
+    void enqueueLogMessage(bool urgent, Fill&& fill);
+    QueueFullAction onLogQueueFull();
+    
+    // Formats the arguments captured by logFormat
+    template <typename... Args>
+    static void formatLogArgs(std::string& out, const char* format, const std::byte* args);
+    
+    // Writes the arguments captured by logFormat to the binary log
+    template <typename... Args>
+    static void packLogArgs(BinaryLogWriter& out, const std::byte* args);
+    
+    // Recompute m_enabledLevels
+    void updateEnabledLevels();
+    
+    // Format and write up to kLogDrainBatch queued messages at once, returns the number of messages
+    size_t drainLogQueue();
+    
     // Log implementation
-    void log(LogLevel level, const std::string& str, const std::source_location& loc);
+    void log(LogLevel level, const std::string& str, const LogSite& site);
     
     // Internal log processing
     void processLogMessage(const LogMessage& msg);
+    void appendLogMessage(const LogMessage& msg);   // to the text and binary buffers, the caller holds m_mutex
+    void appendLogLine(std::string& out, const LogMessage& msg);
+    void appendBinaryLogRecord(const LogMessage& msg);
+    void writeLogBuffers();                         // writes and clears both buffers, the caller holds m_mutex
+    void writeLogString(const std::string& str);    // the caller holds m_mutex
 };
 
+template <size_t N, typename... Args>
+void Logger::logFormat(LogLevel level, const LogSite& site, const char (&format)[N], const Args&... args)
+{
+    if constexpr ((LogArgCodec<std::decay_t<Args>>::kSupported && ...)) {
+        if (m_config.asyncLogging) {
+            size_t size = (size_t(0) + ... + LogArgCodec<std::decay_t<Args>>::size(args));
+            if (size <= kLogArgCapacity) {
+                enqueueLogMessage(level >= Error, [&](LogMessage& msg) {
+                    msg.level = level;
+                    msg.format = format;
+                    msg.formatArgs = &Logger::formatLogArgs<std::decay_t<Args>...>;
+                    msg.packArgs = &Logger::packLogArgs<std::decay_t<Args>...>;
+                    std::byte* out = msg.args.data();
+                    ((out = LogArgCodec<std::decay_t<Args>>::encode(out, args)), ...);
+                    (void)out;
+                    msg.site = site;
+                    msg.timestamp = std::chrono::system_clock::now();
+                });
+                return;
+            }
+        }
+    }
+    
+    // synchronous logging, unsupported argument types or arguments too large to capture;
+    // a format error (e.g. a null char pointer) is logged like one found on the log thread
+    std::string message;
+    try {
+        message = std::vformat(format, std::make_format_args(args...));
+    } catch (const std::exception& e) {
+        message = std::format("<format error: {}> {}", e.what(), format);
+    }
+    log(level, message, site);
+}
+
+template <typename Fill>
+void Logger::enqueueLogMessage(bool urgent, Fill&& fill)
+{
+    while (!m_logQueue->tryEmplace(fill)) {
+        QueueFullAction action = onLogQueueFull();
+        if (action == QueueFullAction::Discard) {
+            return;
+        }
+        if (action == QueueFullAction::WriteDirectly) {
+            LogMessage msg;
+            fill(msg);
+            processLogMessage(msg);
+            return;
+        }
+    }
+    if (urgent || m_logQueue->size() >= kLogWakeThreshold) {
+        wakeLogThread();
+    }
+}
+
+template <typename... Args>
+void Logger::formatLogArgs(std::string& out, const char* format, const std::byte* args)
+{
+    // braced initialization decodes the arguments from left to right
+    std::tuple<decltype(LogArgCodec<Args>::decode(args))...> values{ LogArgCodec<Args>::decode(args)... };
+    std::apply([&out, format](auto&... decoded) {
+        std::vformat_to(std::back_inserter(out), format, std::make_format_args(decoded...));
+    }, values);
+}
+
+template <typename... Args>
+void Logger::packLogArgs(BinaryLogWriter& out, [[maybe_unused]] const std::byte* args)
+{
+    // the comma fold decodes the arguments from left to right, like formatLogArgs
+    (out.appendArg(LogArgCodec<Args>::decode(args)), ...);
+}
+
 // Global logger functions
 
 inline Logger* s_pGlobalLogger = nullptr;
 
-Logger& globalLogger();
 Logger& defaultLogger();
 void setGlobalLogger(Logger* pLogger);
 
+inline Logger& globalLogger()
+{
+    return s_pGlobalLogger ? *s_pGlobalLogger : defaultLogger();
+}
+
 // Convenience macros
+// Levels below Logger::kCompiledLowestLevel are discarded by if constexpr: no code is emitted and the
+// arguments are never evaluated, but the call is still type-checked so it cannot rot.
+// Otherwise the level is checked before the arguments are evaluated, a disabled message costs one branch.
+// The call site, with its file name already stripped, is a constant built at compile time.
+// The std::format in the dead branch only keeps the compile-time check of the format string.
+
+#define TCH_LOG(level, ...) \
+    do { \
+        if constexpr ((level) >= ::tch::Logger::kCompiledLowestLevel) { \
+            ::tch::Logger& tchLogger_ = ::tch::globalLogger(); \
+            if (tchLogger_.isLevelEnabled(level)) { \
+                static constexpr ::tch::Logger::LogSite tchLogSite_{ std::source_location::current() }; \
+                tchLogger_.logFormat(level, tchLogSite_, __VA_ARGS__); \
+            } \
+            if (false) { \
+                (void)std::format(__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
 
-#define LOG_TRACE(...) ::tch::globalLogger().trace(std::format(__VA_ARGS__))
-#define LOG_DEBUG(...) ::tch::globalLogger().debug(std::format(__VA_ARGS__))
-#define LOG_INFO(...) ::tch::globalLogger().info(std::format(__VA_ARGS__))
-#define LOG_WARNING(...) ::tch::globalLogger().warning(std::format(__VA_ARGS__))
-#define LOG_ERROR(...) ::tch::globalLogger().error(std::format(__VA_ARGS__))
-#define LOG_FATAL(...) ::tch::globalLogger().fatal(std::format(__VA_ARGS__))
+#define LOG_TRACE(...) TCH_LOG(::tch::Logger::Trace, __VA_ARGS__)
+#define LOG_DEBUG(...) TCH_LOG(::tch::Logger::Debug, __VA_ARGS__)
+#define LOG_INFO(...) TCH_LOG(::tch::Logger::Info, __VA_ARGS__)
+#define LOG_WARNING(...) TCH_LOG(::tch::Logger::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) TCH_LOG(::tch::Logger::Error, __VA_ARGS__)
+#define LOG_FATAL(...) TCH_LOG(::tch::Logger::Fatal, __VA_ARGS__)
 
 // Assertion
 
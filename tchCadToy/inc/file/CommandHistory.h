@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace tch {
+
+// 命令历史：固定行数的环形缓冲，行文本按顺序写入分块的文本区，块循环复用。
+// 行数或文本区用满时丢弃最旧的行并追加到溢出文件，内存占用不随会话长度增长；块与行表分配后，追加不再分配内存
+class CommandHistory {
+public:
+    static constexpr std::size_t kDefaultLineCapacity = 10000; // 默认保留的行数
+    static constexpr std::size_t kDefaultChunkCount = 16;      // 默认文本块数
+    static constexpr std::size_t kChunkSize = 64 * 1024;       // 文本块大小，超过一块的行会被截断
+    
+    explicit CommandHistory(std::size_t lineCapacity = kDefaultLineCapacity, std::size_t chunkCount = kDefaultChunkCount);
+    
+    // 禁止拷贝，允许移动
+    CommandHistory(const CommandHistory&) = delete;
+    CommandHistory& operator=(const CommandHistory&) = delete;
+    CommandHistory(CommandHistory&&) noexcept = default;
+    CommandHistory& operator=(CommandHistory&&) noexcept = default;
+    
+    // 追加一行
+    void append(std::string_view line);
+    
+    // 把几段文本拼接为一行追加，直接写入文本区，不生成临时字符串
+    void append(std::initializer_list<std::string_view> parts);
+    
+    // 清空历史，保留已分配的文本块
+    void clear();
+    
+    // 保留的行数
+    std::size_t size() const {
+        return m_size;
+    }
+    
+    // 是否为空
+    bool empty() const {
+        return m_size == 0;
+    }
+    
+    // 获取第index行（0为保留的最旧一行），返回的视图在该行被丢弃前有效
+    std::string_view operator[](std::size_t index) const;
+    
+    // 已丢弃的行数
+    std::uint64_t getDroppedCount() const {
+        return m_droppedCount;
+    }
+    
+    // 第0行的序号：每一行在追加时获得递增的序号，丢弃与清空都不会复用，可用来在历史变化后继续定位某一行
+    std::uint64_t getFirstSequence() const {
+        return m_firstSequence;
+    }
+    
+    // 下一行将获得的序号
+    std::uint64_t getEndSequence() const {
+        return m_firstSequence + m_size;
+    }
+    
+    // 历史的标识：每个历史对象构造时获得不重复的值，移动时随内容转移。
+    // 序号只在同一个历史中有意义，视图据此判断是否换成了另一个历史（地址可能被复用）
+    std::uint64_t getId() const {
+        return m_id;
+    }
+    
+    // 设置溢出文件，丢弃的行追加到该文件；为空时直接丢弃
+    void setSpillPath(std::filesystem::path path);
+
+private:
+    // 一行在文本区中的位置，offset为块号 * kChunkSize + 块内偏移
+    struct Entry {
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+    };
+    
+    // 为长度为length的行分配空间，必要时切换到下一块并丢弃其中的行，返回写入位置
+    char* allocate(std::size_t length);
+    
+    // 丢弃最旧的一行
+    void dropOldest();
+    
+    // 把新行加入行表
+    void commit(std::size_t offset, std::size_t length);
+    
+    std::vector<Entry> m_entries;                    // 行表，按环形使用
+    std::vector<std::unique_ptr<char[]>> m_chunks;   // 文本块，首次写入时分配
+    std::vector<std::uint32_t> m_chunkLines;         // 每块中保留的行数
+    std::size_t m_head = 0;                          // 最旧一行在行表中的位置
+    std::size_t m_size = 0;                          // 保留的行数
+    std::size_t m_writeChunk = 0;                    // 正在写入的块
+    std::size_t m_writeOffset = 0;                   // 块内的写入位置
+    std::uint64_t m_droppedCount = 0;                // 已丢弃的行数
+    std::uint64_t m_firstSequence = 0;               // 第0行的序号
+    std::filesystem::path m_spillPath;               // 溢出文件路径
+    std::unique_ptr<std::ofstream> m_spillStream;    // 溢出文件，首次丢弃时打开
+    std::uint64_t m_id = 0;                          // 历史的标识
+};
+
+} // namespace tch
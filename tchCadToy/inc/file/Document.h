@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Layer.h"
+#include "UndoRedo.h"
+#include "SpatialIndex.h"
+#include "Selection.h"
+#include "SaveLoad.h"
+#include "render/LogicalViewport.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+namespace tch {
+
+// 文档：一个标签页对应的全部模型数据（图层、撤销历史、空间索引、视口）
+// 主线程是唯一的修改者，修改时持有写锁；后台线程（导出、检查等）读取时持有读锁
+class Document {
+public:
+    Document();
+    
+    // 文档之间互不共享数据，禁止拷贝和移动（撤销操作持有图层管理器的引用）
+    Document(const Document&) = delete;
+    Document& operator=(const Document&) = delete;
+    
+    // 获取图层管理器
+    LayerManager& getLayerManager();
+    const LayerManager& getLayerManager() const;
+    
+    // 获取撤销/重做管理器
+    UndoRedoManager& getUndoRedoManager();
+    
+    // 获取逻辑视口
+    LogicalViewport& getViewport();
+    
+    // 获取选择集
+    SelectionSet& getSelection();
+    
+    // 获取上一个输入的点，作为相对坐标（@dx,dy）的基点
+    const glm::vec2& getLastPoint() const;
+    
+    // 设置上一个输入的点
+    void setLastPoint(const glm::vec2& point);
+    
+    // 获取空间索引，随图形增删增量维护，批量修改后首次访问时重建
+    const SpatialIndex& getSpatialIndex() const;
+    
+    // 内容变更后调用，递增修订号；事务进行中时推迟到提交时统一递增
+    void touch();
+    
+    // 开始事务：期间的操作合并为一个撤销步骤，修订号在提交时只更新一次
+    void beginTransaction(const std::string& name);
+    
+    // 提交事务，结束最外层事务且期间有修改时返回true，调用方据此更新修改标记
+    bool commitTransaction();
+    
+    // 是否有进行中的事务
+    bool isInTransaction() const;
+    
+    // 获取修订号
+    std::uint64_t getRevision() const;
+    
+    // 获取内容哈希，由各图层缓存的块哈希合并得到，只重新计算失效的块
+    std::uint64_t getContentHash() const;
+    
+    // 记录当前内容为已保存状态
+    void markSaved();
+    
+    // 内容是否与上次保存（或打开）时不同，编辑后再撤销回原状态时返回false
+    bool isModifiedSinceSave() const;
+    
+    // 保存到文件，只重新序列化哈希发生变化的块，成功后记录为已保存状态
+    bool saveToFile(const std::string& filePath);
+    
+    // 获取读锁，供后台线程读取文档时使用
+    std::shared_lock<std::shared_mutex> lockShared() const;
+    
+    // 获取写锁，修改文档时使用
+    std::unique_lock<std::shared_mutex> lockExclusive();
+
+private:
+    LayerManager m_layerManager;       // 图层
+    UndoRedoManager m_undoRedoManager; // 撤销历史
+    LogicalViewport m_viewport;        // 视口
+    SelectionSet m_selection;          // 选择集
+    glm::vec2 m_lastPoint;             // 上一个输入的点
+    
+    mutable std::mutex m_indexMutex;              // 保护空间索引的延迟重建
+    
+    mutable std::mutex m_hashMutex;               // 保护图层块哈希缓存的延迟计算
+    std::uint64_t m_savedHash;                    // 上次保存时的内容哈希
+    JsonChunkCache m_saveCache;                   // 上次保存时各块的JSON文本
+    
+    bool m_pendingTouch;                          // 事务中是否有推迟的修订号递增
+    std::atomic<std::uint64_t> m_revision;        // 修订号
+    mutable std::shared_mutex m_mutex;            // 文档读写锁
+};
+
+} // namespace tch
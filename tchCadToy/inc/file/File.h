@@ -1,7 +1,11 @@
 #pragma once
 
+#include "MappedFile.h"
+#include "file/CommandHistory.h"
+#include "file/Document.h"
+#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
 
 namespace tch {
 
@@ -10,16 +14,24 @@ private:
     std::string m_fileName;      // 文件名（不含后缀）
     std::string m_fileExtension; // 文件后缀，暂时仅支持.cad.json
     std::string m_fullPath;       // 文件完整路径
-    std::string m_content;       // 文件内容
+    std::string m_content;       // 文件内容（仅在被修改后持有副本）
+    MappedFile m_mappedContent;  // 文件原始内容的只读映射，未修改时不占用堆内存
     bool m_modified;             // 是否被修改
     bool m_saved;                // 是否已保存
-    std::vector<std::string> m_commandHistory; // 命令执行历史
+    CommandHistory m_commandHistory;         // 命令执行历史
+    std::shared_ptr<Document> m_document;        // 文档模型，后台任务可共享持有以延长生命周期
     
 public:
     // 构造函数
     File();
     File(const std::string& name, const std::string& path);
     
+    // 只允许移动，避免整份文件内容与命令历史被意外拷贝
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+    File(File&&) noexcept = default;
+    File& operator=(File&&) noexcept = default;
+    
     // 获取文件名（不含后缀）
     const std::string& getFileName() const;
     
@@ -36,10 +48,25 @@ public:
     void setFullPath(const std::string& path);
     
     // 获取文件内容
-    const std::string& getContent() const;
+    std::string_view getContent() const;
+    
+    // 设置文件内容，会释放原始内容的映射
+    void setContent(std::string content);
+    
+    // 以只读映射方式加载文件原始内容
+    bool mapContent(const std::string& path);
+    
+    // 文件内容是否仍为磁盘上的原始映射（即与磁盘内容一致）
+    bool isContentMapped() const;
+    
+    // 释放文件内容
+    void releaseContent();
+    
+    // 获取文档模型
+    Document& getDocument() const;
     
-    // 设置文件内容
-    void setContent(const std::string& content);
+    // 获取文档模型的共享指针，供后台任务持有
+    std::shared_ptr<Document> getDocumentPtr() const;
     
     // 检查文件是否被修改
     bool isModified() const;
@@ -54,8 +81,8 @@ public:
     void markSaved(bool isSaved = true);
     
     // 命令历史相关方法
-    const std::vector<std::string>& getCommandHistory() const;
-    void addToCommandHistory(const std::string& command);
+    const CommandHistory& getCommandHistory() const;
+    CommandHistory& getCommandHistory();
     void clearCommandHistory();
 };
 
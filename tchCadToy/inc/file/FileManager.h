@@ -1,7 +1,9 @@
 #pragma once
 
 #include "file/File.h"
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 
@@ -35,6 +37,16 @@ public:
     static const File& getCurrentFile();                // 获取当前文件
     static const File& getFile(std::size_t index);              // 获取指定索引的文件
     
+    // 文档模型，切换标签页只需切换当前索引
+    static Document& getCurrentDocument();                      // 获取当前文件的文档，当前线程绑定了文档时返回绑定的文档
+    static std::shared_ptr<Document> getCurrentDocumentPtr();   // 获取当前文档的共享指针，规则同getCurrentDocument
+    static std::shared_ptr<Document> getDocumentPtr(std::size_t index); // 获取指定文件的文档，供后台任务持有
+    static std::size_t findDocument(const Document& document);  // 查找文档所在的文件索引，未找到返回-1
+    
+    // 线程绑定的文档：自动化服务在工作线程上执行命令时，命令操作的是不属于任何文件标签页的文档
+    static std::shared_ptr<Document> bindThreadDocument(std::shared_ptr<Document> document); // 绑定到当前线程，nullptr表示解除，返回之前的绑定
+    static bool hasThreadDocument();                            // 当前线程是否绑定了文档
+    
     // 文件内容操作
     static void setFileContent(std::size_t index, const std::string& content); // 设置文件内容
     static void markFileModified(std::size_t index, bool modified = true);     // 标记文件为已修改
@@ -52,8 +64,9 @@ public:
     static void addToRecentFiles(const std::string& filePath); // 添加到最近文件
     
     // 命令历史相关方法
-    static const std::vector<std::string>& getCurrentFileCommandHistory(); // 获取当前文件的命令历史
-    static void addToCurrentFileCommandHistory(const std::string& command); // 向当前文件添加命令历史
+    static const CommandHistory& getCurrentFileCommandHistory(); // 获取当前文件的命令历史
+    static void addToCurrentFileCommandHistory(std::string_view command); // 向当前文件添加命令历史
+    static void addToCurrentFileCommandHistory(std::initializer_list<std::string_view> parts); // 把几段文本拼接为一行添加到当前文件的命令历史
     static void clearCurrentFileCommandHistory(); // 清除当前文件的命令历史
 };
 
@@ -1,6 +1,12 @@
 #pragma once
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include "SpscRing.h"
+#include "input/Keymap.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <functional>
 #include <unordered_map>
@@ -18,28 +24,45 @@ enum class InputEventType {
     MOUSE_SCROLL    // 鼠标滚轮
 };
 
-// 快捷键结构
-enum class ShortcutType {
-    SINGLE_KEY,     // 单个按键
-    CTRL_KEY,       // Ctrl+键
-    CTRL_SHIFT_KEY  // Ctrl+Shift+键
+// 输入队列中的原始事件类型
+enum class RawInputType : std::uint8_t {
+    Key,         // 按键
+    Char,        // 字符输入
+    MouseButton, // 鼠标按钮
+    MouseMove,   // 鼠标移动，连续的移动合并为最后一个位置
+    MouseScroll, // 鼠标滚轮，连续的偏移累加
+    WindowSize   // 窗口大小变化，连续的变化合并为最后一个大小
 };
 
-// 快捷键项结构
-struct ShortcutItem {
-    int key;                    // 按键
-    ShortcutType type;          // 快捷键类型
-    std::string commandName;    // 命令名称
-    std::string name;           // 快捷键名称
-    std::string keyString;      // 按键字符串表示
+// 输入队列中的原始事件：GLFW回调只记录事件及其时间，由主循环每帧统一分发
+struct RawInputEvent {
+    RawInputType type = RawInputType::Key; // 事件类型
+    double time = 0.0;                     // 事件时间（glfwGetTime，秒），合并后为最后一个事件的时间
+    int code = 0;                          // 按键或鼠标按钮
+    int scancode = 0;                      // 扫描码
+    int action = 0;                        // GLFW_PRESS/GLFW_RELEASE/GLFW_REPEAT
+    int mods = 0;                          // 修饰键
+    unsigned int codepoint = 0;            // 字符的Unicode码点
+    double x = 0.0;                        // 鼠标位置、滚轮偏移或窗口宽度
+    double y = 0.0;                        // 鼠标位置、滚轮偏移或窗口高度
 };
 
 // 输入处理器类
 class InputHandler {
 public:
+    static constexpr std::size_t kEventQueueCapacity = 1024; // 输入队列容量，一帧内超出的事件被丢弃
+    
     // 初始化输入处理器
     static void initialize(GLFWwindow* window);
     
+    // 分发排队的输入事件，主循环每帧在glfwPollEvents之后调用一次：
+    // 连续的鼠标移动、滚轮偏移与窗口大小变化各合并为一个事件，按键、字符与鼠标按钮保持原有顺序
+    // 录制输入时记录合并前的事件与帧边界，回放时事件改为取自录制文件（见InputRecorder）
+    static void processEvents();
+    
+    // 正在分发的事件的时间（glfwGetTime，秒）
+    static double getEventTime();
+    
     // 处理键盘输入
     static void handleKeyPress(int key, int scancode, int action, int mods);
     
@@ -80,24 +103,21 @@ public:
     // 设置鼠标指针可见性
     static void setMouseCursorVisible(bool visible);
     
-    // 注册单个按键快捷键
-    static void registerShortcut(int key, const std::string& commandName, const std::string& name, const std::string& keyString);
-    
-    // 注册Ctrl+键快捷键
-    static void registerCtrlShortcut(int key, const std::string& commandName, const std::string& name, const std::string& keyString);
-    
-    // 注册Ctrl+Shift+键快捷键
-    static void registerCtrlShiftShortcut(int key, const std::string& commandName, const std::string& name, const std::string& keyString);
-    
-    // 取消注册快捷键
-    static void unregisterShortcut(int key, ShortcutType type);
-    
-    // 清除所有快捷键
-    static void clearAllShortcuts();
+    // 获取按键绑定表，可在运行时修改
+    static Keymap& getKeymap();
     
+    // 恢复默认绑定后加载用户绑定文件；path为空时加载程序目录下的keymap.json，该文件不存在时只使用默认绑定
+    static bool reloadKeymap(const std::filesystem::path& path = {});
+
 private:
     // 注册默认快捷键
     static void registerDefaultShortcuts();
+    
+    // GLFW回调中调用：记录事件时间并加入输入队列
+    static void enqueueEvent(RawInputEvent event);
+    
+    // 把队列中的事件分发到对应的处理函数
+    static void dispatchEvent(const RawInputEvent& event);
 
 private:
     // 窗口指针
@@ -111,7 +131,11 @@ private:
     static bool s_keys[GLFW_KEY_LAST + 1];                         // 键盘按键状态
     static bool s_keyWasConsumedByShortcut;                       // 标记当前按键是否已被快捷键逻辑消耗
     static std::unordered_map<InputEventType, std::function<void()>> s_callbacks; // 事件回调映射
-    static std::vector<ShortcutItem> s_shortcuts;                  // 快捷键列表
+    static Keymap s_keymap;                                        // 按键绑定表
+    static SpscRing<RawInputEvent, kEventQueueCapacity> s_eventQueue; // 输入队列，GLFW回调写入，主循环读取
+    static std::atomic<std::size_t> s_droppedEvents;               // 队列已满时丢弃的事件数
+    static double s_eventTime;                                     // 正在分发的事件的时间
+    static double s_scrollAccumulator;                             // 不足一格的滚轮偏移
 };
 
 } // namespace tch
\ No newline at end of file
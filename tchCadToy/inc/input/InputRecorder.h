@@ -0,0 +1,97 @@
+#pragma once
+#include "input/InputHandler.h"
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tch {
+
+// 回放速度
+enum class ReplaySpeed {
+    Original, // 按录制时各帧的时间注入事件
+    Maximum   // 每帧注入一帧录制的事件，不等待
+};
+
+// 输入录制与回放：录制时把输入队列分发的原始事件（合并前）与帧边界写入紧凑的二进制文件，
+// 回放时每帧取出一帧录制的事件，经同一套合并与处理流程分发，结束时输出帧时间统计
+class InputRecorder {
+public:
+    // 开始录制，文件头记录当前窗口大小与光标位置
+    static bool startRecording(GLFWwindow* window, const std::filesystem::path& path);
+    
+    // 结束录制并写入文件
+    static void stopRecording();
+    
+    // 是否正在录制
+    static bool isRecording();
+    
+    // 录制一个原始事件
+    static void recordEvent(const RawInputEvent& event);
+    
+    // 录制帧边界，time为该帧分发事件的时间（glfwGetTime，秒）
+    static void recordFrame(double time);
+    
+    // 加载录制文件并开始回放，窗口恢复到录制时的大小
+    static bool startReplay(GLFWwindow* window, const std::filesystem::path& path, ReplaySpeed speed);
+    
+    // 是否正在回放，回放期间实际的输入被忽略
+    static bool isReplaying();
+    
+    // 回放是否已结束
+    static bool isReplayFinished();
+    
+    // 每帧调用一次：取出本帧要注入的事件，没有到期的帧时返回false；两次调用的间隔计为一帧的耗时
+    static bool takeReplayFrame(double now, std::span<const RawInputEvent>& events);
+    
+    // 回放的帧时间统计
+    static std::string getReplaySummary();
+
+private:
+    // 录制与回放状态
+    enum class State {
+        Idle,      // 空闲
+        Recording, // 正在录制
+        Replaying, // 正在回放
+        Finished   // 回放已结束
+    };
+    
+    // 回放的一帧
+    struct ReplayFrame {
+        double time = 0.0;   // 相对录制开始的时间（秒）
+        std::size_t end = 0; // 该帧最后一个事件之后的下标
+    };
+    
+    // 私有构造函数，防止实例化
+    InputRecorder() {}
+    
+    // 写入录制时间：与上一条记录的间隔（微秒）
+    static void writeTime(double time);
+    
+    // 把缓冲区写入文件
+    static void flush();
+    
+    // 结束回放并输出统计
+    static void finishReplay();
+    
+    static State s_state;                             // 当前状态
+    static std::ofstream s_output;                    // 录制文件
+    static std::vector<std::uint8_t> s_buffer;        // 录制缓冲区
+    static double s_recordStart;                      // 录制开始的时间
+    static std::uint64_t s_lastRecordMicros;          // 上一条记录相对录制开始的时间（微秒）
+    static std::size_t s_recordedEvents;              // 已录制的事件数
+    static std::size_t s_recordedFrames;              // 已录制的帧数
+    static std::vector<RawInputEvent> s_replayEvents; // 回放的事件，时间已换算到回放的时间轴
+    static std::vector<ReplayFrame> s_replayFrames;   // 回放的帧
+    static std::size_t s_replayFrame;                 // 下一个要注入的帧
+    static ReplaySpeed s_replaySpeed;                 // 回放速度
+    static double s_replayStart;                      // 回放开始的时间
+    static double s_lastFrameTime;                    // 上一次取帧的时间，小于0表示还没有取过
+    static std::vector<double> s_frameTimes;          // 回放期间每帧的耗时（秒）
+};
+
+} // namespace tch
@@ -0,0 +1,99 @@
+#pragma once
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tch {
+
+// 一次按键：键码与修饰键（Shift/Ctrl/Alt/Super）
+struct KeyChord {
+    int key = GLFW_KEY_UNKNOWN; // GLFW键码
+    int mods = 0;               // GLFW修饰键掩码
+};
+
+// 按键序列的匹配结果
+enum class KeymapResult {
+    None,     // 不是绑定的开始，按键按原有方式处理
+    Pending,  // 是某个多键序列的前缀，等待下一个键
+    Command,  // 匹配到完整的绑定
+    Unbound   // 多键序列中途不匹配，序列被丢弃
+};
+
+// 按键绑定表：以（键码, 修饰键）为键的前缀树，每次按键只做一次哈希查找。
+// 绑定可以是单个按键（如"Ctrl+S"），也可以是以空格分隔的多键序列（如"Ctrl+K Ctrl+S"）
+class Keymap {
+public:
+    static constexpr int kModifierMask = GLFW_MOD_SHIFT | GLFW_MOD_CONTROL | GLFW_MOD_ALT | GLFW_MOD_SUPER;
+    
+    // 绑定按键序列到命令（可带参数），已绑定时替换；与已有绑定互为前缀时失败，原因写入error
+    bool bind(std::string_view keys, const std::string& command, std::string& error);
+    
+    // 解除绑定，序列未绑定时返回false
+    bool unbind(std::string_view keys);
+    
+    // 清除全部绑定
+    void clear();
+    
+    // 查找绑定的命令，未绑定时返回nullptr
+    const std::string* find(std::string_view keys) const;
+    
+    // 输入一次按键：匹配到绑定时把命令写入command。修饰键本身不影响序列状态
+    KeymapResult feed(int key, int mods, std::string& command);
+    
+    // 丢弃进行中的多键序列
+    void resetSequence();
+    
+    // 是否在等待多键序列的下一个键
+    bool isPending() const {
+        return m_state != 0;
+    }
+    
+    // 已输入的多键序列前缀，如"Ctrl+K"
+    std::string getPendingKeys() const;
+    
+    // 全部绑定（规范化的按键序列, 命令），按按键序列排序
+    std::vector<std::pair<std::string, std::string>> getBindings() const;
+    
+    // 从JSON文件加载绑定：对象的键为按键序列，值为命令字符串，null表示解除绑定；
+    // 单条绑定出错时记录警告并继续，文件无法读取或解析时返回false
+    bool loadFromFile(const std::filesystem::path& path);
+    
+    // 解析按键序列，如"Ctrl+K Ctrl+S"，键名与修饰键不区分大小写
+    static bool parseSequence(std::string_view text, std::vector<KeyChord>& out);
+    
+    // 格式化一次按键，如"Ctrl+Shift+S"
+    static std::string formatChord(const KeyChord& chord);
+    
+    // 格式化按键序列
+    static std::string formatSequence(const std::vector<KeyChord>& sequence);
+
+private:
+    // 前缀树节点
+    struct Node {
+        std::unordered_map<std::uint32_t, std::uint32_t> children; // 按键编码到子节点下标
+        std::string command;                                       // 绑定的命令，为空表示不是完整的绑定
+        std::size_t bindingCount = 0;                              // 以该节点为前缀（含自身）的绑定数
+    };
+    
+    // 按键编码：键码与修饰键合为一个整数
+    static std::uint32_t encode(int key, int mods) {
+        return (static_cast<std::uint32_t>(key) << 4) | static_cast<std::uint32_t>(mods & kModifierMask);
+    }
+    
+    // 查找序列对应的节点，不存在时返回0
+    std::uint32_t findNode(const std::vector<KeyChord>& sequence) const;
+    
+    // 收集以node为根的全部绑定
+    void collectBindings(std::uint32_t node, std::vector<KeyChord>& prefix, std::vector<std::pair<std::string, std::string>>& out) const;
+    
+    std::vector<Node> m_nodes = std::vector<Node>(1); // 节点存储，0为根节点
+    std::uint32_t m_state = 0;                         // 进行中的多键序列所在的节点，0表示没有
+    std::vector<KeyChord> m_pending;                   // 进行中的多键序列已输入的按键
+};
+
+} // namespace tch
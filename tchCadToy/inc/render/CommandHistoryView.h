@@ -0,0 +1,45 @@
+#pragma once
+#include "file/CommandHistory.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace tch {
+
+// 命令历史视图：通过ImGuiListClipper只提交可见的行，位于底部时随新行滚动。
+// 支持在历史中搜索（不区分大小写），匹配结果增量维护，每帧最多检查kScanLinesPerFrame行
+class CommandHistoryView {
+public:
+    static constexpr std::size_t kScanLinesPerFrame = 4096; // 每帧最多检查的行数
+    static constexpr const char* kSearchInputId = "##HistorySearch"; // 搜索框的控件ID
+    
+    // 在当前窗口中绘制历史，scrollToBottom为true时强制滚动到底部
+    void draw(const CommandHistory& history, bool scrollToBottom);
+    
+    // 绘制搜索框，宽度为width
+    void drawSearchInput(const char* hint, float width);
+    
+    // 是否正在搜索
+    bool isSearching() const {
+        return !m_query.empty();
+    }
+
+private:
+    // 丢弃已不在历史中的匹配，并继续检查未检查过的行
+    void updateMatches(const CommandHistory& history);
+    
+    // 行中是否包含搜索内容
+    bool matches(std::string_view line) const;
+    
+    std::array<char, 128> m_searchBuffer{};  // 搜索框缓冲区
+    std::string m_query;                     // 搜索内容，已转为小写
+    std::uint64_t m_historyId = 0;           // 上一帧绘制的历史的标识，切换文件时重新搜索
+    std::deque<std::uint64_t> m_matches;     // 匹配行的序号，按升序排列
+    std::uint64_t m_scanSequence = 0;        // 下一个要检查的行序号
+    bool m_scrollPending = false;            // 搜索内容或历史变化后滚动到底部
+};
+
+} // namespace tch
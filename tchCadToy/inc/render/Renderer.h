@@ -1,5 +1,7 @@
 #pragma once
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
@@ -73,11 +75,12 @@ public:
     static void updateDrawableArea(); // 更新可绘制区域
     
     // 逻辑视口相关方法
-    static LogicalViewport& getLogicalViewport(); // 获取逻辑视口
+    static LogicalViewport& getLogicalViewport(); // 获取当前文档的逻辑视口
     
     // 命令栏相关方法
     static void drawCommandBar(); // 绘制命令栏
-    static void addContentToCommandHistory(const std::string& command); // 添加内容到命令历史记录
+    static void addContentToCommandHistory(std::string_view command); // 添加内容到命令历史记录
+    static void addContentToCommandHistory(std::initializer_list<std::string_view> parts); // 把几段文本拼接为一行添加到命令历史记录
     static void setShouldFocusOnCommandInput(bool shouldFocus); // 设置是否应该将焦点设置到命令输入框
     static void addInputChar(unsigned int codepoint); // 添加输入字符到命令输入框
     static void removeLastCharFromCommandInput(); // 从命令输入缓冲区中删除最后一个字符
@@ -96,6 +99,7 @@ public:
     // 焦点检查相关方法
     static bool FocusIsOnWindow(const std::string& windowName); // 检查焦点是否位于指定窗口或其子窗口
     static bool FocusIsOnCommandInput(); // 检查焦点是否在命令输入框上
+    static bool FocusIsOnHistorySearch(); // 检查焦点是否在命令历史搜索框上
     
     
 
@@ -117,9 +121,6 @@ private:
     static float s_originY;                     // 坐标原点Y位置
     static glm::dvec3 s_cursorPosition;          // 当前光标位置（以窗口中央为原点）
     
-    // 逻辑视口
-    static LogicalViewport s_logicalViewport; // 逻辑视口
-    
     // UI组件高度
     static float s_menuBarHeight;              // 菜单栏高度
     static float s_fileBarHeight;              // 文件栏高度
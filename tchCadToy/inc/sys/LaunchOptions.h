@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+namespace tch {
+
+// 命令行启动参数
+struct LaunchOptions {
+    std::string scriptPath;       // --script：启动后执行的脚本文件
+    std::string outputPath;       // --output：脚本执行后保存（.json）或导出（.dxf/.svg）的路径
+    bool headless = false;        // --headless：不创建窗口与GL上下文，执行脚本后退出
+    bool serve = false;           // --serve：以自动化服务运行，从标准输入读取JSON-RPC请求
+    std::string socketPath;       // --socket：自动化服务改为在该Unix域套接字上监听
+    std::string recordPath;       // --record：把交互输入录制到该文件
+    std::string replayPath;       // --replay：启动后回放该文件中录制的输入
+    bool replayMaxSpeed = false;  // --replay-speed max：不等待录制时的帧间隔，逐帧尽快回放
+    bool exitAfterReplay = false; // --exit-after-replay：回放结束后退出
+    std::string binaryLogPath;    // --binary-log：日志同时以二进制格式追加到该文件
+};
+
+// 解析命令行参数，失败时通过error返回原因
+bool parseLaunchOptions(int argc, char* argv[], LaunchOptions& options, std::string& error);
+
+// 获取命令行用法说明
+std::string launchUsage(const char* exeName);
+
+} // namespace tch
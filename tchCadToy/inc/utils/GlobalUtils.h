@@ -4,10 +4,22 @@
 
 namespace tch {
 
+/**
+ * @brief 命令栏输出目标，接管cmdLinePrint的输出
+ */
+using CmdLineSink = void (*)(const std::string& message);
+
 /**
  * @brief 全局输出函数，在命令栏中输出信息
  * @param message 要输出的信息
  */
 void cmdLinePrint(const std::string& message);
 
+/**
+ * @brief 设置命令栏输出目标，用于脚本执行等不直接更新界面的场景，只对调用线程生效
+ * @param sink 新的输出目标，nullptr表示恢复输出到命令栏
+ * @return 之前的输出目标
+ */
+CmdLineSink setCmdLineSink(CmdLineSink sink);
+
 } // namespace tch
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace tch {
+
+// 本地化文本的键表，与res/lang/en.json中的键一一对应，每项为X(枚举名, 语言文件中的键)。
+// 新增界面文本时在这里添加一项，并在各语言文件中加上同名的键；加载时会对多出或缺少的键给出警告
+#define TCH_LOC_KEYS(X) \
+    X(MenuFile,                     "menu.file") \
+    X(MenuFileNew,                  "menu.file.new") \
+    X(MenuFileOpen,                 "menu.file.open") \
+    X(MenuFileOpenRecent,           "menu.file.openRecent") \
+    X(MenuFileSave,                 "menu.file.save") \
+    X(MenuFileSaveAs,               "menu.file.saveAs") \
+    X(MenuFileClose,                "menu.file.close") \
+    X(MenuFileQuit,                 "menu.file.quit") \
+    X(MenuEdit,                     "menu.edit") \
+    X(MenuEditUndo,                 "menu.edit.undo") \
+    X(MenuEditRedo,                 "menu.edit.redo") \
+    X(MenuEditCut,                  "menu.edit.cut") \
+    X(MenuEditCopy,                 "menu.edit.copy") \
+    X(MenuEditPaste,                "menu.edit.paste") \
+    X(MenuEditSelectAll,            "menu.edit.selectAll") \
+    X(MenuEditErase,                "menu.edit.erase") \
+    X(MenuTools,                    "menu.tools") \
+    X(MenuToolsOptions,             "menu.tools.options") \
+    X(MenuToolsProperties,          "menu.tools.properties") \
+    X(MenuToolsDemo,                "menu.tools.demo") \
+    X(MenuToolsMetrics,             "menu.tools.metrics") \
+    X(MenuLanguage,                 "menu.language") \
+    X(OptionsDialogTitle,           "optionsDialog.title") \
+    X(OptionsDialogTabDisplay,      "optionsDialog.tab.display") \
+    X(OptionsDialogGridAxes,        "optionsDialog.gridAxes") \
+    X(OptionsDialogShowGrid,        "optionsDialog.showGrid") \
+    X(OptionsDialogShowAxes,        "optionsDialog.showAxes") \
+    X(OptionsDialogCrossCursorSize, "optionsDialog.crossCursorSize") \
+    X(OptionsDialogTabSelection,    "optionsDialog.tab.selection") \
+    X(OptionsDialogPickBoxSize,     "optionsDialog.pickBoxSize") \
+    X(OptionsDialogTabLanguage,     "optionsDialog.tab.language") \
+    X(OptionsDialogLanguage,        "optionsDialog.language") \
+    X(OptionsDialogOk,              "optionsDialog.ok") \
+    X(OptionsDialogCancel,          "optionsDialog.cancel") \
+    X(CommandBarPrompt,             "commandBar.prompt") \
+    X(CommandBarPromptCancel,       "commandBar.prompt.cancel") \
+    X(CommandBarInputPrompt,        "commandBar.inputPrompt") \
+    X(CommandBarSearchPrompt,       "commandBar.searchPrompt") \
+    X(PropertyBarTitle,             "propertyBar.title")
+
+// 本地化文本的键，编译期确定，作为各语言文本表的下标
+enum class LocKey : std::uint16_t {
+#define TCH_LOC_KEY_ENUM(id, name) id,
+    TCH_LOC_KEYS(TCH_LOC_KEY_ENUM)
+#undef TCH_LOC_KEY_ENUM
+    Count
+};
+
+constexpr std::size_t kLocKeyCount = static_cast<std::size_t>(LocKey::Count);
+
+// 各键在语言文件中的名称，按LocKey的顺序；字符串字面量以'\0'结尾，可以直接作为缺失文本的替代
+constexpr std::string_view kLocKeyNames[kLocKeyCount] = {
+#define TCH_LOC_KEY_NAME(id, name) name,
+    TCH_LOC_KEYS(TCH_LOC_KEY_NAME)
+#undef TCH_LOC_KEY_NAME
+};
+
+// 按语言文件中的名称查找键，找不到时返回LocKey::Count
+constexpr LocKey findLocKey(std::string_view name) {
+    for (std::size_t i = 0; i < kLocKeyCount; ++i) {
+        if (kLocKeyNames[i] == name) {
+            return static_cast<LocKey>(i);
+        }
+    }
+    return LocKey::Count;
+}
+
+} // namespace tch
@@ -1,30 +1,47 @@
 #pragma once
+#include "utils/LocKeys.h"
+#include <array>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <memory>
+#include <vector>
 
 namespace tch {
 
 /**
  * 本地化管理器
- * 负责加载和管理不同语言的资源，提供获取本地化文本的接口，支持语言热切换
+ * 负责加载和管理不同语言的资源，提供获取本地化文本的接口，支持语言热切换。
+ * 每种语言的文本连续存放在一块内存中，按编译期确定的LocKey下标取出，界面每帧取文本不查表也不分配内存
  */
 class LocalizationManager {
 private:
+    // 一种语言的文本表
+    struct LanguageTable {
+        std::string code;                                   // 语言代码
+        std::string blob;                                   // 全部文本，各自以'\0'结尾
+        std::array<std::string_view, kLocKeyCount> texts;   // 各键的文本，缺少的键指向英文文本或键名
+    };
+    
     // 静态实例
     static std::unique_ptr<LocalizationManager> s_instance;
     
     // 当前语言
     std::string m_currentLanguage;
     
-    // 语言资源存储
-    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> m_languages;
+    // 当前语言的文本表，切换语言只替换该指针；语言未加载时为空
+    const LanguageTable* m_currentTable = nullptr;
+    
+    // 语言资源存储，按加载顺序；文本表的地址在清理前不变，其他语言缺少的键会引用英文文本表
+    std::vector<std::unique_ptr<LanguageTable>> m_languages;
     
     // 私有构造函数
     LocalizationManager();
     
     // 加载语言资源文件
     bool loadLanguage(const std::string& langCode, const std::string& filePath);
+    
+    // 查找已加载的语言，找不到时返回空
+    const LanguageTable* findLanguage(std::string_view langCode) const;
 
 public:
     // 获取实例
@@ -40,13 +57,18 @@ public:
     void setLanguage(const std::string& langCode);
     
     // 获取当前语言
-    std::string getCurrentLanguage();
+    const std::string& getCurrentLanguage() const {
+        return m_currentLanguage;
+    }
     
-    // 获取本地化文本
-    std::string get(const std::string& key);
+    // 获取本地化文本，当前语言未加载时返回键名；返回的视图以'\0'结尾（data()可直接交给ImGui），在清理或重新初始化前有效
+    std::string_view get(LocKey key) const {
+        std::size_t index = static_cast<std::size_t>(key);
+        return m_currentTable ? m_currentTable->texts[index] : kLocKeyNames[index];
+    }
     
     // 获取所有可用语言
-    std::vector<std::string> getAvailableLanguages();
+    std::vector<std::string> getAvailableLanguages() const;
 };
 
 } // namespace tch
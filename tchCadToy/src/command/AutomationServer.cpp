@@ -0,0 +1,799 @@
+#include "command/AutomationServer.h"
+#include "command/CommandRegistry.h"
+#include "command/ScriptRunner.h"
+#include "file/FileManager.h"
+#include "file/Document.h"
+#include "debug/Logger.h"
+#include "AttributeIndex.h"
+#include "Layer.h"
+#include "SaveLoad.h"
+#include "LocalSocket.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <rapidjson/document.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace tch {
+
+namespace {
+
+// JSON-RPC错误码
+constexpr int kRpcParseError = -32700;
+constexpr int kRpcInvalidRequest = -32600;
+constexpr int kRpcMethodNotFound = -32601;
+constexpr int kRpcInvalidParams = -32602;
+constexpr int kRpcDocumentNotFound = -32001;
+constexpr int kRpcOperationFailed = -32002;
+constexpr int kRpcShuttingDown = -32003;
+
+using RpcWriter = rapidjson::Writer<rapidjson::StringBuffer>;
+
+// 写回一行响应，可从任意线程调用
+using RpcReply = std::function<void(const std::string&)>;
+
+// 生成成功响应，id为已序列化的请求id
+std::string makeRpcResult(const std::string& id, const std::function<void(RpcWriter&)>& writeResult) {
+    rapidjson::StringBuffer buffer;
+    RpcWriter writer(buffer);
+    writer.StartObject();
+    writer.Key("jsonrpc");
+    writer.String("2.0");
+    writer.Key("id");
+    writer.RawValue(id.c_str(), id.size(), rapidjson::kNumberType);
+    writer.Key("result");
+    writeResult(writer);
+    writer.EndObject();
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+// 生成错误响应
+std::string makeRpcError(const std::string& id, int code, std::string_view message) {
+    rapidjson::StringBuffer buffer;
+    RpcWriter writer(buffer);
+    writer.StartObject();
+    writer.Key("jsonrpc");
+    writer.String("2.0");
+    writer.Key("id");
+    writer.RawValue(id.c_str(), id.size(), rapidjson::kNumberType);
+    writer.Key("error");
+    writer.StartObject();
+    writer.Key("code");
+    writer.Int(code);
+    writer.Key("message");
+    writer.String(message.data(), message.size());
+    writer.EndObject();
+    writer.EndObject();
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+// 读取字符串参数，不存在或类型不符时返回false
+bool getRpcString(const rapidjson::Value& params, const char* name, std::string& out) {
+    auto it = params.FindMember(name);
+    if (it == params.MemberEnd() || !it->value.IsString()) {
+        return false;
+    }
+    out.assign(it->value.GetString(), it->value.GetStringLength());
+    return true;
+}
+
+// 解析图形类型名
+bool parseRpcShapeType(const std::string& name, ShapeType& out) {
+    std::string key = CommandRegistry::normalize(name);
+    if (key == "POINT") {
+        out = ShapeType::POINT;
+    } else if (key == "LINE") {
+        out = ShapeType::LINE;
+    } else if (key == "CIRCLE") {
+        out = ShapeType::CIRCLE;
+    } else if (key == "RECT" || key == "RECTANGLE") {
+        out = ShapeType::RECTANGLE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 固定数量的工作线程，析构时执行完已提交的任务后退出
+class RpcWorkerPool {
+public:
+    explicit RpcWorkerPool(unsigned threadCount) {
+        for (unsigned i = 0; i < threadCount; ++i) {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+    
+    ~RpcWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+    
+    // 提交任务
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+    
+    // 等待全部已提交的任务执行完毕
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCondition.wait(lock, [this] { return m_tasks.empty() && m_activeTasks == 0; });
+    }
+
+private:
+    void run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                ++m_activeTasks;
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_activeTasks;
+            }
+            m_idleCondition.notify_all();
+        }
+    }
+    
+    std::mutex m_mutex;
+    std::condition_variable m_condition;     // 有新任务或停止
+    std::condition_variable m_idleCondition; // 任务执行完毕
+    std::deque<std::function<void()>> m_tasks;
+    std::size_t m_activeTasks = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+// 服务中的一个文档：请求排队后依次执行，同一时刻最多占用一个工作线程
+struct RpcDocument {
+    std::string id;
+    std::shared_ptr<Document> document;
+    std::mutex queueMutex;
+    std::deque<std::function<void()>> pending;
+    bool running = false;
+};
+
+// 在作用域内把文档绑定到当前线程，命令解析器在该文档上执行
+class RpcDocumentBinding {
+public:
+    explicit RpcDocumentBinding(std::shared_ptr<Document> document)
+        : m_previous(FileManager::bindThreadDocument(std::move(document))) {}
+    
+    ~RpcDocumentBinding() {
+        FileManager::bindThreadDocument(std::move(m_previous));
+    }
+    
+    RpcDocumentBinding(const RpcDocumentBinding&) = delete;
+    RpcDocumentBinding& operator=(const RpcDocumentBinding&) = delete;
+
+private:
+    std::shared_ptr<Document> m_previous;
+};
+
+// 一次服务会话：持有全部文档与工作线程
+class RpcSession {
+public:
+    explicit RpcSession(std::function<void()> onShutdown)
+        : m_onShutdown(std::move(onShutdown)), m_pool(std::max(2u, std::thread::hardware_concurrency())) {}
+    
+    // 处理一行请求，响应通过reply写回；通知请求（无id）不回复
+    void handle(std::string_view line, const RpcReply& reply);
+    
+    // 等待已接收的请求全部处理完毕
+    void waitIdle() {
+        m_pool.waitIdle();
+    }
+
+private:
+    using Params = rapidjson::Value;
+    
+    void handleOpen(const std::string& id, const Params& params, RpcReply reply);
+    void handleCommand(const std::string& id, const Params& params, RpcReply reply);
+    void handleQuery(const std::string& id, const Params& params, RpcReply reply);
+    void handleExport(const std::string& id, const Params& params, RpcReply reply);
+    void handleClose(const std::string& id, const Params& params, RpcReply reply);
+    
+    // 按params中的document查找文档，未找到时回复错误并返回nullptr
+    std::shared_ptr<RpcDocument> requireDocument(const std::string& id, const Params& params, const RpcReply& reply);
+    
+    // 把任务加入文档的队列，文档空闲时立即提交到工作线程
+    void enqueue(const std::shared_ptr<RpcDocument>& document, std::function<void()> task);
+    
+    // 依次执行文档队列中的任务
+    void drain(const std::shared_ptr<RpcDocument>& document);
+    
+    std::function<void()> m_onShutdown;                                      // 收到shutdown时调用，停止接收请求
+    std::atomic<bool> m_shuttingDown{false};
+    std::mutex m_documentsMutex;
+    std::unordered_map<std::string, std::shared_ptr<RpcDocument>> m_documents;
+    std::uint64_t m_nextDocumentId = 1;
+    RpcWorkerPool m_pool; // 最后声明，最先析构：文档表在剩余任务执行完之前保持有效
+};
+
+// 处理一行请求
+void RpcSession::handle(std::string_view line, const RpcReply& reply) {
+    rapidjson::Document request;
+    request.Parse(line.data(), line.size());
+    if (request.HasParseError() || !request.IsObject()) {
+        reply(makeRpcError("null", kRpcParseError, "Parse error"));
+        return;
+    }
+    
+    // 请求id原样回显，无id的通知不回复
+    auto idIt = request.FindMember("id");
+    bool notification = idIt == request.MemberEnd();
+    std::string id = "null";
+    if (!notification) {
+        if (!idIt->value.IsString() && !idIt->value.IsNumber() && !idIt->value.IsNull()) {
+            reply(makeRpcError("null", kRpcInvalidRequest, "Invalid request id"));
+            return;
+        }
+        rapidjson::StringBuffer buffer;
+        RpcWriter writer(buffer);
+        idIt->value.Accept(writer);
+        id.assign(buffer.GetString(), buffer.GetSize());
+    }
+    RpcReply respond = notification ? RpcReply([](const std::string&) {}) : reply;
+    
+    std::string method;
+    if (!getRpcString(request, "method", method)) {
+        respond(makeRpcError(id, kRpcInvalidRequest, "Missing method"));
+        return;
+    }
+    static const rapidjson::Value kNoParams(rapidjson::kObjectType);
+    auto paramsIt = request.FindMember("params");
+    const Params& params = paramsIt == request.MemberEnd() ? kNoParams : paramsIt->value;
+    if (!params.IsObject()) {
+        respond(makeRpcError(id, kRpcInvalidParams, "params must be an object"));
+        return;
+    }
+    
+    if (m_shuttingDown.load(std::memory_order_acquire)) {
+        respond(makeRpcError(id, kRpcShuttingDown, "Server is shutting down"));
+        return;
+    }
+    
+    if (method == "open") {
+        handleOpen(id, params, respond);
+    } else if (method == "command") {
+        handleCommand(id, params, respond);
+    } else if (method == "query") {
+        handleQuery(id, params, respond);
+    } else if (method == "export") {
+        handleExport(id, params, respond);
+    } else if (method == "close") {
+        handleClose(id, params, respond);
+    } else if (method == "shutdown") {
+        m_shuttingDown.store(true, std::memory_order_release);
+        respond(makeRpcResult(id, [](RpcWriter& writer) {
+            writer.StartObject();
+            writer.EndObject();
+        }));
+        m_onShutdown();
+    } else {
+        respond(makeRpcError(id, kRpcMethodNotFound, "Method not found: " + method));
+    }
+}
+
+// open {path?}：创建文档，给出path时从文件加载
+void RpcSession::handleOpen(const std::string& id, const Params& params, RpcReply reply) {
+    std::string path;
+    getRpcString(params, "path", path);
+    
+    // 加载可能较慢，在工作线程上执行
+    m_pool.submit([this, id, path, reply = std::move(reply)] {
+        auto document = std::make_shared<Document>();
+        if (!path.empty()) {
+            if (!SaveLoad::loadFromFile(document->getLayerManager(), path)) {
+                reply(makeRpcError(id, kRpcOperationFailed, "Failed to load file: " + path));
+                return;
+            }
+            document->markSaved();
+        }
+        
+        auto entry = std::make_shared<RpcDocument>();
+        entry->document = document;
+        {
+            std::lock_guard<std::mutex> lock(m_documentsMutex);
+            entry->id = std::format("d{}", m_nextDocumentId++);
+            m_documents.emplace(entry->id, entry);
+        }
+        LOG_INFO("Automation: opened document {} ({})", entry->id, path.empty() ? "new" : path);
+        
+        std::size_t shapes = document->getLayerManager().getAttributeIndex().size();
+        reply(makeRpcResult(id, [&](RpcWriter& writer) {
+            writer.StartObject();
+            writer.Key("document");
+            writer.String(entry->id.c_str(), entry->id.size());
+            writer.Key("shapes");
+            writer.Uint64(shapes);
+            writer.EndObject();
+        }));
+    });
+}
+
+// command {document, command | commands[] | script}：按脚本方式执行，整批作为一个撤销步骤
+void RpcSession::handleCommand(const std::string& id, const Params& params, RpcReply reply) {
+    auto document = requireDocument(id, params, reply);
+    if (!document) {
+        return;
+    }
+    
+    std::string script;
+    if (!getRpcString(params, "command", script) && !getRpcString(params, "script", script)) {
+        auto it = params.FindMember("commands");
+        if (it == params.MemberEnd() || !it->value.IsArray()) {
+            reply(makeRpcError(id, kRpcInvalidParams, "Expected command, commands or script"));
+            return;
+        }
+        for (auto command = it->value.Begin(); command != it->value.End(); ++command) {
+            if (!command->IsString()) {
+                reply(makeRpcError(id, kRpcInvalidParams, "commands must be strings"));
+                return;
+            }
+            script.append(command->GetString(), command->GetStringLength());
+            script.push_back('\n');
+        }
+    }
+    
+    enqueue(document, [document, id, script = std::move(script), reply = std::move(reply)] {
+        ScriptResult result;
+        bool success = false;
+        {
+            RpcDocumentBinding binding(document->document);
+            success = ScriptRunner::runScript(script, result);
+        }
+        
+        reply(makeRpcResult(id, [&](RpcWriter& writer) {
+            writer.StartObject();
+            writer.Key("success");
+            writer.Bool(success);
+            writer.Key("commands");
+            writer.Uint64(result.commands);
+            writer.Key("failed");
+            writer.Uint64(result.failedCommands);
+            writer.Key("seconds");
+            writer.Double(result.seconds);
+            writer.Key("output");
+            writer.StartArray();
+            for (const auto& line : result.output) {
+                writer.String(line.c_str(), line.size());
+            }
+            writer.EndArray();
+            writer.Key("failures");
+            writer.StartArray();
+            for (const auto& failure : result.failures) {
+                writer.StartObject();
+                writer.Key("line");
+                writer.Uint64(failure.line);
+                writer.Key("command");
+                writer.String(failure.command.c_str(), failure.command.size());
+                writer.Key("message");
+                writer.String(failure.message.c_str(), failure.message.size());
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+        }));
+    });
+}
+
+// query {document, type?, layer?, color?}：文档概况，给出过滤条件时通过属性索引统计匹配个数
+void RpcSession::handleQuery(const std::string& id, const Params& params, RpcReply reply) {
+    auto document = requireDocument(id, params, reply);
+    if (!document) {
+        return;
+    }
+    
+    // 过滤条件在入队前校验，图层名在执行时解析
+    AttributeQuery query;
+    bool filtered = false;
+    std::string typeName, layerName;
+    if (getRpcString(params, "type", typeName)) {
+        ShapeType type;
+        if (!parseRpcShapeType(typeName, type)) {
+            reply(makeRpcError(id, kRpcInvalidParams, "Unknown shape type: " + typeName));
+            return;
+        }
+        query.type = type;
+        filtered = true;
+    }
+    bool hasLayer = getRpcString(params, "layer", layerName);
+    filtered = filtered || hasLayer;
+    auto colorIt = params.FindMember("color");
+    if (colorIt != params.MemberEnd()) {
+        const auto& color = colorIt->value;
+        if (!color.IsArray() || color.Size() != 3 || std::any_of(color.Begin(), color.End(), [](const rapidjson::Value& v) { return !v.IsNumber(); })) {
+            reply(makeRpcError(id, kRpcInvalidParams, "color must be [r, g, b]"));
+            return;
+        }
+        auto component = color.Begin();
+        float r = component[0].GetFloat(), g = component[1].GetFloat(), b = component[2].GetFloat();
+        // 与COLOR命令一致：任一分量大于1时按0-255解释
+        if (r > 1.0f || g > 1.0f || b > 1.0f) {
+            r /= 255.0f;
+            g /= 255.0f;
+            b /= 255.0f;
+        }
+        query.color = glm::vec3(r, g, b);
+        filtered = true;
+    }
+    
+    enqueue(document, [document, id, query, filtered, hasLayer, layerName, reply = std::move(reply)]() mutable {
+        Document& doc = *document->document;
+        auto lock = doc.lockShared();
+        LayerManager& layerManager = doc.getLayerManager();
+        
+        std::size_t matches = 0;
+        if (hasLayer) {
+            Layer* layer = layerManager.getLayer(layerName);
+            if (!layer) {
+                reply(makeRpcError(id, kRpcInvalidParams, "Layer not found: " + layerName));
+                return;
+            }
+            query.layerId = layer->getId();
+        }
+        if (filtered) {
+            std::vector<std::uint32_t> handles;
+            layerManager.getAttributeIndex().query(query, handles);
+            matches = handles.size();
+        }
+        
+        // 按图层ID排序输出，结果与哈希表的存储顺序无关
+        std::vector<const Layer*> layers;
+        for (const auto& pair : layerManager.getLayers()) {
+            layers.push_back(pair.second.get());
+        }
+        std::sort(layers.begin(), layers.end(), [](const Layer* a, const Layer* b) {
+            return a->getId() < b->getId();
+        });
+        
+        glm::vec2 minPoint(std::numeric_limits<float>::max());
+        glm::vec2 maxPoint(std::numeric_limits<float>::lowest());
+        std::size_t shapeCount = 0;
+        for (const Layer* layer : layers) {
+            for (const auto& shape : layer->getShapes()) {
+                glm::vec2 shapeMin, shapeMax;
+                shape->getBounds(shapeMin, shapeMax);
+                minPoint = glm::min(minPoint, shapeMin);
+                maxPoint = glm::max(maxPoint, shapeMax);
+            }
+            shapeCount += layer->getShapes().size();
+        }
+        Layer* currentLayer = layerManager.getCurrentLayer();
+        
+        reply(makeRpcResult(id, [&](RpcWriter& writer) {
+            writer.StartObject();
+            writer.Key("document");
+            writer.String(document->id.c_str(), document->id.size());
+            writer.Key("shapes");
+            writer.Uint64(shapeCount);
+            writer.Key("revision");
+            writer.Uint64(doc.getRevision());
+            writer.Key("modified");
+            writer.Bool(doc.isModifiedSinceSave());
+            writer.Key("layers");
+            writer.StartArray();
+            for (const Layer* layer : layers) {
+                std::string name = layer->getName();
+                writer.StartObject();
+                writer.Key("name");
+                writer.String(name.c_str(), name.size());
+                writer.Key("shapes");
+                writer.Uint64(layer->getShapes().size());
+                writer.Key("visible");
+                writer.Bool(layer->isVisible());
+                writer.Key("current");
+                writer.Bool(layer == currentLayer);
+                writer.EndObject();
+            }
+            writer.EndArray();
+            writer.Key("bounds");
+            if (shapeCount == 0) {
+                writer.Null();
+            } else {
+                writer.StartObject();
+                writer.Key("min");
+                writer.StartArray();
+                writer.Double(minPoint.x);
+                writer.Double(minPoint.y);
+                writer.EndArray();
+                writer.Key("max");
+                writer.StartArray();
+                writer.Double(maxPoint.x);
+                writer.Double(maxPoint.y);
+                writer.EndArray();
+                writer.EndObject();
+            }
+            if (filtered) {
+                writer.Key("matches");
+                writer.Uint64(matches);
+            }
+            writer.EndObject();
+        }));
+    });
+}
+
+// export {document, path, version?}：按扩展名保存为.json或导出为.dxf/.svg
+void RpcSession::handleExport(const std::string& id, const Params& params, RpcReply reply) {
+    auto document = requireDocument(id, params, reply);
+    if (!document) {
+        return;
+    }
+    
+    std::string path, versionName;
+    if (!getRpcString(params, "path", path)) {
+        reply(makeRpcError(id, kRpcInvalidParams, "Missing path"));
+        return;
+    }
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (extension != ".json" && extension != ".dxf" && extension != ".svg") {
+        reply(makeRpcError(id, kRpcInvalidParams, "Unsupported export format: " + extension));
+        return;
+    }
+    DxfVersion version = DxfVersion::R2000;
+    if (getRpcString(params, "version", versionName)) {
+        versionName = CommandRegistry::normalize(versionName);
+        if (versionName == "R12") {
+            version = DxfVersion::R12;
+        } else if (versionName != "R2000") {
+            reply(makeRpcError(id, kRpcInvalidParams, "Unsupported DXF version: " + versionName));
+            return;
+        }
+    }
+    
+    enqueue(document, [document, id, path, extension, version, reply = std::move(reply)] {
+        Document& doc = *document->document;
+        bool success = false;
+        if (extension == ".json") {
+            success = doc.saveToFile(path);
+        } else {
+            auto lock = doc.lockShared();
+            success = extension == ".dxf" ? SaveLoad::exportToDXF(doc.getLayerManager(), path, version)
+                                          : SaveLoad::exportToSVG(doc.getLayerManager(), path);
+        }
+        
+        if (!success) {
+            reply(makeRpcError(id, kRpcOperationFailed, "Failed to write file: " + path));
+            return;
+        }
+        reply(makeRpcResult(id, [&](RpcWriter& writer) {
+            writer.StartObject();
+            writer.Key("path");
+            writer.String(path.c_str(), path.size());
+            writer.EndObject();
+        }));
+    });
+}
+
+// close {document}：立即从文档表中移除，排在它之前的请求执行完后回复
+void RpcSession::handleClose(const std::string& id, const Params& params, RpcReply reply) {
+    auto document = requireDocument(id, params, reply);
+    if (!document) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_documentsMutex);
+        m_documents.erase(document->id);
+    }
+    
+    enqueue(document, [document, id, reply = std::move(reply)] {
+        LOG_INFO("Automation: closed document {}", document->id);
+        reply(makeRpcResult(id, [&](RpcWriter& writer) {
+            writer.StartObject();
+            writer.Key("closed");
+            writer.String(document->id.c_str(), document->id.size());
+            writer.EndObject();
+        }));
+    });
+}
+
+// 按params中的document查找文档
+std::shared_ptr<RpcDocument> RpcSession::requireDocument(const std::string& id, const Params& params, const RpcReply& reply) {
+    std::string documentId;
+    if (!getRpcString(params, "document", documentId)) {
+        reply(makeRpcError(id, kRpcInvalidParams, "Missing document"));
+        return nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_documentsMutex);
+    auto it = m_documents.find(documentId);
+    if (it == m_documents.end()) {
+        reply(makeRpcError(id, kRpcDocumentNotFound, "Document not found: " + documentId));
+        return nullptr;
+    }
+    return it->second;
+}
+
+// 把任务加入文档的队列
+void RpcSession::enqueue(const std::shared_ptr<RpcDocument>& document, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(document->queueMutex);
+        document->pending.push_back(std::move(task));
+        if (document->running) {
+            return;
+        }
+        document->running = true;
+    }
+    m_pool.submit([this, document] { drain(document); });
+}
+
+// 依次执行文档队列中的任务，队列清空后释放工作线程
+void RpcSession::drain(const std::shared_ptr<RpcDocument>& document) {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(document->queueMutex);
+            if (document->pending.empty()) {
+                document->running = false;
+                return;
+            }
+            task = std::move(document->pending.front());
+            document->pending.pop_front();
+        }
+        task();
+    }
+}
+
+// 从行缓冲中取出完整的行交给会话处理，返回false表示行过长
+bool dispatchRpcLines(std::string& buffer, RpcSession& session, const RpcReply& reply) {
+    std::size_t begin = 0;
+    for (std::size_t end = buffer.find('\n'); end != std::string::npos; end = buffer.find('\n', begin)) {
+        std::string_view line(buffer.data() + begin, end - begin);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!line.empty()) {
+            session.handle(line, reply);
+        }
+        begin = end + 1;
+    }
+    buffer.erase(0, begin);
+    return buffer.size() <= AutomationServer::kMaxRequestLength;
+}
+
+} // namespace
+
+// 从标准输入读取请求
+int AutomationServer::runStdio() {
+    std::atomic<bool> stopping{false};
+    std::mutex outputMutex;
+    RpcReply reply = [&outputMutex](const std::string& response) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << response << '\n' << std::flush;
+    };
+    
+    LOG_INFO("Automation server reading JSON-RPC requests from stdin");
+    {
+        RpcSession session([&stopping] { stopping.store(true); });
+        std::string line;
+        while (!stopping.load() && std::getline(std::cin, line)) {
+            if (line.size() > kMaxRequestLength) {
+                reply(makeRpcError("null", kRpcInvalidRequest, "Request too long"));
+                continue;
+            }
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                session.handle(line, reply);
+            }
+        }
+        // 会话析构时执行完剩余请求，响应全部写出后才返回
+    }
+    LOG_INFO("Automation server stopped");
+    return 0;
+}
+
+// 在Unix域套接字上监听
+int AutomationServer::runSocket(const std::string& socketPath) {
+    LocalSocket listener;
+    if (!listener.listen(socketPath)) {
+        LOG_ERROR("Failed to listen on socket: {}", socketPath);
+        return 1;
+    }
+    LOG_INFO("Automation server listening on {}", socketPath);
+    
+    // 每个连接一个读取线程；响应可能来自任意工作线程，写入时加锁。
+    // 连接由读取线程与尚未写回的响应共同持有，读取结束且响应全部写回后释放，套接字随之关闭
+    struct Connection {
+        LocalSocket socket;
+        std::mutex writeMutex;
+    };
+    struct ConnectionReader {
+        std::weak_ptr<Connection> connection;           // 停止时用来断开仍在等待输入的连接
+        std::shared_ptr<std::atomic<bool>> finished;    // 读取线程是否已结束
+        std::thread thread;
+    };
+    std::vector<ConnectionReader> readers;
+    
+    RpcSession session([&listener] { listener.shutdown(); });
+    while (true) {
+        LocalSocket socket = listener.accept();
+        if (!socket.isOpen()) {
+            break;
+        }
+        
+        // 回收已结束的读取线程，长时间运行时线程不随客户端数量累积
+        std::erase_if(readers, [](ConnectionReader& reader) {
+            if (!reader.finished->load()) {
+                return false;
+            }
+            reader.thread.join();
+            return true;
+        });
+        
+        auto connection = std::make_shared<Connection>();
+        connection->socket = std::move(socket);
+        auto finished = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread([connection, finished, &session] {
+            RpcReply reply = [connection](const std::string& response) {
+                std::lock_guard<std::mutex> lock(connection->writeMutex);
+                std::string line = response + '\n';
+                connection->socket.writeAll(line);
+            };
+            
+            std::string buffer;
+            char chunk[64 * 1024];
+            while (true) {
+                std::ptrdiff_t count = connection->socket.read(chunk, sizeof(chunk));
+                if (count <= 0) {
+                    break;
+                }
+                buffer.append(chunk, static_cast<std::size_t>(count));
+                if (!dispatchRpcLines(buffer, session, reply)) {
+                    reply(makeRpcError("null", kRpcInvalidRequest, "Request too long"));
+                    break;
+                }
+            }
+            finished->store(true);
+        });
+        readers.push_back({connection, std::move(finished), std::move(thread)});
+    }
+    
+    // 先让已接收的请求执行完并写回，再断开仍在等待输入的连接
+    session.waitIdle();
+    for (auto& reader : readers) {
+        if (auto connection = reader.connection.lock()) {
+            connection->socket.shutdown();
+        }
+    }
+    for (auto& reader : readers) {
+        reader.thread.join();
+    }
+    LOG_INFO("Automation server stopped");
+    return 0;
+}
+
+} // namespace tch
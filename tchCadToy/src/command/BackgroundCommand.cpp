@@ -0,0 +1,133 @@
+#include "command/BackgroundCommand.h"
+#include "file/FileManager.h"
+#include "file/Document.h"
+#include "utils/GlobalUtils.h"
+#include "debug/Logger.h"
+#include <atomic>
+#include <format>
+#include <thread>
+
+namespace tch {
+
+// 正在执行的后台命令
+struct BackgroundCommand::Task {
+    std::string name;                    // 命令名
+    std::shared_ptr<Document> document;  // 命令读取的文档，结果提交到该文档
+    Work work;                           // 工作线程上执行的部分
+    Commit commit;                       // 工作线程完成后生成的提交函数
+    ProgressMonitor progress;            // 进度与取消标记
+    std::atomic<bool> finished{false};   // 工作线程是否已完成
+    std::thread thread;                  // 工作线程
+};
+
+// 静态成员初始化
+bool BackgroundCommand::s_asyncEnabled = false;
+std::unique_ptr<BackgroundCommand::Task> BackgroundCommand::s_task;
+
+// 启用后台执行
+void BackgroundCommand::setAsyncEnabled(bool enabled) {
+    s_asyncEnabled = enabled;
+}
+
+// 执行命令
+bool BackgroundCommand::run(const std::string& name, std::shared_ptr<Document> document, Work work) {
+    // 同步执行：调用方（命令分发）已持有文档的写锁
+    if (!s_asyncEnabled || FileManager::hasThreadDocument() || !document) {
+        ProgressMonitor progress;
+        Commit commit = work(progress);
+        return commit();
+    }
+    
+    // 命令分发在后台命令执行期间会拒绝新命令，这里只作保护
+    if (s_task) {
+        cmdLinePrint(std::format("{} is still running, press Esc to cancel", s_task->name));
+        return false;
+    }
+    
+    s_task = std::make_unique<Task>();
+    s_task->name = name;
+    s_task->document = std::move(document);
+    s_task->work = std::move(work);
+    
+    // 工作线程在命令分发释放写锁后才能取得读锁；文档绑定到工作线程，工作函数通过getCurrentDocument访问
+    Task* task = s_task.get();
+    task->thread = std::thread([task] {
+        try {
+            FileManager::bindThreadDocument(task->document);
+            auto lock = task->document->lockShared();
+            task->commit = task->work(task->progress);
+        } catch (const std::exception& e) {
+            std::string message = std::format("{} failed: {}", task->name, e.what());
+            task->commit = [message] {
+                cmdLinePrint(message);
+                return false;
+            };
+        }
+        task->finished.store(true, std::memory_order_release);
+    });
+    
+    LOG_INFO("Background command started: {}", name);
+    cmdLinePrint(std::format("{} running in background, press Esc to cancel", name));
+    return true;
+}
+
+// 是否有后台命令正在执行
+bool BackgroundCommand::isRunning() {
+    return s_task != nullptr;
+}
+
+// 请求取消正在执行的后台命令
+bool BackgroundCommand::cancel() {
+    if (!s_task || s_task->progress.isCancelled()) {
+        return false;
+    }
+    s_task->progress.cancel();
+    cmdLinePrint(std::format("Cancelling {}...", s_task->name));
+    return true;
+}
+
+// 后台命令完成后在主线程上提交结果
+void BackgroundCommand::poll() {
+    if (!s_task || !s_task->finished.load(std::memory_order_acquire)) {
+        return;
+    }
+    
+    std::unique_ptr<Task> task = std::move(s_task);
+    task->thread.join();
+    if (task->progress.isCancelled()) {
+        LOG_INFO("Background command cancelled: {}", task->name);
+        cmdLinePrint(task->name + " cancelled");
+        return;
+    }
+    
+    // 提交到命令读取的文档，期间用户可能已切换到其他文件标签页
+    auto previous = FileManager::bindThreadDocument(task->document);
+    {
+        auto lock = task->document->lockExclusive();
+        task->commit();
+    }
+    FileManager::bindThreadDocument(std::move(previous));
+    LOG_INFO("Background command finished: {}", task->name);
+}
+
+// 取消并等待正在执行的后台命令结束
+void BackgroundCommand::shutdown() {
+    if (s_task) {
+        s_task->progress.cancel();
+        s_task->thread.join();
+        s_task.reset();
+    }
+}
+
+// 正在执行的后台命令名称
+const std::string& BackgroundCommand::getName() {
+    static const std::string s_empty;
+    return s_task ? s_task->name : s_empty;
+}
+
+// 正在执行的后台命令的完成比例
+float BackgroundCommand::getProgress() {
+    return s_task ? s_task->progress.getFraction() : 0.0f;
+}
+
+} // namespace tch
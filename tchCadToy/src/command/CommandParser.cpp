@@ -1,388 +1,875 @@
 #include "render/Renderer.h"
 #include "file/FileManager.h"
+#include "file/Document.h"
 #include "command/CommandParser.h"
+#include "command/CommandRegistry.h"
+#include "command/BackgroundCommand.h"
+#include "command/InteractiveTool.h"
+#include "command/DrawingTools.h"
+#include "input/InputHandler.h"
 #include "Geometry.h"
 #include "Layer.h"
 #include "Transform.h"
 #include "Color.h"
+#include "Selection.h"
 #include "UndoRedo.h"
 #include "SaveLoad.h"
+#include "Progress.h"
 #include "utils/GlobalUtils.h"
-#include <sstream>
 #include <algorithm>
+#include <filesystem>
+#include <format>
+#include <mutex>
 
 namespace tch {
 
-// 解析命令
-bool CommandParser::parseCommand(const std::string& command) {
-    // 分割命令行参数
-    auto parts = splitArguments(command);
-    if (parts.empty()) {
-        return false;
+namespace {
+
+// 单次阵列允许生成的最大副本数
+constexpr std::uint64_t kMaxArrayCopies = 10'000'000;
+
+// 参数读取器：按顺序读取数值与坐标参数，出错时输出错误信息
+class ArgumentReader {
+public:
+    ArgumentReader(std::string_view commandName, CommandArgs arguments)
+        : m_commandName(commandName), m_arguments(arguments), m_index(0) {}
+    
+    // 读取一个数值
+    bool readNumber(float& out) {
+        if (m_index >= m_arguments.size()) {
+            return fail(ParseError::MissingArgument, {});
+        }
+        std::string_view token = m_arguments[m_index];
+        ParseError error = CommandTokenizer::parseNumber(token, out);
+        if (error != ParseError::None) {
+            return fail(error, token);
+        }
+        ++m_index;
+        return true;
+    }
+    
+    // 读取一个整数
+    bool readInteger(int& out) {
+        if (m_index >= m_arguments.size()) {
+            return fail(ParseError::MissingArgument, {});
+        }
+        std::string_view token = m_arguments[m_index];
+        ParseError error = CommandTokenizer::parseInteger(token, out);
+        if (error != ParseError::None) {
+            return fail(error, token);
+        }
+        ++m_index;
+        return true;
+    }
+    
+    // 读取一个点：单个参数写作x,y或@dx,dy，也可以是两个数值参数；相对坐标以base为基点
+    bool readPoint(const glm::vec2& base, glm::vec2& out) {
+        if (m_index >= m_arguments.size()) {
+            return fail(ParseError::MissingArgument, {});
+        }
+        std::string_view token = m_arguments[m_index];
+        if (!CommandTokenizer::isPointToken(token)) {
+            return readNumber(out.x) && readNumber(out.y);
+        }
+        
+        PointToken point;
+        ParseError error = CommandTokenizer::parsePoint(token, point);
+        if (error != ParseError::None) {
+            return fail(error, token);
+        }
+        out = point.relative ? base + point.value : point.value;
+        ++m_index;
+        return true;
     }
     
-    // 获取命令名称
-    std::string commandName = parts[0];
+    // 读取一个颜色：R G B三个分量（任一分量大于1时按0-255解释）、预定义颜色名或#RRGGBB
+    bool readColor(glm::vec3& out) {
+        if (m_index >= m_arguments.size()) {
+            return fail(ParseError::MissingArgument, {});
+        }
+        std::string_view token = m_arguments[m_index];
+        
+        float r = 0.0f;
+        if (CommandTokenizer::parseNumber(token, r) == ParseError::None) {
+            float g = 0.0f, b = 0.0f;
+            ++m_index;
+            if (!readNumber(g) || !readNumber(b)) {
+                return false;
+            }
+            if (r > 1.0f || g > 1.0f || b > 1.0f) {
+                r /= 255.0f;
+                g /= 255.0f;
+                b /= 255.0f;
+            }
+            out = ColorManager::fromRGB(r, g, b);
+            return true;
+        }
+        
+        // 先检查长度：参数可能为空（""），空参数按未知颜色名报告
+        if (token.size() == 7 && token.front() == '#') {
+            out = ColorManager::fromHex(std::string(token));
+            ++m_index;
+            return true;
+        }
+        
+        // 预定义颜色名为小写
+        std::string name(token);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (!ColorManager::getInstance().hasColor(name)) {
+            cmdLinePrint(std::format("Invalid arguments for {} command: unknown color '{}'", m_commandName, token));
+            return false;
+        }
+        out = ColorManager::getInstance().getColor(name);
+        ++m_index;
+        return true;
+    }
     
-    // 转换为大写
-    for (char& c : commandName) {
-        c = toupper(c);
+    // 读取一个关键字，转为大写
+    bool readKeyword(std::string& out) {
+        if (m_index >= m_arguments.size()) {
+            return fail(ParseError::MissingArgument, {});
+        }
+        out = CommandRegistry::normalize(m_arguments[m_index++]);
+        return true;
     }
     
-    // 提取参数
-    std::vector<std::string> arguments;
-    for (size_t i = 1; i < parts.size(); ++i) {
-        arguments.push_back(parts[i]);
+    // 读取一个原样的文本参数
+    bool readText(std::string& out) {
+        if (m_index >= m_arguments.size()) {
+            return fail(ParseError::MissingArgument, {});
+        }
+        out = std::string(m_arguments[m_index++]);
+        return true;
     }
     
-    // 执行命令
-    return executeCommand(commandName, arguments);
-}
+    // 是否还有未读取的参数
+    bool hasMore() const {
+        return m_index < m_arguments.size();
+    }
+    
+    // 检查参数是否已全部读取
+    bool finish() {
+        if (m_index < m_arguments.size()) {
+            return fail(ParseError::ExtraArgument, m_arguments[m_index]);
+        }
+        return true;
+    }
 
-// 分割命令行参数
-std::vector<std::string> CommandParser::splitArguments(const std::string& command) {
-    std::vector<std::string> parts;
-    std::istringstream iss(command);
-    std::string part;
+private:
+    // 输出错误信息
+    bool fail(ParseError error, std::string_view token) {
+        std::string message = std::format("Invalid arguments for {} command: {}", m_commandName, CommandTokenizer::describeError(error));
+        if (!token.empty()) {
+            message += std::format(" '{}'", token);
+        }
+        cmdLinePrint(message);
+        return false;
+    }
     
-    while (iss >> part) {
-        parts.push_back(part);
+    std::string_view m_commandName; // 命令名，用于错误信息
+    CommandArgs m_arguments;        // 参数
+    std::size_t m_index;            // 下一个待读取的参数
+};
+
+// 点选的默认容差（图形单位）
+constexpr float kDefaultPickTolerance = 1.0f;
+
+// 解析图形类型名
+bool parseShapeType(std::string_view name, ShapeType& out) {
+    if (name == "POINT") {
+        out = ShapeType::POINT;
+    } else if (name == "LINE") {
+        out = ShapeType::LINE;
+    } else if (name == "CIRCLE") {
+        out = ShapeType::CIRCLE;
+    } else if (name == "RECT" || name == "RECTANGLE") {
+        out = ShapeType::RECTANGLE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 获取当前选择中的图形，选择为空时输出提示
+std::vector<std::shared_ptr<Shape>> getSelectedShapes(Document& document, std::string_view commandName) {
+    auto shapes = document.getSelection().resolve(document.getLayerManager());
+    if (shapes.empty()) {
+        cmdLinePrint(std::format("{}: no shapes selected, use SELECT first", commandName));
     }
+    return shapes;
+}
+
+} // namespace
+
+// 解析命令
+bool CommandParser::parseCommand(std::string_view command) {
+    // 分割命令行，参数是指向command的视图，不复制字符串
+    TokenBuffer tokens;
+    ParseError error = CommandTokenizer::tokenize(command, tokens);
+    if (error != ParseError::None) {
+        cmdLinePrint(std::string("Invalid command: ") + CommandTokenizer::describeError(error));
+        return false;
+    }
+    if (tokens.empty()) {
+        return false;
+    }
+    
+    // 命令名只在此处规范化一次（命令名较短，不会超出短字符串的内部缓冲区）
+    std::string commandName = CommandRegistry::normalize(tokens[0]);
     
-    return parts;
+    // 执行命令
+    return dispatchCommand(commandName, tokens.tokens().subspan(1));
 }
 
 // 执行命令
 bool CommandParser::executeCommand(const std::string& commandName, const std::vector<std::string>& arguments) {
-    // 将命令转换为全大写
-    std::string upperCommandName = commandName;
-    std::transform(upperCommandName.begin(), upperCommandName.end(), upperCommandName.begin(), ::toupper);
-    
-    if (upperCommandName == "LINE") {
-        return executeLineCommand(arguments);
-    } else if (upperCommandName == "CIRCLE") {
-        return executeCircleCommand(arguments);
-    } else if (upperCommandName == "RECT") {
-        return executeRectCommand(arguments);
-    } else if (upperCommandName == "TRANSLATE") {
-        return executeTranslateCommand(arguments);
-    } else if (upperCommandName == "ROTATE") {
-        return executeRotateCommand(arguments);
-    } else if (upperCommandName == "SCALE") {
-        return executeScaleCommand(arguments);
-    } else if (upperCommandName == "LAYER") {
-        return executeLayerCommand(arguments);
-    } else if (upperCommandName == "DELETE_LAYER") {
-        return executeDeleteLayerCommand(arguments);
-    } else if (upperCommandName == "SWITCH_LAYER") {
-        return executeSwitchLayerCommand(arguments);
-    } else if (upperCommandName == "COLOR") {
-        return executeColorCommand(arguments);
-    } else if (upperCommandName == "UNDO") {
-        return executeUndoCommand(arguments);
-    } else if (upperCommandName == "REDO") {
-        return executeRedoCommand(arguments);
-    } else if (upperCommandName == "SAVE") {
-        return executeSaveCommand(arguments);
-    } else if (upperCommandName == "LOAD") {
-        return executeLoadCommand(arguments);
-    } else if (upperCommandName == "EXIT" || upperCommandName == "QUIT") {
-        return executeExitCommand(arguments);
-    } else if (upperCommandName == "HELP") {
-        return executeHelpCommand(arguments);
-    } else if (upperCommandName == "PROPERTIES") {
-        return executePropertiesCommand(arguments);
-    } else if (upperCommandName == "PROPERTIESCLOSE") {
-        return executePropertiesCloseCommand(arguments);
-    } else if (upperCommandName == "OPTIONS") {
-        return executeOptionsCommand(arguments);
-    } else if (upperCommandName == "NEW") {
-        return executeNewCommand(arguments);
-    } else if (upperCommandName == "OPEN") {
-        return executeOpenCommand(arguments);
-    } else if (upperCommandName == "SAVE") {
-        return executeSaveCommand(arguments);
-    } else if (upperCommandName == "SAVEAS") {
-        return executeSaveAsCommand(arguments);
-    } else if (upperCommandName == "CLOSE") {
-        return executeCloseCommand(arguments);
-    } else {
-        cmdLinePrint("Unknown command: " + commandName);
+    TokenBuffer tokens;
+    for (const auto& argument : arguments) {
+        tokens.push(argument);
+    }
+    return dispatchCommand(CommandRegistry::normalize(commandName), tokens.tokens());
+}
+
+// 按规范化的命令名分发命令
+bool CommandParser::dispatchCommand(std::string_view normalizedName, CommandArgs arguments) {
+    registerBuiltinCommands();
+    
+    const CommandDesc* desc = CommandRegistry::find(normalizedName);
+    if (!desc) {
+        cmdLinePrint("Unknown command: " + std::string(normalizedName));
+        return false;
+    }
+    
+    // 交互界面中不带参数的绘图命令启动交互工具，逐步取点；线程绑定的文档没有界面输入
+    bool startsTool = arguments.empty() && desc->tool && !FileManager::hasThreadDocument() && ToolScheduler::isEnabled();
+    
+    // 按注册的参数个数统一校验
+    if (!startsTool && (arguments.size() < desc->minArgs || arguments.size() > desc->maxArgs)) {
+        cmdLinePrint("Usage: " + CommandRegistry::formatUsage(*desc));
+        return false;
+    }
+    
+    // 操作界面或文件标签页的命令不能作用于线程绑定的文档
+    if (desc->uiOnly && FileManager::hasThreadDocument()) {
+        cmdLinePrint(desc->name + " is only available in the interactive UI");
         return false;
     }
+    
+    // 后台命令执行期间读取着当前文档，不接受其他命令；线程绑定文档的命令与后台命令无关
+    if (!FileManager::hasThreadDocument() && BackgroundCommand::isRunning()) {
+        cmdLinePrint(std::format("{} is still running, press Esc to cancel", BackgroundCommand::getName()));
+        return false;
+    }
+    
+    // 交互工具等待输入期间只能执行透明命令（工具的UNDO关键字依赖这一点），快捷键与菜单执行的其他命令先取消工具；
+    // 工具自身执行的命令不受影响，启动另一个工具时由ToolScheduler::start取消
+    if (!startsTool && !desc->transparent && !FileManager::hasThreadDocument() &&
+        ToolScheduler::isActive() && !ToolScheduler::isResuming()) {
+        cmdLinePrint(ToolScheduler::getName() + " cancelled");
+        ToolScheduler::cancel();
+    }
+    
+    if (startsTool) {
+        return ToolScheduler::start(desc->name, desc->tool());
+    }
+    
+    // 执行期间持有当前文档的写锁，后台任务读取该文档时会等待；
+    // 持有共享指针，保证命令关闭该文件时文档仍然有效
+    auto document = FileManager::getCurrentDocumentPtr();
+    std::unique_lock<std::shared_mutex> lock;
+    if (document) {
+        lock = document->lockExclusive();
+    }
+    
+    return desc->handler(arguments);
+}
+
+// 补全命令名
+std::vector<std::string> CommandParser::completeCommand(const std::string& prefix) {
+    registerBuiltinCommands();
+    return CommandRegistry::complete(prefix);
+}
+
+// 查找命令
+const CommandDesc* CommandParser::findCommand(std::string_view name) {
+    registerBuiltinCommands();
+    return CommandRegistry::find(CommandRegistry::normalize(name));
+}
+
+// 注册内置命令
+void CommandParser::registerBuiltinCommands() {
+    // 自动化服务的多个工作线程可能同时首次分发
+    static std::once_flag s_registered;
+    std::call_once(s_registered, registerBuiltinCommandsOnce);
+}
+
+// 注册内置命令的实际实现
+void CommandParser::registerBuiltinCommandsOnce() {
+    constexpr std::size_t kAny = CommandDesc::kUnlimitedArgs;
+    auto add = [](std::string name, std::vector<std::string> aliases, std::size_t minArgs, std::size_t maxArgs,
+                  std::string usage, std::string help, CommandHandler handler, bool uiOnly = false,
+                  bool transparent = false, ToolFactory tool = {}) {
+        CommandRegistry::registerCommand({std::move(name), std::move(aliases), minArgs, maxArgs,
+                                          std::move(usage), std::move(help), std::move(handler), uiOnly,
+                                          transparent, std::move(tool)});
+    };
+    
+    // 绘图（点参数可写作"X Y"、"X,Y"或"@DX,DY"，因此参数个数有上下限；不带参数时启动交互工具）
+    add("LINE", {"L"}, 2, 4, "X1 Y1 X2 Y2", "Draw a line", executeLineCommand, false, false, DrawingTools::line);
+    add("CIRCLE", {"C"}, 2, 3, "X Y RADIUS", "Draw a circle", executeCircleCommand, false, false, DrawingTools::circle);
+    add("RECT", {"REC", "RECTANG"}, 3, 4, "X Y WIDTH HEIGHT", "Draw a rectangle", executeRectCommand, false, false, DrawingTools::rect);
+    
+    // 选择
+    add("SELECT", {"SEL"}, 1, kAny, "[ADD|REMOVE] ALL|W P1 P2|C P1 P2|P PT [TOL] | NONE | FILTER TYPE|LAYER VALUE",
+        "Select shapes by window, crossing, point or filter", executeSelectCommand);
+    add("QSELECT", {"QS", "FILTER"}, 2, kAny, "[ADD|REMOVE] [TYPE T] [LAYER NAME] [COLOR R G B|NAME]",
+        "Select shapes by type, layer and color", executeQuickSelectCommand);
+    
+    // 变换
+    add("TRANSLATE", {"MOVE", "M"}, 1, 2, "X Y", "Translate selected shapes", executeTranslateCommand);
+    add("ROTATE", {"RO"}, 2, 3, "X Y ANGLE", "Rotate selected shapes", executeRotateCommand);
+    add("SCALE", {"SC"}, 2, 3, "X Y SCALE_FACTOR", "Scale selected shapes", executeScaleCommand);
+    add("ARRAY", {"AR"}, 4, 5, "R ROWS COLS ROW_DIST COL_DIST | P COUNT ANGLE X Y", "Array selected shapes (or the last drawn one)", executeArrayCommand);
+    
+    // 图层与颜色
+    add("LAYER", {"LA"}, 1, 1, "NAME", "Create a new layer", executeLayerCommand);
+    add("DELETE_LAYER", {}, 1, 1, "NAME", "Delete a layer", executeDeleteLayerCommand);
+    add("SWITCH_LAYER", {}, 1, 1, "NAME", "Switch to a layer", executeSwitchLayerCommand);
+    add("COLOR", {"COL"}, 1, 3, "R G B|NAME|#RRGGBB", "Set color of selected shapes", executeColorCommand);
+    
+    // 撤销/重做
+    add("UNDO", {"U"}, 0, 0, "", "Undo last operation", executeUndoCommand);
+    add("REDO", {}, 0, 0, "", "Redo last operation", executeRedoCommand);
+    add("BEGIN", {}, 0, 1, "[NAME]", "Begin a transaction, undone as one step", executeBeginCommand);
+    add("END", {}, 0, 0, "", "Commit the current transaction", executeEndCommand);
+    
+    // 文件（标签页操作只在交互界面中可用）
+    add("NEW", {}, 0, 0, "", "Create a new file", executeNewCommand, true);
+    add("OPEN", {}, 1, 1, "FILE_PATH", "Open a file", executeOpenCommand, true);
+    add("SAVE", {}, 0, 0, "", "Save current file", executeSaveCommand, true);
+    add("SAVEAS", {}, 1, 1, "FILE_PATH", "Save current file as", executeSaveAsCommand, true);
+    add("LOAD", {}, 1, 1, "FILE_PATH", "Load shapes into current file", executeLoadCommand);
+    add("EXPORT", {}, 1, 2, "FILE_PATH [R12|R2000]", "Export to .dxf or .svg", executeExportCommand);
+    add("CLOSE", {}, 0, 0, "", "Close current file", executeCloseCommand, true);
+    add("EXIT", {"QUIT"}, 0, kAny, "", "Exit the program", executeExitCommand, true);
+    
+    // 界面（透明命令，交互工具等待输入时也可执行）
+    add("HELP", {"?"}, 0, kAny, "", "Show this help", executeHelpCommand, false, true);
+    add("PROPERTIES", {"PR"}, 0, kAny, "", "Open properties bar", executePropertiesCommand, true, true);
+    add("PROPERTIESCLOSE", {}, 0, kAny, "", "Close properties bar", executePropertiesCloseCommand, true, true);
+    add("OPTIONS", {"OP"}, 0, kAny, "", "Open options dialog", executeOptionsCommand, true, true);
+    add("BIND", {}, 0, kAny, "[KEYS [COMMAND...]]", "List, show or change key bindings", executeBindCommand, true, true);
+    add("UNBIND", {}, 1, 1, "KEYS", "Remove a key binding", executeUnbindCommand, true, true);
+    add("KEYMAP", {}, 0, 1, "[FILE_PATH]", "Reload key bindings from keymap.json or a file", executeKeymapCommand, true, true);
+}
+
+// 标记当前文档内容已变更
+void CommandParser::markCurrentDocumentModified() {
+    Document& document = FileManager::getCurrentDocument();
+    document.touch();
+    
+    // 事务进行中时修改标记推迟到END时统一更新
+    if (document.isInTransaction()) {
+        return;
+    }
+    
+    // 以内容哈希判断是否修改，撤销回保存时的状态后标签不再显示修改标记；
+    // 线程绑定的文档不属于任何文件，findDocument返回-1，不影响标签
+    FileManager::markFileModified(FileManager::findDocument(document), document.isModifiedSinceSave());
 }
 
 // 执行绘制直线命令
-bool CommandParser::executeLineCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 4) {
-        cmdLinePrint("Usage: LINE X1 Y1 X2 Y2");
+bool CommandParser::executeLineCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    
+    // 起点相对上一个点，终点相对起点
+    ArgumentReader reader("LINE", arguments);
+    glm::vec2 start(0.0f), end(0.0f);
+    if (!reader.readPoint(document.getLastPoint(), start) || !reader.readPoint(start, end) || !reader.finish()) {
         return false;
     }
     
-    try {
-        float x1 = std::stof(arguments[0]);
-        float y1 = std::stof(arguments[1]);
-        float x2 = std::stof(arguments[2]);
-        float y2 = std::stof(arguments[3]);
+    // 创建直线
+    auto line = std::make_shared<Line>(start, end);
+    
+    // 获取当前图层
+    auto layer = document.getLayerManager().getCurrentLayer();
+    if (layer) {
+        // 添加到图层
+        layer->addShape(line);
         
-        // 创建直线
-        auto line = std::make_shared<Line>(glm::vec2(x1, y1), glm::vec2(x2, y2));
+        // 添加到撤销栈
+        document.getUndoRedoManager().addOperation(std::make_shared<DrawOperation>(document.getLayerManager(), line));
+        document.setLastPoint(end);
+        markCurrentDocumentModified();
         
-        // 获取当前图层
-        auto layer = LayerManager::getInstance().getCurrentLayer();
-        if (layer) {
-            // 添加到图层
-            layer->addShape(line);
-            
-            // 添加到撤销栈
-            UndoRedoManager::getInstance().addOperation(std::make_shared<DrawOperation>(line));
-            
-            cmdLinePrint("Line drawn from (" + std::to_string(x1) + ", " + std::to_string(y1) + ") to (" + std::to_string(x2) + ", " + std::to_string(y2) + ")");
-            return true;
-        }
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for LINE command");
+        cmdLinePrint("Line drawn from (" + std::to_string(start.x) + ", " + std::to_string(start.y) + ") to (" + std::to_string(end.x) + ", " + std::to_string(end.y) + ")");
+        return true;
     }
     
     return false;
 }
 
 // 执行绘制圆命令
-bool CommandParser::executeCircleCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 3) {
-        cmdLinePrint("Usage: CIRCLE X Y RADIUS");
+bool CommandParser::executeCircleCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    
+    ArgumentReader reader("CIRCLE", arguments);
+    glm::vec2 center(0.0f);
+    float radius = 0.0f;
+    if (!reader.readPoint(document.getLastPoint(), center) || !reader.readNumber(radius) || !reader.finish()) {
         return false;
     }
     
-    try {
-        float x = std::stof(arguments[0]);
-        float y = std::stof(arguments[1]);
-        float radius = std::stof(arguments[2]);
+    // 创建圆
+    auto circle = std::make_shared<Circle>(center, radius);
+    
+    // 获取当前图层
+    auto layer = document.getLayerManager().getCurrentLayer();
+    if (layer) {
+        // 添加到图层
+        layer->addShape(circle);
         
-        // 创建圆
-        auto circle = std::make_shared<Circle>(glm::vec2(x, y), radius);
+        // 添加到撤销栈
+        document.getUndoRedoManager().addOperation(std::make_shared<DrawOperation>(document.getLayerManager(), circle));
+        document.setLastPoint(center);
+        markCurrentDocumentModified();
         
-        // 获取当前图层
-        auto layer = LayerManager::getInstance().getCurrentLayer();
-        if (layer) {
-            // 添加到图层
-            layer->addShape(circle);
-            
-            // 添加到撤销栈
-            UndoRedoManager::getInstance().addOperation(std::make_shared<DrawOperation>(circle));
-            
-            cmdLinePrint("Circle drawn at (" + std::to_string(x) + ", " + std::to_string(y) + ") with radius " + std::to_string(radius));
-            return true;
-        }
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for CIRCLE command");
+        cmdLinePrint("Circle drawn at (" + std::to_string(center.x) + ", " + std::to_string(center.y) + ") with radius " + std::to_string(radius));
+        return true;
     }
     
     return false;
 }
 
 // 执行绘制矩形命令
-bool CommandParser::executeRectCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 4) {
-        cmdLinePrint("Usage: RECT X Y WIDTH HEIGHT");
+bool CommandParser::executeRectCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    
+    ArgumentReader reader("RECT", arguments);
+    glm::vec2 corner(0.0f);
+    float width = 0.0f;
+    float height = 0.0f;
+    if (!reader.readPoint(document.getLastPoint(), corner) || !reader.readNumber(width) || !reader.readNumber(height) || !reader.finish()) {
         return false;
     }
     
-    try {
-        float x = std::stof(arguments[0]);
-        float y = std::stof(arguments[1]);
-        float width = std::stof(arguments[2]);
-        float height = std::stof(arguments[3]);
+    // 创建矩形
+    auto rect = std::make_shared<Rectangle>(corner, width, height);
+    
+    // 获取当前图层
+    auto layer = document.getLayerManager().getCurrentLayer();
+    if (layer) {
+        // 添加到图层
+        layer->addShape(rect);
         
-        // 创建矩形
-        auto rect = std::make_shared<Rectangle>(glm::vec2(x, y), width, height);
+        // 添加到撤销栈
+        document.getUndoRedoManager().addOperation(std::make_shared<DrawOperation>(document.getLayerManager(), rect));
+        document.setLastPoint(corner);
+        markCurrentDocumentModified();
         
-        // 获取当前图层
-        auto layer = LayerManager::getInstance().getCurrentLayer();
-        if (layer) {
-            // 添加到图层
-            layer->addShape(rect);
-            
-            // 添加到撤销栈
-            UndoRedoManager::getInstance().addOperation(std::make_shared<DrawOperation>(rect));
-            
-            cmdLinePrint("Rectangle drawn at (" + std::to_string(x) + ", " + std::to_string(y) + ") with width " + std::to_string(width) + " and height " + std::to_string(height));
-            return true;
-        }
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for RECT command");
+        cmdLinePrint("Rectangle drawn at (" + std::to_string(corner.x) + ", " + std::to_string(corner.y) + ") with width " + std::to_string(width) + " and height " + std::to_string(height));
+        return true;
     }
     
     return false;
 }
 
-// 执行平移命令
-bool CommandParser::executeTranslateCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 2) {
-        cmdLinePrint("Usage: TRANSLATE X Y");
+// 执行选择命令
+bool CommandParser::executeSelectCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    SelectionSet& selection = document.getSelection();
+    ArgumentReader reader("SELECT", arguments);
+    
+    std::string method;
+    if (!reader.readKeyword(method)) {
         return false;
     }
     
-    try {
-        float x = std::stof(arguments[0]);
-        float y = std::stof(arguments[1]);
-        glm::vec2 delta(x, y);
+    // 可选的合并方式前缀
+    SelectMode mode = SelectMode::Replace;
+    if (method == "ADD" || method == "REMOVE") {
+        mode = method == "ADD" ? SelectMode::Add : SelectMode::Remove;
+        if (!reader.readKeyword(method)) {
+            return false;
+        }
+    }
+    
+    if (method == "ALL") {
+        if (!reader.finish()) {
+            return false;
+        }
+        selection.selectAll(document.getLayerManager(), mode);
+    } else if (method == "NONE") {
+        if (!reader.finish()) {
+            return false;
+        }
+        selection.clear();
+    } else if (method == "W" || method == "C") {
+        // 第二个角点相对第一个角点
+        glm::vec2 corner1(0.0f), corner2(0.0f);
+        if (!reader.readPoint(document.getLastPoint(), corner1) || !reader.readPoint(corner1, corner2) || !reader.finish()) {
+            return false;
+        }
+        const SpatialIndex& index = document.getSpatialIndex();
+        if (method == "W") {
+            selection.selectWindow(index, corner1, corner2, mode);
+        } else {
+            selection.selectCrossing(index, corner1, corner2, mode);
+        }
+    } else if (method == "P") {
+        glm::vec2 point(0.0f);
+        float tolerance = kDefaultPickTolerance;
+        if (!reader.readPoint(document.getLastPoint(), point) || (reader.hasMore() && !reader.readNumber(tolerance)) || !reader.finish()) {
+            return false;
+        }
+        selection.selectAtPoint(document.getSpatialIndex(), point, tolerance, mode);
+    } else if (method == "FILTER") {
+        // 在当前选择中过滤
+        std::string key, value;
+        if (!reader.readKeyword(key) || !reader.readText(value) || !reader.finish()) {
+            return false;
+        }
+        if (key == "TYPE") {
+            ShapeType type;
+            if (!parseShapeType(CommandRegistry::normalize(value), type)) {
+                cmdLinePrint("Unknown shape type: " + value);
+                return false;
+            }
+            selection.filter(document.getLayerManager(), [type](const Shape& shape) {
+                return shape.getType() == type;
+            });
+        } else if (key == "LAYER") {
+            Layer* layer = document.getLayerManager().getLayer(value);
+            if (!layer) {
+                cmdLinePrint("Layer not found: " + value);
+                return false;
+            }
+            int layerId = layer->getId();
+            selection.filter(document.getLayerManager(), [layerId](const Shape& shape) {
+                return shape.getLayer() == layerId;
+            });
+        } else {
+            cmdLinePrint("Unknown SELECT filter: " + key + ", use TYPE or LAYER");
+            return false;
+        }
+    } else {
+        cmdLinePrint("Unknown SELECT method: " + method);
+        return false;
+    }
+    
+    cmdLinePrint(std::format("{} shapes selected", selection.size()));
+    return true;
+}
+
+// 执行快速选择命令
+bool CommandParser::executeQuickSelectCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    LayerManager& layerManager = document.getLayerManager();
+    ArgumentReader reader("QSELECT", arguments);
+    
+    SelectMode mode = SelectMode::Replace;
+    AttributeQuery query;
+    bool first = true;
+    while (reader.hasMore()) {
+        std::string key;
+        if (!reader.readKeyword(key)) {
+            return false;
+        }
         
-        // 这里简化处理，实际应该获取选中的图形
-        // 这里只是示例，实际实现需要选中图形的逻辑
-        cmdLinePrint("Translate by (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-        return true;
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for TRANSLATE command");
+        if (first && (key == "ADD" || key == "REMOVE")) {
+            mode = key == "ADD" ? SelectMode::Add : SelectMode::Remove;
+        } else if (key == "TYPE") {
+            std::string typeName;
+            ShapeType type;
+            if (!reader.readKeyword(typeName)) {
+                return false;
+            }
+            if (!parseShapeType(typeName, type)) {
+                cmdLinePrint("Unknown shape type: " + typeName);
+                return false;
+            }
+            query.type = type;
+        } else if (key == "LAYER") {
+            std::string layerName;
+            if (!reader.readText(layerName)) {
+                return false;
+            }
+            Layer* layer = layerManager.getLayer(layerName);
+            if (!layer) {
+                cmdLinePrint("Layer not found: " + layerName);
+                return false;
+            }
+            query.layerId = layer->getId();
+        } else if (key == "COLOR") {
+            glm::vec3 color(0.0f);
+            if (!reader.readColor(color)) {
+                return false;
+            }
+            query.color = color;
+        } else {
+            cmdLinePrint("Unknown QSELECT condition: " + key + ", use TYPE, LAYER or COLOR");
+            return false;
+        }
+        first = false;
     }
     
-    return false;
+    if (!query.type && !query.layerId && !query.color) {
+        cmdLinePrint("QSELECT requires at least one of TYPE, LAYER or COLOR");
+        return false;
+    }
+    
+    std::size_t count = document.getSelection().selectByAttributes(layerManager, query, mode);
+    cmdLinePrint(std::format("{} shapes selected", count));
+    return true;
 }
 
-// 执行旋转命令
-bool CommandParser::executeRotateCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 3) {
-        cmdLinePrint("Usage: ROTATE X Y ANGLE");
+// 执行平移命令
+bool CommandParser::executeTranslateCommand(CommandArgs arguments) {
+    // 位移量本身就是相对值，dx,dy与@dx,dy含义相同
+    ArgumentReader reader("TRANSLATE", arguments);
+    glm::vec2 delta(0.0f);
+    if (!reader.readPoint(glm::vec2(0.0f), delta) || !reader.finish()) {
         return false;
     }
     
-    try {
-        float x = std::stof(arguments[0]);
-        float y = std::stof(arguments[1]);
-        float angle = std::stof(arguments[2]);
-        
-        // 这里简化处理，实际应该获取选中的图形
-        cmdLinePrint("Rotate by " + std::to_string(angle) + " degrees around (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-        return true;
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for ROTATE command");
+    Document& document = FileManager::getCurrentDocument();
+    auto shapes = getSelectedShapes(document, "TRANSLATE");
+    if (shapes.empty()) {
+        return false;
     }
     
-    return false;
+    // 整个选择集作为一个撤销步骤
+    std::size_t count = shapes.size();
+    document.getUndoRedoManager().addOperation(std::make_shared<BatchTransformOperation>(
+        document.getLayerManager(), std::move(shapes), BatchTransformOperation::Kind::Translate, delta));
+    markCurrentDocumentModified();
+    
+    cmdLinePrint("Translated " + std::to_string(count) + " shapes by (" + std::to_string(delta.x) + ", " + std::to_string(delta.y) + ")");
+    return true;
 }
 
-// 执行缩放命令
-bool CommandParser::executeScaleCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 3) {
-        cmdLinePrint("Usage: SCALE X Y SCALE_FACTOR");
+// 执行旋转命令
+bool CommandParser::executeRotateCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    
+    ArgumentReader reader("ROTATE", arguments);
+    glm::vec2 base(0.0f);
+    float angle = 0.0f;
+    if (!reader.readPoint(document.getLastPoint(), base) || !reader.readNumber(angle) || !reader.finish()) {
         return false;
     }
+    document.setLastPoint(base);
     
-    try {
-        float x = std::stof(arguments[0]);
-        float y = std::stof(arguments[1]);
-        float factor = std::stof(arguments[2]);
-        
-        // 这里简化处理，实际应该获取选中的图形
-        cmdLinePrint("Scale by " + std::to_string(factor) + " around (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-        return true;
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for SCALE command");
+    auto shapes = getSelectedShapes(document, "ROTATE");
+    if (shapes.empty()) {
+        return false;
     }
     
-    return false;
+    // 命令以角度输入，图形以弧度旋转
+    std::size_t count = shapes.size();
+    document.getUndoRedoManager().addOperation(std::make_shared<BatchTransformOperation>(
+        document.getLayerManager(), std::move(shapes), BatchTransformOperation::Kind::Rotate, base, glm::radians(angle)));
+    markCurrentDocumentModified();
+    
+    cmdLinePrint("Rotated " + std::to_string(count) + " shapes by " + std::to_string(angle) + " degrees around (" + std::to_string(base.x) + ", " + std::to_string(base.y) + ")");
+    return true;
 }
 
-// 执行创建图层命令
-bool CommandParser::executeLayerCommand(const std::vector<std::string>& arguments) {
-    if (arguments.empty()) {
-        cmdLinePrint("Usage: LAYER NAME");
+// 执行缩放命令
+bool CommandParser::executeScaleCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    
+    ArgumentReader reader("SCALE", arguments);
+    glm::vec2 base(0.0f);
+    float factor = 0.0f;
+    if (!reader.readPoint(document.getLastPoint(), base) || !reader.readNumber(factor) || !reader.finish()) {
+        return false;
+    }
+    if (factor == 0.0f) {
+        cmdLinePrint("Invalid arguments for SCALE command: SCALE_FACTOR must not be zero");
         return false;
     }
+    document.setLastPoint(base);
     
-    try {
-        std::string name = arguments[0];
-        
-        // 创建图层
-        int layerId = LayerManager::getInstance().createLayer(name);
-        cmdLinePrint("Layer created: " + name + " (ID: " + std::to_string(layerId) + ")");
-        return true;
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for LAYER command");
+    auto shapes = getSelectedShapes(document, "SCALE");
+    if (shapes.empty()) {
+        return false;
     }
     
-    return false;
+    std::size_t count = shapes.size();
+    document.getUndoRedoManager().addOperation(std::make_shared<BatchTransformOperation>(
+        document.getLayerManager(), std::move(shapes), BatchTransformOperation::Kind::Scale, base, factor));
+    markCurrentDocumentModified();
+    
+    cmdLinePrint("Scaled " + std::to_string(count) + " shapes by " + std::to_string(factor) + " around (" + std::to_string(base.x) + ", " + std::to_string(base.y) + ")");
+    return true;
 }
 
-// 执行删除图层命令
-bool CommandParser::executeDeleteLayerCommand(const std::vector<std::string>& arguments) {
-    if (arguments.empty()) {
-        cmdLinePrint("Usage: DELETE_LAYER NAME");
+// 执行阵列命令
+bool CommandParser::executeArrayCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    LayerManager& layerManager = document.getLayerManager();
+    auto layer = layerManager.getCurrentLayer();
+    if (!layer) {
         return false;
     }
     
-    try {
-        std::string name = arguments[0];
-        
-        // 获取图层
-        auto layer = LayerManager::getInstance().getLayer(name);
-        if (layer) {
-            // 删除图层
-            LayerManager::getInstance().deleteLayer(layer->getId());
-            cmdLinePrint("Layer deleted: " + name);
-            return true;
-        } else {
-            cmdLinePrint("Layer not found: " + name);
+    // 阵列源为选中的图形，没有选择时取当前图层最后绘制的图形
+    std::vector<std::shared_ptr<Shape>> sources = document.getSelection().resolve(layerManager);
+    if (sources.empty() && !layer->getShapes().empty()) {
+        sources.push_back(layer->getShapes().back());
+    }
+    if (sources.empty()) {
+        cmdLinePrint("Nothing to array: no selection and current layer is empty");
+        return false;
+    }
+    
+    std::string mode = CommandRegistry::normalize(arguments[0]);
+    ArgumentReader reader("ARRAY", arguments.subspan(1));
+    std::function<std::vector<std::shared_ptr<Shape>>(ProgressMonitor&)> generate;
+    if (mode == "R" || mode == "RECT") {
+        int rows = 0, cols = 0;
+        float rowSpacing = 0.0f, colSpacing = 0.0f;
+        if (!reader.readInteger(rows) || !reader.readInteger(cols) || !reader.readNumber(rowSpacing) || !reader.readNumber(colSpacing) || !reader.finish()) {
+            return false;
+        }
+        if (rows < 1 || cols < 1 || static_cast<std::uint64_t>(rows) * static_cast<std::uint64_t>(cols) * sources.size() > kMaxArrayCopies) {
+            cmdLinePrint(std::format("Invalid arguments for ARRAY command: ROWS and COLS must be at least 1, at most {} copies", kMaxArrayCopies));
+            return false;
         }
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for DELETE_LAYER command");
+        generate = [sources, rows, cols, rowSpacing, colSpacing](ProgressMonitor& progress) {
+            return Transform::rectangularArray(sources, rows, cols, rowSpacing, colSpacing, &progress);
+        };
+    } else if (mode == "P" || mode == "POLAR") {
+        int count = 0;
+        float angle = 0.0f;
+        glm::vec2 center(0.0f);
+        if (!reader.readInteger(count) || !reader.readNumber(angle) || !reader.readPoint(document.getLastPoint(), center) || !reader.finish()) {
+            return false;
+        }
+        if (count < 2 || static_cast<std::uint64_t>(count) * sources.size() > kMaxArrayCopies) {
+            cmdLinePrint(std::format("Invalid arguments for ARRAY command: COUNT must be at least 2, at most {} copies", kMaxArrayCopies));
+            return false;
+        }
+        generate = [sources, count, angle, center](ProgressMonitor& progress) {
+            return Transform::polarArray(sources, count, glm::radians(angle), center, &progress);
+        };
+    } else {
+        cmdLinePrint("Unknown ARRAY mode: " + std::string(arguments[0]) + ", use R (rectangular) or P (polar)");
+        return false;
+    }
+    
+    // 生成副本耗时，在后台执行；提交时按ID重新查找图层
+    int layerId = layer->getId();
+    return BackgroundCommand::run("ARRAY", FileManager::getCurrentDocumentPtr(), [generate, layerId](ProgressMonitor& progress) -> BackgroundCommand::Commit {
+        std::vector<std::shared_ptr<Shape>> copies = generate(progress);
+        return [copies = std::move(copies), layerId]() mutable {
+            if (copies.empty()) {
+                cmdLinePrint("Array produced no copies");
+                return true;
+            }
+            
+            Document& document = FileManager::getCurrentDocument();
+            LayerManager& layerManager = document.getLayerManager();
+            Layer* layer = layerManager.getLayer(layerId);
+            if (!layer) {
+                cmdLinePrint("Array target layer no longer exists");
+                return false;
+            }
+            
+            // 整批添加到图层并作为一个撤销步骤
+            std::size_t copyCount = copies.size();
+            layer->addShapes(copies);
+            document.getUndoRedoManager().addOperation(std::make_shared<BulkDrawOperation>(layerManager, layerId, std::move(copies), "Array"));
+            markCurrentDocumentModified();
+            
+            cmdLinePrint(std::format("Array created: {} copies", copyCount));
+            return true;
+        };
+    });
+}
+
+// 执行创建图层命令
+bool CommandParser::executeLayerCommand(CommandArgs arguments) {
+    std::string name(arguments[0]);
+    
+    // 创建图层
+    int layerId = FileManager::getCurrentDocument().getLayerManager().createLayer(name);
+    markCurrentDocumentModified();
+    cmdLinePrint("Layer created: " + name + " (ID: " + std::to_string(layerId) + ")");
+    return true;
+}
+
+// 执行删除图层命令
+bool CommandParser::executeDeleteLayerCommand(CommandArgs arguments) {
+    std::string name(arguments[0]);
+    
+    // 获取图层
+    LayerManager& layerManager = FileManager::getCurrentDocument().getLayerManager();
+    auto layer = layerManager.getLayer(name);
+    if (layer) {
+        // 删除图层
+        layerManager.deleteLayer(layer->getId());
+        markCurrentDocumentModified();
+        cmdLinePrint("Layer deleted: " + name);
+        return true;
+    } else {
+        cmdLinePrint("Layer not found: " + name);
     }
     
     return false;
 }
 
 // 执行切换图层命令
-bool CommandParser::executeSwitchLayerCommand(const std::vector<std::string>& arguments) {
-    if (arguments.empty()) {
-        cmdLinePrint("Usage: SWITCH_LAYER NAME");
-        return false;
-    }
+bool CommandParser::executeSwitchLayerCommand(CommandArgs arguments) {
+    std::string name(arguments[0]);
     
-    try {
-        std::string name = arguments[0];
-        
-        // 获取图层
-        auto layer = LayerManager::getInstance().getLayer(name);
-        if (layer) {
-            // 切换图层
-            LayerManager::getInstance().setCurrentLayer(layer->getId());
-            cmdLinePrint("Switched to layer: " + name);
-            return true;
-        } else {
-            cmdLinePrint("Layer not found: " + name);
-        }
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for SWITCH_LAYER command");
+    // 获取图层
+    LayerManager& layerManager = FileManager::getCurrentDocument().getLayerManager();
+    auto layer = layerManager.getLayer(name);
+    if (layer) {
+        // 切换图层
+        layerManager.setCurrentLayer(layer->getId());
+        cmdLinePrint("Switched to layer: " + name);
+        return true;
+    } else {
+        cmdLinePrint("Layer not found: " + name);
     }
     
     return false;
 }
 
 // 执行设置颜色命令
-bool CommandParser::executeColorCommand(const std::vector<std::string>& arguments) {
-    if (arguments.size() != 3) {
-        cmdLinePrint("Usage: COLOR R G B");
+bool CommandParser::executeColorCommand(CommandArgs arguments) {
+    ArgumentReader reader("COLOR", arguments);
+    glm::vec3 color(0.0f);
+    if (!reader.readColor(color) || !reader.finish()) {
         return false;
     }
     
-    try {
-        float r = std::stof(arguments[0]);
-        float g = std::stof(arguments[1]);
-        float b = std::stof(arguments[2]);
-        
-        // 这里简化处理，实际应该设置选中图形的颜色
-        cmdLinePrint("Set color to (" + std::to_string(r) + ", " + std::to_string(g) + ", " + std::to_string(b) + ")");
-        return true;
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for COLOR command");
+    Document& document = FileManager::getCurrentDocument();
+    auto shapes = getSelectedShapes(document, "COLOR");
+    if (shapes.empty()) {
+        return false;
     }
     
-    return false;
+    std::size_t count = shapes.size();
+    document.getUndoRedoManager().addOperation(std::make_shared<SetColorOperation>(document.getLayerManager(), std::move(shapes), color));
+    markCurrentDocumentModified();
+    
+    cmdLinePrint("Set color of " + std::to_string(count) + " shapes to (" + std::to_string(color.r) + ", " + std::to_string(color.g) + ", " + std::to_string(color.b) + ")");
+    return true;
 }
 
 // 执行撤销命令
-bool CommandParser::executeUndoCommand(const std::vector<std::string>& arguments) {
-    if (UndoRedoManager::getInstance().undo()) {
+bool CommandParser::executeUndoCommand(CommandArgs arguments) {
+    if (FileManager::getCurrentDocument().isInTransaction()) {
+        cmdLinePrint("Cannot undo inside a transaction, use END first");
+        return false;
+    }
+    if (FileManager::getCurrentDocument().getUndoRedoManager().undo()) {
+        markCurrentDocumentModified();
         cmdLinePrint("Undo successful");
         return true;
     } else {
@@ -392,8 +879,13 @@ bool CommandParser::executeUndoCommand(const std::vector<std::string>& arguments
 }
 
 // 执行重做命令
-bool CommandParser::executeRedoCommand(const std::vector<std::string>& arguments) {
-    if (UndoRedoManager::getInstance().redo()) {
+bool CommandParser::executeRedoCommand(CommandArgs arguments) {
+    if (FileManager::getCurrentDocument().isInTransaction()) {
+        cmdLinePrint("Cannot redo inside a transaction, use END first");
+        return false;
+    }
+    if (FileManager::getCurrentDocument().getUndoRedoManager().redo()) {
+        markCurrentDocumentModified();
         cmdLinePrint("Redo successful");
         return true;
     } else {
@@ -402,38 +894,110 @@ bool CommandParser::executeRedoCommand(const std::vector<std::string>& arguments
     }
 }
 
-// 执行加载命令
-bool CommandParser::executeLoadCommand(const std::vector<std::string>& arguments) {
-    if (arguments.empty()) {
-        cmdLinePrint("Usage: LOAD FILE_PATH");
+// 执行开始事务命令
+bool CommandParser::executeBeginCommand(CommandArgs arguments) {
+    std::string name = arguments.empty() ? "Batch" : std::string(arguments[0]);
+    FileManager::getCurrentDocument().beginTransaction(name);
+    cmdLinePrint("Transaction started: " + name);
+    return true;
+}
+
+// 执行提交事务命令
+bool CommandParser::executeEndCommand(CommandArgs arguments) {
+    Document& document = FileManager::getCurrentDocument();
+    if (!document.isInTransaction()) {
+        cmdLinePrint("No transaction in progress");
         return false;
     }
     
-    try {
-        std::string filePath = arguments[0];
-        
-        if (SaveLoad::loadFromFile(filePath)) {
+    std::size_t operationCount = document.getUndoRedoManager().getTransactionSize();
+    if (document.commitTransaction()) {
+        // 事务期间推迟的修改标记在此统一更新
+        FileManager::markFileModified(FileManager::findDocument(document), document.isModifiedSinceSave());
+    }
+    
+    if (document.isInTransaction()) {
+        cmdLinePrint("Nested transaction ended");
+    } else {
+        cmdLinePrint("Transaction committed: " + std::to_string(operationCount) + " operations");
+    }
+    return true;
+}
+
+// 执行加载命令
+bool CommandParser::executeLoadCommand(CommandArgs arguments) {
+    std::string filePath(arguments[0]);
+    
+    // 解析文件不涉及文档，在后台执行；解析结果在主线程上替换文档内容
+    return BackgroundCommand::run("LOAD", FileManager::getCurrentDocumentPtr(), [filePath](ProgressMonitor& progress) -> BackgroundCommand::Commit {
+        std::vector<LoadedLayer> layers;
+        if (!SaveLoad::parseFile(filePath, layers, &progress)) {
+            return [filePath] {
+                cmdLinePrint("Failed to load file: " + filePath);
+                return false;
+            };
+        }
+        return [filePath, layers = std::move(layers)]() mutable {
+            // 加载到当前文档，原有图形被替换，撤销历史随之失效
+            Document& document = FileManager::getCurrentDocument();
+            SaveLoad::applyLayers(document.getLayerManager(), std::move(layers));
+            document.getUndoRedoManager().clear();
+            markCurrentDocumentModified();
             cmdLinePrint("Loaded from file: " + filePath);
             return true;
-        } else {
-            cmdLinePrint("Failed to load file: " + filePath);
+        };
+    });
+}
+
+// 执行导出命令
+bool CommandParser::executeExportCommand(CommandArgs arguments) {
+    std::string filePath(arguments[0]);
+    std::string extension = std::filesystem::path(filePath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    
+    DxfVersion version = DxfVersion::R2000;
+    if (extension == ".dxf") {
+        if (arguments.size() == 2) {
+            std::string versionName(arguments[1]);
+            std::transform(versionName.begin(), versionName.end(), versionName.begin(), ::toupper);
+            if (versionName == "R12") {
+                version = DxfVersion::R12;
+            } else if (versionName != "R2000") {
+                cmdLinePrint("Unsupported DXF version: " + std::string(arguments[1]));
+                return false;
+            }
         }
-    } catch (...) {
-        cmdLinePrint("Invalid arguments for LOAD command");
+    } else if (extension != ".svg") {
+        cmdLinePrint("Unsupported export format: " + extension);
+        return false;
     }
     
-    return false;
+    // 导出只读取文档，在后台执行
+    return BackgroundCommand::run("EXPORT", FileManager::getCurrentDocumentPtr(), [filePath, extension, version](ProgressMonitor& progress) -> BackgroundCommand::Commit {
+        const LayerManager& layerManager = FileManager::getCurrentDocument().getLayerManager();
+        bool success = extension == ".dxf"
+            ? SaveLoad::exportToDXF(layerManager, filePath, version, &progress)
+            : SaveLoad::exportToSVG(layerManager, filePath, &progress);
+        return [filePath, success] {
+            if (success) {
+                cmdLinePrint("Exported to file: " + filePath);
+            } else {
+                cmdLinePrint("Failed to export file: " + filePath);
+            }
+            return success;
+        };
+    });
 }
 
 // 执行退出命令
-bool CommandParser::executeExitCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executeExitCommand(CommandArgs arguments) {
     cmdLinePrint("Exiting...");
     // 这里简化处理，实际应该清理资源并退出程序
     return true;
 }
 
 // 执行属性栏命令
-bool CommandParser::executePropertiesCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executePropertiesCommand(CommandArgs arguments) {
     // 检查属性栏是否已经打开
     if (!Renderer::isPropertyBarVisible()) {
         // 如果没有打开，则打开属性栏
@@ -445,7 +1009,7 @@ bool CommandParser::executePropertiesCommand(const std::vector<std::string>& arg
 }
 
 // 执行关闭属性栏命令
-bool CommandParser::executePropertiesCloseCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executePropertiesCloseCommand(CommandArgs arguments) {
     // 检查属性栏是否已经关闭
     if (Renderer::isPropertyBarVisible()) {
         // 如果没有关闭，则关闭属性栏
@@ -457,47 +1021,100 @@ bool CommandParser::executePropertiesCloseCommand(const std::vector<std::string>
 }
 
 // 执行选项命令
-bool CommandParser::executeOptionsCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executeOptionsCommand(CommandArgs arguments) {
     // 设置选项对话框为可见
     Renderer::showOptionsDialog(true);
     return true;
 }
 
+// 执行按键绑定命令：无参数时列出全部绑定，只给按键时显示其绑定，否则把其余参数作为命令绑定到按键
+bool CommandParser::executeBindCommand(CommandArgs arguments) {
+    Keymap& keymap = InputHandler::getKeymap();
+    if (arguments.empty()) {
+        auto bindings = keymap.getBindings();
+        cmdLinePrint(std::format("Key bindings ({}):", bindings.size()));
+        for (const auto& [keys, command] : bindings) {
+            cmdLinePrint(std::format("  {:<24}- {}", keys, command));
+        }
+        return true;
+    }
+    
+    std::vector<KeyChord> sequence;
+    if (!Keymap::parseSequence(arguments[0], sequence)) {
+        cmdLinePrint(std::format("Invalid key sequence: {}", arguments[0]));
+        return false;
+    }
+    std::string keys = Keymap::formatSequence(sequence);
+    
+    if (arguments.size() == 1) {
+        const std::string* command = keymap.find(keys);
+        cmdLinePrint(command ? std::format("{} - {}", keys, *command) : std::format("{} is not bound", keys));
+        return true;
+    }
+    
+    // 命令参数原样拼接，含空白的参数重新加上引号
+    std::string command;
+    for (std::size_t i = 1; i < arguments.size(); ++i) {
+        bool quoted = arguments[i].find_first_of(" \t") != std::string_view::npos;
+        command += std::format("{}{}{}{}", i > 1 ? " " : "", quoted ? "\"" : "", arguments[i], quoted ? "\"" : "");
+    }
+    
+    std::string error;
+    if (!keymap.bind(keys, command, error)) {
+        cmdLinePrint(std::format("Failed to bind {}: {}", keys, error));
+        return false;
+    }
+    cmdLinePrint(std::format("Bound {} to: {}", keys, command));
+    return true;
+}
+
+// 执行解除按键绑定命令
+bool CommandParser::executeUnbindCommand(CommandArgs arguments) {
+    if (!InputHandler::getKeymap().unbind(arguments[0])) {
+        cmdLinePrint(std::format("Key sequence is not bound: {}", arguments[0]));
+        return false;
+    }
+    cmdLinePrint(std::format("Unbound: {}", arguments[0]));
+    return true;
+}
+
+// 执行重新加载按键绑定命令：恢复默认绑定后加载keymap.json或指定的文件
+bool CommandParser::executeKeymapCommand(CommandArgs arguments) {
+    std::filesystem::path path = arguments.empty() ? std::filesystem::path() : std::filesystem::path(std::string(arguments[0]));
+    if (!InputHandler::reloadKeymap(path)) {
+        cmdLinePrint(std::format("Failed to load key bindings: {}", path.empty() ? "keymap.json" : path.string()));
+        return false;
+    }
+    cmdLinePrint(std::format("Key bindings reloaded ({} bound)", InputHandler::getKeymap().getBindings().size()));
+    return true;
+}
+
 // 执行帮助命令
-bool CommandParser::executeHelpCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executeHelpCommand(CommandArgs arguments) {
     showHelp();
     return true;
 }
 
-// 显示帮助信息
+// 显示帮助信息，由命令注册表生成
 void CommandParser::showHelp() {
+    registerBuiltinCommands();
+    
     cmdLinePrint("Available commands:");
-    cmdLinePrint("  LINE X1 Y1 X2 Y2        - Draw a line");
-    cmdLinePrint("  CIRCLE X Y RADIUS       - Draw a circle");
-    cmdLinePrint("  RECT X Y WIDTH HEIGHT   - Draw a rectangle");
-    cmdLinePrint("  TRANSLATE X Y           - Translate selected shapes");
-    cmdLinePrint("  ROTATE X Y ANGLE        - Rotate selected shapes");
-    cmdLinePrint("  SCALE X Y SCALE_FACTOR  - Scale selected shapes");
-    cmdLinePrint("  LAYER NAME              - Create a new layer");
-    cmdLinePrint("  DELETE_LAYER NAME       - Delete a layer");
-    cmdLinePrint("  SWITCH_LAYER NAME       - Switch to a layer");
-    cmdLinePrint("  COLOR R G B             - Set color");
-    cmdLinePrint("  UNDO                    - Undo last operation");
-    cmdLinePrint("  REDO                    - Redo last operation");
-    cmdLinePrint("  NEW                     - Create a new file");
-    cmdLinePrint("  OPEN FILE_PATH          - Open a file");
-    cmdLinePrint("  SAVE                    - Save current file");
-    cmdLinePrint("  SAVEAS FILE_PATH        - Save current file as");
-    cmdLinePrint("  CLOSE                   - Close current file");
-    cmdLinePrint("  EXIT                    - Exit the program");
-    cmdLinePrint("  HELP                    - Show this help");
-    cmdLinePrint("  PROPERTIES              - Open properties bar");
-    cmdLinePrint("  PROPERTIESCLOSE         - Close properties bar");
-    cmdLinePrint("  OPTIONS                 - Open options dialog");
+    for (const auto& desc : CommandRegistry::getCommands()) {
+        std::string line = std::format("  {:<24}- {}", CommandRegistry::formatUsage(desc), desc.help);
+        if (!desc.aliases.empty()) {
+            line += " (";
+            for (std::size_t i = 0; i < desc.aliases.size(); ++i) {
+                line += (i > 0 ? ", " : "") + desc.aliases[i];
+            }
+            line += ")";
+        }
+        cmdLinePrint(line);
+    }
 }
 
 // 执行新建文件命令
-bool CommandParser::executeNewCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executeNewCommand(CommandArgs arguments) {
     std::size_t index = FileManager::createNewFile();
     if (index < FileManager::getFileCount()) {
         cmdLinePrint("New file created: " + FileManager::getFile(index).getFullFileName());
@@ -509,13 +1126,8 @@ bool CommandParser::executeNewCommand(const std::vector<std::string>& arguments)
 }
 
 // 执行打开文件命令
-bool CommandParser::executeOpenCommand(const std::vector<std::string>& arguments) {
-    if (arguments.empty()) {
-        cmdLinePrint("Usage: OPEN FILE_PATH");
-        return false;
-    }
-    
-    std::string filePath = arguments[0];
+bool CommandParser::executeOpenCommand(CommandArgs arguments) {
+    std::string filePath(arguments[0]);
     std::size_t index = FileManager::openFile(filePath);
     if (index < FileManager::getFileCount()) {
         cmdLinePrint("Opened file: " + FileManager::getFile(index).getFullFileName());
@@ -527,7 +1139,7 @@ bool CommandParser::executeOpenCommand(const std::vector<std::string>& arguments
 }
 
 // 执行保存文件命令
-bool CommandParser::executeSaveCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executeSaveCommand(CommandArgs arguments) {
     std::size_t currentIndex = FileManager::getCurrentFileIndex();
     if (FileManager::saveFile(currentIndex)) {
         cmdLinePrint("Saved file: " + FileManager::getCurrentFile().getFullFileName());
@@ -539,13 +1151,8 @@ bool CommandParser::executeSaveCommand(const std::vector<std::string>& arguments
 }
 
 // 执行另存为命令
-bool CommandParser::executeSaveAsCommand(const std::vector<std::string>& arguments) {
-    if (arguments.empty()) {
-        cmdLinePrint("Usage: SAVEAS FILE_PATH");
-        return false;
-    }
-    
-    std::string filePath = arguments[0];
+bool CommandParser::executeSaveAsCommand(CommandArgs arguments) {
+    std::string filePath(arguments[0]);
     std::size_t currentIndex = FileManager::getCurrentFileIndex();
     if (FileManager::saveFileAs(currentIndex, filePath)) {
         cmdLinePrint("Saved file as: " + FileManager::getCurrentFile().getFullFileName());
@@ -557,7 +1164,7 @@ bool CommandParser::executeSaveAsCommand(const std::vector<std::string>& argumen
 }
 
 // 执行关闭文件命令
-bool CommandParser::executeCloseCommand(const std::vector<std::string>& arguments) {
+bool CommandParser::executeCloseCommand(CommandArgs arguments) {
     std::size_t currentIndex = FileManager::getCurrentFileIndex();
     if (FileManager::closeFile(currentIndex)) {
         cmdLinePrint("Closed file. Current file: " + FileManager::getCurrentFile().getFullFileName());
@@ -0,0 +1,79 @@
+#include "command/CommandRegistry.h"
+#include <algorithm>
+#include <cctype>
+
+namespace tch {
+
+// 静态成员初始化
+std::vector<CommandDesc> CommandRegistry::s_commands;
+std::unordered_map<std::string, std::size_t, CommandRegistry::KeyHash, std::equal_to<>> CommandRegistry::s_lookup;
+std::vector<std::string> CommandRegistry::s_sortedKeys;
+
+// 注册命令
+bool CommandRegistry::registerCommand(CommandDesc desc) {
+    desc.name = normalize(desc.name);
+    for (auto& alias : desc.aliases) {
+        alias = normalize(alias);
+    }
+    
+    // 检查名称与别名是否冲突
+    if (s_lookup.contains(desc.name)) {
+        return false;
+    }
+    for (const auto& alias : desc.aliases) {
+        if (s_lookup.contains(alias) || alias == desc.name) {
+            return false;
+        }
+    }
+    
+    std::size_t index = s_commands.size();
+    s_lookup.emplace(desc.name, index);
+    s_sortedKeys.insert(std::upper_bound(s_sortedKeys.begin(), s_sortedKeys.end(), desc.name), desc.name);
+    for (const auto& alias : desc.aliases) {
+        s_lookup.emplace(alias, index);
+        s_sortedKeys.insert(std::upper_bound(s_sortedKeys.begin(), s_sortedKeys.end(), alias), alias);
+    }
+    s_commands.push_back(std::move(desc));
+    return true;
+}
+
+// 按规范化名称或别名查找命令
+const CommandDesc* CommandRegistry::find(std::string_view normalizedName) {
+    auto it = s_lookup.find(normalizedName);
+    if (it == s_lookup.end()) {
+        return nullptr;
+    }
+    return &s_commands[it->second];
+}
+
+// 获取全部命令
+const std::vector<CommandDesc>& CommandRegistry::getCommands() {
+    return s_commands;
+}
+
+// 补全：返回以prefix开头的命令名与别名
+std::vector<std::string> CommandRegistry::complete(std::string_view prefix) {
+    std::string key = normalize(prefix);
+    std::vector<std::string> result;
+    for (auto it = std::lower_bound(s_sortedKeys.begin(), s_sortedKeys.end(), key);
+         it != s_sortedKeys.end() && it->compare(0, key.size(), key) == 0; ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+// 规范化命令名（转为大写）
+std::string CommandRegistry::normalize(std::string_view name) {
+    std::string result(name);
+    for (char& c : result) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    return result;
+}
+
+// 格式化命令用法
+std::string CommandRegistry::formatUsage(const CommandDesc& desc) {
+    return desc.usage.empty() ? desc.name : desc.name + " " + desc.usage;
+}
+
+} // namespace tch
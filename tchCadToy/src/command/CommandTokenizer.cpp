@@ -0,0 +1,190 @@
+#include "command/CommandTokenizer.h"
+#include <charconv>
+#include <cmath>
+
+namespace tch {
+
+// 追加一个单元
+void TokenBuffer::push(std::string_view token) {
+    if (m_overflow.empty() && m_size < kInlineCapacity) {
+        m_inline[m_size++] = token;
+        return;
+    }
+    
+    // 内部存储已满，转存到堆上
+    if (m_overflow.empty()) {
+        m_overflow.reserve(kInlineCapacity * 2);
+        m_overflow.assign(m_inline.begin(), m_inline.begin() + m_size);
+    }
+    m_overflow.push_back(token);
+    ++m_size;
+}
+
+// 清空
+void TokenBuffer::clear() {
+    m_overflow.clear();
+    m_size = 0;
+}
+
+namespace CommandTokenizer {
+
+namespace {
+
+// 是否为空白字符
+constexpr bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+} // namespace
+
+// 按空白分割命令行
+ParseError tokenize(std::string_view line, TokenBuffer& out) {
+    out.clear();
+    
+    const char* cursor = line.data();
+    const char* end = cursor + line.size();
+    while (cursor != end) {
+        if (isSpace(*cursor)) {
+            ++cursor;
+            continue;
+        }
+        
+        // 引号内的内容整体作为一个单元，用于带空格的文件路径
+        if (*cursor == '"') {
+            const char* begin = ++cursor;
+            while (cursor != end && *cursor != '"') {
+                ++cursor;
+            }
+            if (cursor == end) {
+                return ParseError::UnterminatedQuote;
+            }
+            out.push(std::string_view(begin, cursor - begin));
+            ++cursor;
+            continue;
+        }
+        
+        const char* begin = cursor;
+        while (cursor != end && !isSpace(*cursor)) {
+            ++cursor;
+        }
+        out.push(std::string_view(begin, cursor - begin));
+    }
+    
+    return ParseError::None;
+}
+
+// 解析数值
+ParseError parseNumber(std::string_view token, float& out) {
+    if (token.empty()) {
+        return ParseError::Empty;
+    }
+    
+    // from_chars不接受前导'+'
+    if (token.front() == '+') {
+        token.remove_prefix(1);
+        if (token.empty() || token.front() == '-' || token.front() == '+') {
+            return ParseError::InvalidNumber;
+        }
+    }
+    
+    float value = 0.0f;
+    auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (ec == std::errc::result_out_of_range) {
+        return ParseError::OutOfRange;
+    }
+    if (ec != std::errc() || ptr != token.data() + token.size() || !std::isfinite(value)) {
+        return ParseError::InvalidNumber;
+    }
+    
+    out = value;
+    return ParseError::None;
+}
+
+// 解析整数
+ParseError parseInteger(std::string_view token, int& out) {
+    if (token.empty()) {
+        return ParseError::Empty;
+    }
+    
+    // from_chars不接受前导'+'
+    if (token.front() == '+') {
+        token.remove_prefix(1);
+        if (token.empty() || token.front() == '-' || token.front() == '+') {
+            return ParseError::InvalidNumber;
+        }
+    }
+    
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (ec == std::errc::result_out_of_range) {
+        return ParseError::OutOfRange;
+    }
+    if (ec != std::errc() || ptr != token.data() + token.size()) {
+        return ParseError::InvalidNumber;
+    }
+    
+    out = value;
+    return ParseError::None;
+}
+
+// 解析坐标
+ParseError parsePoint(std::string_view token, PointToken& out) {
+    if (token.empty()) {
+        return ParseError::Empty;
+    }
+    
+    bool relative = token.front() == '@';
+    if (relative) {
+        token.remove_prefix(1);
+    }
+    
+    std::size_t comma = token.find(',');
+    if (comma == std::string_view::npos || token.find(',', comma + 1) != std::string_view::npos) {
+        return ParseError::InvalidPoint;
+    }
+    
+    glm::vec2 value(0.0f);
+    ParseError error = parseNumber(token.substr(0, comma), value.x);
+    if (error == ParseError::None) {
+        error = parseNumber(token.substr(comma + 1), value.y);
+    }
+    if (error != ParseError::None) {
+        return error == ParseError::OutOfRange ? error : ParseError::InvalidPoint;
+    }
+    
+    out.value = value;
+    out.relative = relative;
+    return ParseError::None;
+}
+
+// 单元是否为坐标写法
+bool isPointToken(std::string_view token) {
+    return !token.empty() && (token.front() == '@' || token.find(',') != std::string_view::npos);
+}
+
+// 获取错误描述
+const char* describeError(ParseError error) {
+    switch (error) {
+        case ParseError::None:
+            return "no error";
+        case ParseError::Empty:
+            return "empty argument";
+        case ParseError::InvalidNumber:
+            return "invalid number";
+        case ParseError::OutOfRange:
+            return "number out of range";
+        case ParseError::InvalidPoint:
+            return "invalid point, expected X,Y or @DX,DY";
+        case ParseError::UnterminatedQuote:
+            return "unterminated quote";
+        case ParseError::MissingArgument:
+            return "missing argument";
+        case ParseError::ExtraArgument:
+            return "too many arguments";
+    }
+    return "unknown error";
+}
+
+} // namespace CommandTokenizer
+
+} // namespace tch
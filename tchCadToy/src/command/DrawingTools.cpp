@@ -0,0 +1,107 @@
+#include "command/DrawingTools.h"
+#include "command/CommandParser.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <string>
+#include <vector>
+
+namespace tch {
+
+namespace {
+
+// 数值按最短的往返格式转为命令参数，不损失精度
+std::string formatToolNumber(float value) {
+    return std::format("{}", value);
+}
+
+// 以完整参数执行LINE命令
+bool drawToolLine(const glm::vec2& start, const glm::vec2& end) {
+    return CommandParser::executeCommand("LINE", {formatToolNumber(start.x), formatToolNumber(start.y),
+                                                  formatToolNumber(end.x), formatToolNumber(end.y)});
+}
+
+} // namespace
+
+// 直线
+ToolTask DrawingTools::line() {
+    ToolInput first = co_await ToolScheduler::getPoint("Specify first point:");
+    if (first.kind != ToolInputKind::Point) {
+        co_return;
+    }
+    
+    // 已画出的各段的端点，Undo时回退一段
+    std::vector<glm::vec2> points{first.point};
+    while (true) {
+        std::vector<std::string> keywords;
+        std::string prompt = "Specify next point:";
+        if (points.size() > 2) {
+            keywords = {"CLOSE", "UNDO"};
+            prompt = "Specify next point or [Close/Undo]:";
+        } else if (points.size() > 1) {
+            keywords = {"UNDO"};
+            prompt = "Specify next point or [Undo]:";
+        }
+        
+        ToolInput next = co_await ToolScheduler::getPoint(std::move(prompt), points.back(), std::move(keywords));
+        if (next.kind == ToolInputKind::Point) {
+            if (!drawToolLine(points.back(), next.point)) {
+                co_return;
+            }
+            points.push_back(next.point);
+        } else if (next.kind == ToolInputKind::Keyword && next.keyword == "UNDO") {
+            // 期间只可能执行了透明命令，撤销栈顶就是上一段
+            if (!CommandParser::executeCommand("UNDO", {})) {
+                co_return;
+            }
+            points.pop_back();
+        } else if (next.kind == ToolInputKind::Keyword && next.keyword == "CLOSE") {
+            drawToolLine(points.back(), points.front());
+            co_return;
+        } else {
+            co_return;
+        }
+    }
+}
+
+// 圆
+ToolTask DrawingTools::circle() {
+    ToolInput center = co_await ToolScheduler::getPoint("Specify center point:");
+    if (center.kind != ToolInputKind::Point) {
+        co_return;
+    }
+    
+    std::vector<std::string> keywords = {"DIAMETER"};
+    ToolInput radius = co_await ToolScheduler::getDistance("Specify radius or [Diameter]:", center.point, std::move(keywords));
+    if (radius.kind == ToolInputKind::Keyword) {
+        radius = co_await ToolScheduler::getDistance("Specify diameter:", center.point);
+        radius.distance /= 2.0f;
+    }
+    if (radius.kind != ToolInputKind::Distance) {
+        co_return;
+    }
+    
+    CommandParser::executeCommand("CIRCLE", {formatToolNumber(center.point.x), formatToolNumber(center.point.y),
+                                             formatToolNumber(radius.distance)});
+}
+
+// 矩形
+ToolTask DrawingTools::rect() {
+    ToolInput first = co_await ToolScheduler::getPoint("Specify first corner point:");
+    if (first.kind != ToolInputKind::Point) {
+        co_return;
+    }
+    
+    ToolInput other = co_await ToolScheduler::getPoint("Specify other corner point:", first.point);
+    if (other.kind != ToolInputKind::Point) {
+        co_return;
+    }
+    
+    // RECT命令的参数为左下角与宽高
+    glm::vec2 corner(std::min(first.point.x, other.point.x), std::min(first.point.y, other.point.y));
+    CommandParser::executeCommand("RECT", {formatToolNumber(corner.x), formatToolNumber(corner.y),
+                                           formatToolNumber(std::abs(other.point.x - first.point.x)),
+                                           formatToolNumber(std::abs(other.point.y - first.point.y))});
+}
+
+} // namespace tch
@@ -0,0 +1,293 @@
+#include "command/InteractiveTool.h"
+#include "command/CommandParser.h"
+#include "command/CommandRegistry.h"
+#include "command/CommandTokenizer.h"
+#include "file/FileManager.h"
+#include "file/Document.h"
+#include "utils/GlobalUtils.h"
+#include "debug/Logger.h"
+#include <cmath>
+#include <format>
+
+namespace tch {
+
+// 静态成员初始化
+bool ToolScheduler::s_enabled = false;
+std::optional<ToolTask> ToolScheduler::s_task;
+std::string ToolScheduler::s_name;
+std::shared_ptr<Document> ToolScheduler::s_document;
+ToolRequest ToolScheduler::s_request;
+ToolInput ToolScheduler::s_input;
+bool ToolScheduler::s_waiting = false;
+bool ToolScheduler::s_resumePending = false;
+bool ToolScheduler::s_resuming = false;
+
+// 挂起时登记等待的输入
+void ToolInputAwaiter::await_suspend(std::coroutine_handle<>) {
+    ToolScheduler::beginWait(std::move(request));
+}
+
+// 恢复时取回收到的输入
+ToolInput ToolInputAwaiter::await_resume() {
+    return ToolScheduler::takeInput();
+}
+
+// 启用交互工具
+void ToolScheduler::setEnabled(bool enabled) {
+    s_enabled = enabled;
+}
+
+// 是否启用交互工具
+bool ToolScheduler::isEnabled() {
+    return s_enabled;
+}
+
+// 启动交互工具
+bool ToolScheduler::start(const std::string& name, ToolTask task) {
+    if (s_task) {
+        cmdLinePrint(s_name + " cancelled");
+        finish();
+    }
+    
+    // 启动命令的分发仍持有文档的写锁，工具在下一次poll时才开始执行，其中执行的命令可以再次取得写锁
+    s_task.emplace(std::move(task));
+    s_name = name;
+    s_document = FileManager::getCurrentDocumentPtr();
+    s_resumePending = true;
+    LOG_INFO("Interactive tool started: {}", name);
+    return true;
+}
+
+// 是否有交互工具正在执行
+bool ToolScheduler::isActive() {
+    return s_task.has_value();
+}
+
+// 是否正在恢复交互工具
+bool ToolScheduler::isResuming() {
+    return s_resuming;
+}
+
+// 当前交互工具的名称
+const std::string& ToolScheduler::getName() {
+    return s_name;
+}
+
+// 当前的提示
+const std::string& ToolScheduler::getPrompt() {
+    return s_request.prompt;
+}
+
+// 提交命令栏输入
+bool ToolScheduler::submitText(std::string_view text) {
+    if (!s_waiting) {
+        return false;
+    }
+    
+    ToolInput input;
+    if (parseInput(text, input)) {
+        deliver(std::move(input));
+        return true;
+    }
+    
+    // 透明命令不修改文档，执行后工具停留在当前步骤
+    TokenBuffer tokens;
+    if (CommandTokenizer::tokenize(text, tokens) == ParseError::None && !tokens.empty()) {
+        const CommandDesc* desc = CommandRegistry::find(CommandRegistry::normalize(tokens[0]));
+        if (desc && desc->transparent) {
+            CommandParser::parseCommand(text);
+            return true;
+        }
+    }
+    
+    if (s_request.kind == ToolInputKind::Distance) {
+        cmdLinePrint("Invalid input: expected a distance or a point");
+    } else {
+        cmdLinePrint("Invalid input: expected a point (X,Y, @DX,DY or X Y)");
+    }
+    return true;
+}
+
+// 提交画布上点击的点
+bool ToolScheduler::submitPoint(const glm::vec2& point) {
+    if (!s_waiting) {
+        return false;
+    }
+    
+    // 鼠标取的点与命令栏输入一样写入命令历史
+    cmdLinePrint(std::format("{} {:.4f},{:.4f}", s_request.prompt, point.x, point.y));
+    
+    ToolInput input;
+    if (s_request.kind == ToolInputKind::Distance) {
+        glm::vec2 base = s_request.base.value_or(glm::vec2(0.0f));
+        input.kind = ToolInputKind::Distance;
+        input.distance = std::hypot(point.x - base.x, point.y - base.y);
+    } else {
+        input.kind = ToolInputKind::Point;
+        input.point = point;
+    }
+    deliver(std::move(input));
+    return true;
+}
+
+// 取消正在执行的交互工具
+bool ToolScheduler::cancel() {
+    if (!s_task) {
+        return false;
+    }
+    LOG_INFO("Interactive tool cancelled: {}", s_name);
+    finish();
+    return true;
+}
+
+// 有输入时恢复交互工具
+void ToolScheduler::poll() {
+    if (!s_task) {
+        return;
+    }
+    
+    // 工具的点与撤销步骤都属于启动时的文档
+    if (FileManager::getCurrentDocumentPtr() != s_document) {
+        cmdLinePrint(s_name + " cancelled: current file changed");
+        finish();
+        return;
+    }
+    
+    // 等待输入时只有这一次判断的开销
+    if (!s_resumePending) {
+        return;
+    }
+    s_resumePending = false;
+    s_resuming = true;
+    s_task->resume();
+    s_resuming = false;
+    
+    if (std::exception_ptr exception = s_task->exception()) {
+        try {
+            std::rethrow_exception(exception);
+        } catch (const std::exception& e) {
+            cmdLinePrint(std::format("{} failed: {}", s_name, e.what()));
+        } catch (...) {
+            cmdLinePrint(s_name + " failed");
+        }
+        finish();
+    } else if (s_task->done()) {
+        LOG_INFO("Interactive tool finished: {}", s_name);
+        finish();
+    }
+}
+
+// 等待一个点
+ToolInputAwaiter ToolScheduler::getPoint(std::string prompt, std::optional<glm::vec2> base, std::vector<std::string> keywords) {
+    return {ToolRequest{ToolInputKind::Point, std::move(prompt), base, std::move(keywords)}};
+}
+
+// 等待一个距离
+ToolInputAwaiter ToolScheduler::getDistance(std::string prompt, const glm::vec2& base, std::vector<std::string> keywords) {
+    return {ToolRequest{ToolInputKind::Distance, std::move(prompt), base, std::move(keywords)}};
+}
+
+// 登记工具等待的输入
+void ToolScheduler::beginWait(ToolRequest request) {
+    s_request = std::move(request);
+    s_input = {};
+    s_waiting = true;
+}
+
+// 取回收到的输入
+ToolInput ToolScheduler::takeInput() {
+    return std::exchange(s_input, {});
+}
+
+// 登记收到的输入
+void ToolScheduler::deliver(ToolInput input) {
+    s_input = std::move(input);
+    s_waiting = false;
+    s_resumePending = true;
+}
+
+// 解析命令栏输入
+bool ToolScheduler::parseInput(std::string_view text, ToolInput& out) {
+    TokenBuffer tokens;
+    if (CommandTokenizer::tokenize(text, tokens) != ParseError::None) {
+        return false;
+    }
+    
+    // 空输入
+    if (tokens.empty()) {
+        out.kind = ToolInputKind::None;
+        return true;
+    }
+    
+    // 关键字：完全匹配优先，否则接受唯一的前缀
+    if (tokens.size() == 1 && !s_request.keywords.empty()) {
+        std::string word = CommandRegistry::normalize(tokens[0]);
+        const std::string* match = nullptr;
+        std::size_t prefixMatches = 0;
+        for (const auto& keyword : s_request.keywords) {
+            if (keyword == word) {
+                match = &keyword;
+                prefixMatches = 1;
+                break;
+            }
+            if (keyword.starts_with(word)) {
+                match = &keyword;
+                ++prefixMatches;
+            }
+        }
+        if (match && prefixMatches == 1) {
+            out.kind = ToolInputKind::Keyword;
+            out.keyword = *match;
+            return true;
+        }
+    }
+    
+    // 点：X,Y、@DX,DY或两个数值
+    glm::vec2 base = s_request.base.value_or(s_document ? s_document->getLastPoint() : glm::vec2(0.0f));
+    glm::vec2 point(0.0f);
+    if (tokens.size() == 1 && CommandTokenizer::isPointToken(tokens[0])) {
+        PointToken token;
+        if (CommandTokenizer::parsePoint(tokens[0], token) != ParseError::None) {
+            return false;
+        }
+        point = token.relative ? base + token.value : token.value;
+    } else if (tokens.size() == 2) {
+        if (CommandTokenizer::parseNumber(tokens[0], point.x) != ParseError::None ||
+            CommandTokenizer::parseNumber(tokens[1], point.y) != ParseError::None) {
+            return false;
+        }
+    } else if (tokens.size() == 1 && s_request.kind == ToolInputKind::Distance) {
+        // 等待距离时可以直接输入数值
+        float distance = 0.0f;
+        if (CommandTokenizer::parseNumber(tokens[0], distance) != ParseError::None) {
+            return false;
+        }
+        out.kind = ToolInputKind::Distance;
+        out.distance = distance;
+        return true;
+    } else {
+        return false;
+    }
+    
+    if (s_request.kind == ToolInputKind::Distance) {
+        out.kind = ToolInputKind::Distance;
+        out.distance = std::hypot(point.x - base.x, point.y - base.y);
+    } else {
+        out.kind = ToolInputKind::Point;
+        out.point = point;
+    }
+    return true;
+}
+
+// 结束工具并销毁协程帧
+void ToolScheduler::finish() {
+    s_task.reset();
+    s_name.clear();
+    s_document.reset();
+    s_request = {};
+    s_input = {};
+    s_waiting = false;
+    s_resumePending = false;
+}
+
+} // namespace tch
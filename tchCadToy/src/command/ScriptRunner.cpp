@@ -0,0 +1,182 @@
+#include "command/ScriptRunner.h"
+#include "command/CommandParser.h"
+#include "command/CommandRegistry.h"
+#include "render/Renderer.h"
+#include "file/FileManager.h"
+#include "file/Document.h"
+#include "utils/GlobalUtils.h"
+#include "debug/Logger.h"
+#include "MappedFile.h"
+#include <chrono>
+#include <format>
+
+namespace tch {
+
+// 静态成员初始化
+thread_local ScriptResult* ScriptRunner::s_activeResult = nullptr;
+
+namespace {
+
+// 是否为行内空白字符
+constexpr bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// 去除首尾空白
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && isBlank(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isBlank(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// 是否为撤销或重做命令（含别名）
+bool isUndoRedoCommand(std::string_view line) {
+    std::size_t end = 0;
+    while (end < line.size() && !isBlank(line[end])) {
+        ++end;
+    }
+    const CommandDesc* desc = CommandParser::findCommand(line.substr(0, end));
+    return desc && (desc->name == "UNDO" || desc->name == "REDO");
+}
+
+} // namespace
+
+// 每秒执行的命令数
+double ScriptResult::commandsPerSecond() const {
+    return seconds > 0.0 ? static_cast<double>(commands) / seconds : 0.0;
+}
+
+// 一行摘要
+std::string ScriptResult::summary() const {
+    return std::format("Script: {} commands ({} failed) in {:.3f} s, {:.0f} commands/s",
+                       commands, failedCommands, seconds, commandsPerSecond());
+}
+
+// 执行脚本文件
+bool ScriptRunner::runFile(const std::string& scriptPath, ScriptResult& result) {
+    // 以只读映射方式读取，命令直接引用映射内容，不复制整个文件
+    MappedFile script;
+    if (!script.open(scriptPath)) {
+        LOG_ERROR("Failed to open script: {}", scriptPath);
+        return false;
+    }
+    
+    LOG_INFO("Running script: {} ({} bytes)", scriptPath, script.size());
+    return runScript(script.view(), result);
+}
+
+// 执行脚本文本
+bool ScriptRunner::runScript(std::string_view script, ScriptResult& result) {
+    // 接管命令输出，执行期间不写入命令历史
+    ScriptResult* previousResult = s_activeResult;
+    s_activeResult = &result;
+    CmdLineSink previousSink = setCmdLineSink(collectOutput);
+    
+    // 整个脚本作为当前文档的一个事务：只产生一个撤销步骤（遇到UNDO/REDO时分段），空间索引与修改标记在结束时更新一次
+    auto document = FileManager::getCurrentDocumentPtr();
+    if (document) {
+        auto lock = document->lockExclusive();
+        document->beginTransaction("Script");
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    bool modified = false;
+    std::size_t lineNumber = 0;
+    while (!script.empty()) {
+        std::size_t end = script.find('\n');
+        std::string_view line = trim(script.substr(0, end));
+        script.remove_prefix(end == std::string_view::npos ? script.size() : end + 1);
+        ++lineNumber;
+        
+        // 跳过空行与注释
+        if (line.empty() || line.front() == ';' || line.front() == '#') {
+            continue;
+        }
+        
+        // 撤销与重做在事务进行中不可用：只有脚本自动开启的事务时先提交（此前的操作成为一个撤销步骤），执行后重新开启；
+        // 脚本中BEGIN开启的事务仍需先END
+        bool suspendTransaction = document && document->getUndoRedoManager().getTransactionDepth() == 1 &&
+                                  FileManager::getCurrentDocumentPtr() == document && isUndoRedoCommand(line);
+        if (suspendTransaction) {
+            auto lock = document->lockExclusive();
+            modified = document->commitTransaction() || modified;
+        }
+        
+        std::size_t outputBefore = result.totalOutput;
+        ++result.commands;
+        bool succeeded = CommandParser::parseCommand(line);
+        if (suspendTransaction) {
+            auto lock = document->lockExclusive();
+            document->beginTransaction("Script");
+        }
+        if (!succeeded) {
+            ++result.failedCommands;
+            if (result.failures.size() < kMaxReportedFailures) {
+                ScriptResult::Failure failure;
+                failure.line = lineNumber;
+                failure.command = std::string(line);
+                if (result.totalOutput > outputBefore && !result.output.empty()) {
+                    failure.message = result.output.back();
+                }
+                result.failures.push_back(std::move(failure));
+            }
+        }
+    }
+    
+    if (document) {
+        // 脚本中未配对的BEGIN一并提交
+        {
+            auto lock = document->lockExclusive();
+            while (document->isInTransaction()) {
+                modified = document->commitTransaction() || modified;
+            }
+        }
+        
+        // 脚本可能已关闭该文档
+        std::size_t index = FileManager::findDocument(*document);
+        if (modified && index < FileManager::getFileCount()) {
+            FileManager::markFileModified(index, document->isModifiedSinceSave());
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    setCmdLineSink(previousSink);
+    s_activeResult = previousResult;
+    
+    LOG_INFO("{}", result.summary());
+    return result.failedCommands == 0;
+}
+
+// 把执行结果写入当前文件的命令历史
+void ScriptRunner::publishToCommandHistory(const ScriptResult& result) {
+    if (result.totalOutput > result.output.size()) {
+        Renderer::addContentToCommandHistory(std::format("... {} earlier messages omitted", result.totalOutput - result.output.size()));
+    }
+    for (const auto& message : result.output) {
+        Renderer::addContentToCommandHistory(message);
+    }
+    for (const auto& failure : result.failures) {
+        Renderer::addContentToCommandHistory(std::format("Line {}: {} -> {}", failure.line, failure.command, failure.message));
+    }
+    Renderer::addContentToCommandHistory(result.summary());
+}
+
+// 收集命令输出
+void ScriptRunner::collectOutput(const std::string& message) {
+    if (!s_activeResult) {
+        return;
+    }
+    
+    ScriptResult& result = *s_activeResult;
+    ++result.totalOutput;
+    if (result.output.size() >= kMaxDeferredOutput) {
+        result.output.pop_front();
+    }
+    result.output.push_back(message);
+}
+
+} // namespace tch
@@ -1,10 +1,16 @@
 #include "debug/Logger.h"
 #include <algorithm>
-#include <iomanip>
 #include <sstream>
 
 namespace tch {
 
+namespace {
+
+// format of the binary log records of messages that were formatted by the caller, the message is the argument
+constexpr const char* kBinaryLogPlainFormat = "{}";
+
+} // namespace
+
 Logger::Logger(std::ostream& os, const LogConfig& config)
     : m_config(config)
     , m_bBlockTrace(false)
@@ -15,9 +21,10 @@ Logger::Logger(std::ostream& os, const LogConfig& config)
     , m_bBlockFatal(false)
 {
     addOutputStream(os);
+    updateEnabledLevels();
     
     if (m_config.asyncLogging) {
-        m_logThread = std::make_unique<std::thread>(&Logger::logThreadFunc, this);
+        startLogThread();
     }
 }
 
@@ -35,23 +42,21 @@ Logger::Logger(const std::string& logFile, const LogConfig& config)
     
     m_logFileStream = std::make_unique<std::ofstream>(logFile, std::ios::out | std::ios::app);
     if (m_logFileStream->is_open()) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(logFile, ec);
+        m_logFileSize = ec ? 0 : static_cast<size_t>(size);
         addOutputStream(*m_logFileStream);
     }
+    updateEnabledLevels();
     
     if (m_config.asyncLogging) {
-        m_logThread = std::make_unique<std::thread>(&Logger::logThreadFunc, this);
+        startLogThread();
     }
 }
 
 Logger::~Logger()
 {
-    if (m_config.asyncLogging && m_logThread) {
-        m_running = false;
-        m_logCondition.notify_one();
-        if (m_logThread->joinable()) {
-            m_logThread->join();
-        }
-    }
+    stopLogThread();
     
     if (this == s_pGlobalLogger) {
         s_pGlobalLogger = nullptr;
@@ -62,6 +67,7 @@ Logger::~Logger()
 void Logger::setLowestOutputLevel(LogLevel level)
 {
     m_config.lowestLevel = level;
+    updateEnabledLevels();
 }
 
 void Logger::setColoredOutput(bool enabled)
@@ -77,32 +83,20 @@ void Logger::setAsyncLogging(bool enabled)
     
     if (enabled) {
         // Enable async logging
+        startLogThread();
         m_config.asyncLogging = true;
-        m_logThread = std::make_unique<std::thread>(&Logger::logThreadFunc, this);
     } else {
-        // Disable async logging
+        // Disable async logging, the remaining messages are written before returning
         m_config.asyncLogging = false;
-        if (m_logThread) {
-            m_running = false;
-            m_logCondition.notify_one();
-            if (m_logThread->joinable()) {
-                m_logThread->join();
-            }
-            m_logThread.reset();
-        }
-        // Process any remaining logs
-        std::queue<LogMessage> tempQueue;
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            tempQueue.swap(m_logQueue);
-        }
-        while (!tempQueue.empty()) {
-            processLogMessage(tempQueue.front());
-            tempQueue.pop();
-        }
+        stopLogThread();
     }
 }
 
+void Logger::setOverflowPolicy(OverflowPolicy policy)
+{
+    m_config.overflowPolicy = policy;
+}
+
 void Logger::setLogFileSizeLimit(size_t size)
 {
     m_config.maxLogFileSize = size;
@@ -144,6 +138,7 @@ void Logger::blockLevel(LogLevel level)
     default:
         break;
     }
+    updateEnabledLevels();
 }
 
 void Logger::unblockLevel(LogLevel level)
@@ -171,6 +166,19 @@ void Logger::unblockLevel(LogLevel level)
     default:
         break;
     }
+    updateEnabledLevels();
+}
+
+void Logger::updateEnabledLevels()
+{
+    const bool blocked[] = { m_bBlockTrace, m_bBlockDebug, m_bBlockInfo, m_bBlockWarning, m_bBlockError, m_bBlockFatal };
+    uint32_t levels = 0;
+    for (int level = Trace; level <= Fatal; ++level) {
+        if (!blocked[level] && m_config.lowestLevel <= level) {
+            levels |= 1u << level;
+        }
+    }
+    m_enabledLevels.store(levels, std::memory_order_relaxed);
 }
 
 // Output stream management
@@ -192,22 +200,35 @@ void Logger::removeOutputStream(std::ostream& os)
     }
 }
 
-// strip file path in file name, only keep file name itself
-std::string Logger::stripFilePath(const char* file)
+size_t Logger::getDroppedMessageCount() const
 {
-    std::string str(file);
-    for (auto rit = str.rbegin(); rit != str.rend(); rit++)
-    {
-        if (*rit == '/' || *rit == '\\')
-        {
-            return std::string(rit.base(), str.end());
-        }
+    return m_droppedMessages.load(std::memory_order_relaxed);
+}
+
+// Binary log
+bool Logger::openBinaryLogFile(const std::string& path)
+{
+    auto stream = std::make_unique<std::ofstream>(path, std::ios::out | std::ios::binary | std::ios::app);
+    if (!stream->is_open()) {
+        return false;
     }
-    return str;
+    
+    // every opening starts a new session with its own format and call site tables
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binaryLogStream = std::move(stream);
+    m_binaryLog.reset();
+    return true;
+}
+
+void Logger::closeBinaryLogFile()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binaryLogStream.reset();
+    m_binaryLog.clearData();
 }
 
 // get level string with color
-std::string Logger::getLevelString(LogLevel level)
+const char* Logger::getLevelString(LogLevel level) const
 {
     if (!m_config.coloredOutput) {
         return "";
@@ -240,7 +261,7 @@ std::string Logger::getLevelString(LogLevel level)
 }
 
 // reset color
-std::string Logger::resetColor()
+const char* Logger::resetColor() const
 {
     if (!m_config.coloredOutput) {
         return "";
@@ -253,18 +274,6 @@ std::string Logger::resetColor()
     #endif
 }
 
-// get timestamp
-std::string Logger::getTimestamp()
-{
-    auto now = std::chrono::system_clock::now();
-    auto now_c = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&now_c), "%Y-%m-%d %H:%M:%S.") << std::setw(3) << std::setfill('0') << ms.count();
-    return ss.str();
-}
-
 // Log file management
 void Logger::checkLogFileSize()
 {
@@ -272,10 +281,7 @@ void Logger::checkLogFileSize()
         return;
     }
     
-    m_logFileStream->seekp(0, std::ios::end);
-    size_t size = m_logFileStream->tellp();
-    
-    if (size >= m_config.maxLogFileSize) {
+    if (m_logFileSize >= m_config.maxLogFileSize) {
         rotateLogFiles();
     }
 }
@@ -286,6 +292,14 @@ void Logger::rotateLogFiles()
         return;
     }
     
+    // Remove the old stream before it is destroyed, the caller already holds m_mutex
+    auto it = std::find_if(m_outputStreams.begin(), m_outputStreams.end(),
+        [this](const std::reference_wrapper<std::ostream>& ref) {
+            return &ref.get() == m_logFileStream.get();
+        });
+    if (it != m_outputStreams.end()) {
+        m_outputStreams.erase(it);
+    }
     m_logFileStream->close();
     
     // Rotate log files
@@ -317,39 +331,109 @@ void Logger::rotateLogFiles()
     
     // Create new log file
     m_logFileStream = std::make_unique<std::ofstream>(m_logFilePath, std::ios::out | std::ios::trunc);
+    m_logFileSize = 0;
     if (m_logFileStream->is_open()) {
-        // Remove old stream and add new one
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto it = std::find_if(m_outputStreams.begin(), m_outputStreams.end(),
-            [this](const std::reference_wrapper<std::ostream>& ref) {
-                return &ref.get() == m_logFileStream.get();
-            });
-        if (it != m_outputStreams.end()) {
-            m_outputStreams.erase(it);
-        }
         m_outputStreams.emplace_back(*m_logFileStream);
     }
 }
 
+// Log thread management
+void Logger::startLogThread()
+{
+    if (m_logThread) {
+        return;
+    }
+    if (!m_logQueue) {
+        m_logQueue = std::make_unique<LogQueue>();
+    }
+    m_running = true;
+    m_logThread = std::make_unique<std::thread>(&Logger::logThreadFunc, this);
+}
+
+void Logger::stopLogThread()
+{
+    if (!m_logThread) {
+        return;
+    }
+    m_running = false;
+    wakeLogThread();
+    if (m_logThread->joinable()) {
+        m_logThread->join();
+    }
+    m_logThread.reset();
+    
+    // Write what was pushed after the log thread's last drain
+    while (drainLogQueue() > 0) {
+    }
+}
+
+void Logger::wakeLogThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeRequested = true;
+    }
+    m_wakeCondition.notify_one();
+}
+
 // Log thread function
 void Logger::logThreadFunc()
 {
-    while (m_running) {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_logCondition.wait(lock, [this] { return !m_logQueue.empty() || !m_running; });
-        
-        if (!m_running && m_logQueue.empty()) {
+    while (true) {
+        if (drainLogQueue() > 0) {
+            continue;
+        }
+        if (!m_running) {
             break;
         }
         
-        if (!m_logQueue.empty()) {
-            LogMessage msg = m_logQueue.front();
-            m_logQueue.pop();
-            lock.unlock();
-            
-            processLogMessage(msg);
+        // producers do not wake the log thread for every message, a syscall per message would cost more than the message
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.wait_for(lock, kLogDrainInterval, [this] { return m_wakeRequested || !m_running; });
+        m_wakeRequested = false;
+    }
+}
+
+Logger::QueueFullAction Logger::onLogQueueFull()
+{
+    if (m_config.overflowPolicy != OverflowPolicy::Block) {
+        m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+        if (m_config.overflowPolicy == OverflowPolicy::Count) {
+            m_pendingDropped.fetch_add(1, std::memory_order_relaxed);
         }
+        return QueueFullAction::Discard;
+    }
+    
+    // the log thread is stopping, nobody will free a slot
+    if (!m_running) {
+        return QueueFullAction::WriteDirectly;
     }
+    wakeLogThread();
+    std::this_thread::yield();
+    return QueueFullAction::Retry;
+}
+
+size_t Logger::drainLogQueue()
+{
+    // producers never take m_mutex, holding it for the batch only delays synchronous writers
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    size_t count = m_logQueue ? m_logQueue->drain([this](LogMessage& msg) {
+        appendLogMessage(msg);
+    }, kLogDrainBatch) : 0;
+    
+    size_t dropped = m_pendingDropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        LogMessage msg;
+        msg.level = Warning;
+        msg.message = std::format("{} log messages dropped, the log queue was full", dropped);
+        msg.site = std::source_location::current();
+        msg.timestamp = std::chrono::system_clock::now();
+        appendLogMessage(msg);
+    }
+    
+    writeLogBuffers();
+    return count;
 }
 
 // Log functions implementation
@@ -378,53 +462,25 @@ void Logger::fatal(const std::string& str, const std::source_location& loc) {
 }
 
 // Log implementation
-void Logger::log(LogLevel level, const std::string& str, const std::source_location& loc)
+void Logger::log(LogLevel level, const std::string& str, const LogSite& site)
 {
-    bool shouldLog = false;
-    switch (level) {
-    case Trace:
-        shouldLog = !m_bBlockTrace && m_config.lowestLevel <= Trace;
-        break;
-    case Debug:
-        shouldLog = !m_bBlockDebug && m_config.lowestLevel <= Debug;
-        break;
-    case Info:
-        shouldLog = !m_bBlockInfo && m_config.lowestLevel <= Info;
-        break;
-    case Warning:
-        shouldLog = !m_bBlockWarning && m_config.lowestLevel <= Warning;
-        break;
-    case Error:
-        shouldLog = !m_bBlockError && m_config.lowestLevel <= Error;
-        break;
-    case Fatal:
-        shouldLog = !m_bBlockFatal && m_config.lowestLevel <= Fatal;
-        break;
-    default:
-        return;
-    }
-    
-    if (!shouldLog) {
+    if (!isLevelEnabled(level)) {
         return;
     }
     
     if (m_config.asyncLogging) {
-        LogMessage msg;
-        msg.level = level;
-        msg.message = str;
-        msg.location = loc;
-        msg.timestamp = std::chrono::system_clock::now();
-        
-        { 
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_logQueue.push(msg);
-        }
-        m_logCondition.notify_one();
+        enqueueLogMessage(level >= Error, [&](LogMessage& msg) {
+            msg.level = level;
+            msg.message = str;
+            msg.formatArgs = nullptr;
+            msg.site = site;
+            msg.timestamp = std::chrono::system_clock::now();
+        });
     } else {
         LogMessage msg;
         msg.level = level;
         msg.message = str;
-        msg.location = loc;
+        msg.site = site;
         msg.timestamp = std::chrono::system_clock::now();
         processLogMessage(msg);
     }
@@ -434,47 +490,100 @@ void Logger::log(LogLevel level, const std::string& str, const std::source_locat
 void Logger::processLogMessage(const LogMessage& msg)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
+    appendLogMessage(msg);
+    writeLogBuffers();
+}
+
+void Logger::appendLogMessage(const LogMessage& msg)
+{
+    // text lines are only assembled when a text stream wants them
+    if (!m_outputStreams.empty()) {
+        appendLogLine(m_lineBuffer, msg);
+    }
+    if (m_binaryLogStream) {
+        appendBinaryLogRecord(msg);
+    }
+}
+
+// append one line: "[ Level    ][ timestamp ] [ file : line : function ]: message"
+void Logger::appendLogLine(std::string& out, const LogMessage& msg)
+{
+    LogLinePrefix prefix;
+    prefix.level = msg.level;
+    prefix.levelColor = getLevelString(msg.level);
+    prefix.resetColor = resetColor();
+    prefix.time = msg.timestamp;
+    prefix.file = msg.site.fileName;
+    prefix.line = msg.site.location.line();
+    prefix.function = msg.site.location.function_name();
+    m_lineFormatter.appendPrefix(out, prefix);
     
-    std::string levelStr = getLevelString(msg.level);
-    std::string reset = resetColor();
-    std::string timestamp = getTimestamp();
+    // deferred messages are formatted here, on the log thread
+    if (msg.formatArgs) {
+        size_t start = out.size();
+        try {
+            msg.formatArgs(out, msg.format, msg.args.data());
+        } catch (const std::exception& e) {
+            out.resize(start);
+            out += std::format("<format error: {}> {}", e.what(), msg.format);
+        }
+    } else {
+        out += msg.message;
+    }
+    out += '\n';
+}
+
+// append one record to the binary log, deferred messages keep their format string and raw arguments
+void Logger::appendBinaryLogRecord(const LogMessage& msg)
+{
+    BinaryLogWriter::Site site;
+    site.file = msg.site.fileName;
+    site.line = msg.site.location.line();
+    site.function = msg.site.location.function_name();
+    int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(msg.timestamp.time_since_epoch()).count();
     
-    std::string logStr = std::format("{}[ {: <8} ]{}[ {} ] [ {: >20} : {: >4} : {: <30} ]: {}\n", 
-        levelStr, 
-        msg.level == Trace ? "Trace" : 
-        msg.level == Debug ? "Debug" : 
-        msg.level == Info ? "Info" : 
-        msg.level == Warning ? "Warning" : 
-        msg.level == Error ? "Error" : "Fatal", 
-        reset,
-        timestamp,
-        stripFilePath(msg.location.file_name()), 
-        msg.location.line(), 
-        msg.location.function_name(), 
-        msg.message);
+    if (msg.formatArgs) {
+        m_binaryLog.beginMessage(msg.level, micros, site, msg.format);
+        msg.packArgs(m_binaryLog, msg.args.data());
+    } else {
+        m_binaryLog.beginMessage(msg.level, micros, site, kBinaryLogPlainFormat);
+        m_binaryLog.appendArg(std::string_view(msg.message));
+    }
+    m_binaryLog.endMessage();
+}
+
+void Logger::writeLogBuffers()
+{
+    if (!m_lineBuffer.empty()) {
+        writeLogString(m_lineBuffer);
+        m_lineBuffer.clear();
+    }
     
+    if (m_binaryLogStream && !m_binaryLog.data().empty()) {
+        const std::string& data = m_binaryLog.data();
+        m_binaryLogStream->write(data.data(), static_cast<std::streamsize>(data.size()));
+        m_binaryLogStream->flush();
+        m_binaryLog.clearData();
+    }
+}
+
+// write one or more formatted lines to every output stream, flushing once
+void Logger::writeLogString(const std::string& str)
+{
     for (auto& os : m_outputStreams) {
-        os.get() << logStr;
+        os.get().write(str.data(), static_cast<std::streamsize>(str.size()));
         os.get().flush();
     }
     
-    // Check log file size for rotation
+    // the file size is counted rather than asked from the stream, which would seek on every write
     if (m_logFileStream && m_logFileStream->is_open()) {
+        m_logFileSize += str.size();
         checkLogFileSize();
     }
 }
 
 // Global logger functions
 
-Logger& globalLogger()
-{
-    if (s_pGlobalLogger)
-    {
-        return *s_pGlobalLogger;
-    }
-    return defaultLogger();
-}
-
 Logger& defaultLogger()
 {
     static Logger coutLogger(std::cout);
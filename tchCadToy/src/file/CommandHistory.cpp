@@ -0,0 +1,125 @@
+#include "file/CommandHistory.h"
+#include "debug/Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <system_error>
+
+namespace tch {
+
+namespace {
+
+// 下一个历史对象的标识，文件可能在自动化服务的工作线程中创建
+std::atomic<std::uint64_t> s_nextHistoryId{1};
+
+} // namespace
+
+CommandHistory::CommandHistory(std::size_t lineCapacity, std::size_t chunkCount)
+    : m_entries(std::max<std::size_t>(lineCapacity, 1))
+    , m_chunks(std::max<std::size_t>(chunkCount, 1))
+    , m_chunkLines(m_chunks.size(), 0)
+    , m_id(s_nextHistoryId.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+// 追加一行
+void CommandHistory::append(std::string_view line) {
+    append({line});
+}
+
+// 把几段文本拼接为一行追加
+void CommandHistory::append(std::initializer_list<std::string_view> parts) {
+    std::size_t length = 0;
+    for (std::string_view part : parts) {
+        length += part.size();
+    }
+    length = std::min(length, kChunkSize);
+    
+    char* dest = allocate(length);
+    std::size_t written = 0;
+    for (std::string_view part : parts) {
+        std::size_t count = std::min(part.size(), length - written);
+        if (count > 0) {
+            std::memcpy(dest + written, part.data(), count);
+            written += count;
+        }
+    }
+    commit(m_writeChunk * kChunkSize + m_writeOffset, length);
+}
+
+// 清空历史
+void CommandHistory::clear() {
+    m_firstSequence += m_size;
+    m_head = 0;
+    m_size = 0;
+    m_writeChunk = 0;
+    m_writeOffset = 0;
+    std::fill(m_chunkLines.begin(), m_chunkLines.end(), 0);
+}
+
+// 获取第index行
+std::string_view CommandHistory::operator[](std::size_t index) const {
+    const Entry& entry = m_entries[(m_head + index) % m_entries.size()];
+    return std::string_view(m_chunks[entry.offset / kChunkSize].get() + entry.offset % kChunkSize, entry.length);
+}
+
+// 设置溢出文件
+void CommandHistory::setSpillPath(std::filesystem::path path) {
+    m_spillStream.reset();
+    m_spillPath = std::move(path);
+}
+
+// 分配写入空间：块按顺序循环使用，进入下一块时其中保留的必然是最旧的行；
+// 当前块已写满时空行也进入下一块，保证行的偏移量落在所属的块内
+char* CommandHistory::allocate(std::size_t length) {
+    if (m_writeOffset + length > kChunkSize || m_writeOffset == kChunkSize) {
+        m_writeChunk = (m_writeChunk + 1) % m_chunks.size();
+        m_writeOffset = 0;
+        while (m_chunkLines[m_writeChunk] > 0) {
+            dropOldest();
+        }
+    }
+    if (!m_chunks[m_writeChunk]) {
+        m_chunks[m_writeChunk] = std::make_unique_for_overwrite<char[]>(kChunkSize);
+    }
+    return m_chunks[m_writeChunk].get() + m_writeOffset;
+}
+
+// 丢弃最旧的一行，设置了溢出文件时先写入文件
+void CommandHistory::dropOldest() {
+    if (!m_spillPath.empty() && !m_spillStream) {
+        std::error_code ec;
+        std::filesystem::create_directories(m_spillPath.parent_path(), ec);
+        m_spillStream = std::make_unique<std::ofstream>(m_spillPath, std::ios::out | std::ios::app | std::ios::binary);
+        if (!*m_spillStream) {
+            LOG_WARNING("Failed to open command history spill file: {}", m_spillPath.string());
+            m_spillStream.reset();
+            m_spillPath.clear();
+        }
+    }
+    
+    std::string_view line = (*this)[0];
+    if (m_spillStream) {
+        m_spillStream->write(line.data(), static_cast<std::streamsize>(line.size()));
+        m_spillStream->put('\n');
+    }
+    --m_chunkLines[m_entries[m_head].offset / kChunkSize];
+    m_head = (m_head + 1) % m_entries.size();
+    ++m_firstSequence;
+    --m_size;
+    ++m_droppedCount;
+}
+
+// 把新行加入行表，行表已满时丢弃最旧的一行
+void CommandHistory::commit(std::size_t offset, std::size_t length) {
+    if (m_size == m_entries.size()) {
+        dropOldest();
+    }
+    Entry& entry = m_entries[(m_head + m_size) % m_entries.size()];
+    entry.offset = static_cast<std::uint32_t>(offset);
+    entry.length = static_cast<std::uint32_t>(length);
+    ++m_chunkLines[offset / kChunkSize];
+    ++m_size;
+    m_writeOffset += length;
+}
+
+} // namespace tch
@@ -0,0 +1,124 @@
+#include "file/Document.h"
+
+namespace tch {
+
+// 构造函数
+Document::Document() : m_lastPoint(0.0f), m_savedHash(0), m_pendingTouch(false), m_revision(1) {
+    // 窗口大小未知，由渲染器在绘制时更新
+    m_viewport.initialize(0, 0);
+    
+    // 新文档视为未修改
+    m_savedHash = getContentHash();
+}
+
+// 获取图层管理器
+LayerManager& Document::getLayerManager() {
+    return m_layerManager;
+}
+
+const LayerManager& Document::getLayerManager() const {
+    return m_layerManager;
+}
+
+// 获取撤销/重做管理器
+UndoRedoManager& Document::getUndoRedoManager() {
+    return m_undoRedoManager;
+}
+
+// 获取逻辑视口
+LogicalViewport& Document::getViewport() {
+    return m_viewport;
+}
+
+// 获取选择集
+SelectionSet& Document::getSelection() {
+    return m_selection;
+}
+
+// 获取上一个输入的点
+const glm::vec2& Document::getLastPoint() const {
+    return m_lastPoint;
+}
+
+// 设置上一个输入的点
+void Document::setLastPoint(const glm::vec2& point) {
+    m_lastPoint = point;
+}
+
+// 获取空间索引，由图层管理器随图形增删增量维护，批量修改后首次访问时重建
+const SpatialIndex& Document::getSpatialIndex() const {
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    return m_layerManager.getSpatialIndex();
+}
+
+// 内容变更后调用，递增修订号
+void Document::touch() {
+    if (m_undoRedoManager.isInTransaction()) {
+        m_pendingTouch = true;
+        return;
+    }
+    m_revision.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// 开始事务
+void Document::beginTransaction(const std::string& name) {
+    m_undoRedoManager.beginTransaction(name);
+}
+
+// 提交事务
+bool Document::commitTransaction() {
+    if (!m_undoRedoManager.commitTransaction() || !m_pendingTouch) {
+        return false;
+    }
+    m_pendingTouch = false;
+    m_revision.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+// 是否有进行中的事务
+bool Document::isInTransaction() const {
+    return m_undoRedoManager.isInTransaction();
+}
+
+// 获取修订号
+std::uint64_t Document::getRevision() const {
+    return m_revision.load(std::memory_order_acquire);
+}
+
+// 获取内容哈希
+std::uint64_t Document::getContentHash() const {
+    std::lock_guard<std::mutex> lock(m_hashMutex);
+    return m_layerManager.getHash();
+}
+
+// 记录当前内容为已保存状态
+void Document::markSaved() {
+    m_savedHash = getContentHash();
+}
+
+// 内容是否与上次保存时不同
+bool Document::isModifiedSinceSave() const {
+    return getContentHash() != m_savedHash;
+}
+
+// 保存到文件
+bool Document::saveToFile(const std::string& filePath) {
+    std::lock_guard<std::mutex> lock(m_hashMutex);
+    if (!SaveLoad::saveToFile(m_layerManager, filePath, &m_saveCache)) {
+        return false;
+    }
+    m_savedHash = m_layerManager.getHash();
+    return true;
+}
+
+// 获取读锁
+std::shared_lock<std::shared_mutex> Document::lockShared() const {
+    return std::shared_lock<std::shared_mutex>(m_mutex);
+}
+
+// 获取写锁
+std::unique_lock<std::shared_mutex> Document::lockExclusive() {
+    return std::unique_lock<std::shared_mutex>(m_mutex);
+}
+
+} // namespace tch
@@ -4,11 +4,13 @@
 namespace tch {
 
 // 构造函数
-File::File() : m_fileExtension(".cad.json"), m_modified(false), m_saved(false) {
+File::File() : m_fileExtension(".cad.json"), m_modified(false), m_saved(false),
+    m_document(std::make_shared<Document>()) {
 }
 
 File::File(const std::string& name, const std::string& path) 
-    : m_fileExtension(".cad.json"), m_modified(false), m_saved(false) {
+    : m_fileExtension(".cad.json"), m_modified(false), m_saved(false),
+      m_document(std::make_shared<Document>()) {
     // 解析文件名和路径
     std::filesystem::path filePath(path);
     if (!path.empty()) {
@@ -65,16 +67,50 @@ void File::setFullPath(const std::string& path) {
 }
 
 // 获取文件内容
-const std::string& File::getContent() const {
+std::string_view File::getContent() const {
+    if (m_mappedContent.isOpen()) {
+        return m_mappedContent.view();
+    }
     return m_content;
 }
 
 // 设置文件内容
-void File::setContent(const std::string& content) {
-    this->m_content = content;
+void File::setContent(std::string content) {
+    m_mappedContent.close();
+    m_content = std::move(content);
     m_modified = true;
 }
 
+// 以只读映射方式加载文件原始内容
+bool File::mapContent(const std::string& path) {
+    if (!m_mappedContent.open(path)) {
+        return false;
+    }
+    std::string().swap(m_content);
+    return true;
+}
+
+// 文件内容是否仍为磁盘上的原始映射
+bool File::isContentMapped() const {
+    return m_mappedContent.isOpen();
+}
+
+// 释放文件内容
+void File::releaseContent() {
+    m_mappedContent.close();
+    std::string().swap(m_content);
+}
+
+// 获取文档模型
+Document& File::getDocument() const {
+    return *m_document;
+}
+
+// 获取文档模型的共享指针
+std::shared_ptr<Document> File::getDocumentPtr() const {
+    return m_document;
+}
+
 // 检查文件是否被修改
 bool File::isModified() const {
     return m_modified;
@@ -102,13 +138,12 @@ void File::markSaved(bool isSaved) {
 }
 
 // 获取命令历史
-const std::vector<std::string>& File::getCommandHistory() const {
+const CommandHistory& File::getCommandHistory() const {
     return m_commandHistory;
 }
 
-// 添加命令到历史
-void File::addToCommandHistory(const std::string& command) {
-    m_commandHistory.push_back(command);
+CommandHistory& File::getCommandHistory() {
+    return m_commandHistory;
 }
 
 // 清除命令历史
@@ -4,11 +4,26 @@
 #include "imgui.h"
 #include "utils/LocalizationManager.h"
 #include "debug/Logger.h"
+#include "sys/Global.h"
+#include "SaveLoad.h"
 #include <fstream>
 #include <algorithm>
+#include <utility>
 
 namespace tch {
 
+namespace {
+
+// 当前线程绑定的文档，为空时使用当前文件的文档
+thread_local std::shared_ptr<Document> t_threadDocument;
+
+// 命令历史丢弃的旧行写入程序目录下history中与文件同名的日志
+void setupCommandHistorySpill(File& file) {
+    file.getCommandHistory().setSpillPath(g_pathCwd / "history" / (file.getFullFileName() + ".log"));
+}
+
+} // namespace
+
 // 静态成员初始化
 std::vector<File> FileManager::s_files;
 std::size_t FileManager::s_currentFileIndex = 0;
@@ -30,8 +45,8 @@ std::size_t FileManager::createNewFile() {
     std::string fileName = "unnamed-" + std::to_string(s_fileCounter);
     s_fileCounter++;
     
-    File newFile(fileName, "");
-    s_files.push_back(newFile);
+    s_files.emplace_back(fileName, "");
+    setupCommandHistorySpill(s_files.back());
     
     return s_files.size() - 1;
 }
@@ -39,21 +54,23 @@ std::size_t FileManager::createNewFile() {
 // 打开文件，返回文件索引
 std::size_t FileManager::openFile(const std::string& filePath) {
     try {
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
+        // 以只读映射方式加载并直接解析到文档，解析后即释放原始文本
+        File newFile("", filePath);
+        if (!newFile.mapContent(filePath)) {
             LOG_ERROR("Failed to open file: {}", filePath);
             return -1;
         }
-        
-        std::string content((std::istreambuf_iterator<char>(file)),
-                           std::istreambuf_iterator<char>());
-        file.close();
-        
-        File newFile("", filePath);
-        newFile.setContent(content);
+        std::string_view content = newFile.getContent();
+        if (!content.empty() && !SaveLoad::loadFromString(newFile.getDocument().getLayerManager(), content)) {
+            LOG_ERROR("Failed to parse file: {}", filePath);
+            return -1;
+        }
+        newFile.releaseContent();
+        newFile.getDocument().markSaved();
         newFile.markSaved(true);
+        setupCommandHistorySpill(newFile);
         
-        s_files.push_back(newFile);
+        s_files.push_back(std::move(newFile));
         s_currentFileIndex = s_files.size() - 1;
         
         // 添加到最近文件
@@ -79,15 +96,15 @@ bool FileManager::saveFile(std::size_t index) {
     }
     
     try {
-        std::ofstream outFile(file.getFullPath());
-        if (!outFile.is_open()) {
+        // 内容哈希与上次保存时一致（包括编辑后又撤销回原状态），无需重写
+        Document& document = file.getDocument();
+        if (!document.isModifiedSinceSave()) {
+            LOG_DEBUG("File unchanged, skip writing: {}", file.getFullPath());
+        } else if (!document.saveToFile(file.getFullPath())) {
             LOG_ERROR("Failed to save file: {}", file.getFullPath());
             return false;
         }
         
-        outFile << file.getContent();
-        outFile.close();
-        
         file.markSaved(true);
         
         // 添加到最近文件
@@ -107,18 +124,18 @@ bool FileManager::saveFileAs(std::size_t index, const std::string& filePath) {
     }
     
     try {
-        std::ofstream outFile(filePath);
-        if (!outFile.is_open()) {
+        File& file = s_files[index];
+        
+        // 序列化文档模型
+        if (!file.getDocument().saveToFile(filePath)) {
             LOG_ERROR("Failed to save file as: {}", filePath);
             return false;
         }
         
-        outFile << s_files[index].getContent();
-        outFile.close();
-        
         // 更新文件信息
-        s_files[index].setFullPath(filePath);
-        s_files[index].markSaved(true);
+        file.setFullPath(filePath);
+        file.markSaved(true);
+        setupCommandHistorySpill(file);
         
         // 添加到最近文件
         addToRecentFiles(filePath);
@@ -185,6 +202,50 @@ const File& FileManager::getFile(std::size_t index) {
     return emptyFile;
 }
 
+// 获取当前文件的文档
+Document& FileManager::getCurrentDocument() {
+    if (t_threadDocument) {
+        return *t_threadDocument;
+    }
+    return getCurrentFile().getDocument();
+}
+
+// 获取当前文档的共享指针
+std::shared_ptr<Document> FileManager::getCurrentDocumentPtr() {
+    if (t_threadDocument) {
+        return t_threadDocument;
+    }
+    return getDocumentPtr(s_currentFileIndex);
+}
+
+// 获取指定文件的文档
+std::shared_ptr<Document> FileManager::getDocumentPtr(std::size_t index) {
+    if (index < s_files.size()) {
+        return s_files[index].getDocumentPtr();
+    }
+    return nullptr;
+}
+
+// 查找文档所在的文件索引
+std::size_t FileManager::findDocument(const Document& document) {
+    for (std::size_t i = 0; i < s_files.size(); ++i) {
+        if (&s_files[i].getDocument() == &document) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 将文档绑定到当前线程
+std::shared_ptr<Document> FileManager::bindThreadDocument(std::shared_ptr<Document> document) {
+    return std::exchange(t_threadDocument, std::move(document));
+}
+
+// 当前线程是否绑定了文档
+bool FileManager::hasThreadDocument() {
+    return t_threadDocument != nullptr;
+}
+
 // 设置文件内容
 void FileManager::setFileContent(std::size_t index, const std::string& content) {
     if (index < s_files.size()) {
@@ -276,8 +337,8 @@ void FileManager::addToRecentFiles(const std::string& filePath) {
 }
 
 // 获取当前文件的命令历史
-const std::vector<std::string>& FileManager::getCurrentFileCommandHistory() {
-    static std::vector<std::string> emptyHistory;
+const CommandHistory& FileManager::getCurrentFileCommandHistory() {
+    static const CommandHistory emptyHistory(1, 1);
     if (s_currentFileIndex < s_files.size()) {
         return s_files[s_currentFileIndex].getCommandHistory();
     }
@@ -285,9 +346,16 @@ const std::vector<std::string>& FileManager::getCurrentFileCommandHistory() {
 }
 
 // 向当前文件添加命令历史
-void FileManager::addToCurrentFileCommandHistory(const std::string& command) {
+void FileManager::addToCurrentFileCommandHistory(std::string_view command) {
+    if (s_currentFileIndex < s_files.size()) {
+        s_files[s_currentFileIndex].getCommandHistory().append(command);
+    }
+}
+
+// 把几段文本拼接为一行添加到当前文件的命令历史
+void FileManager::addToCurrentFileCommandHistory(std::initializer_list<std::string_view> parts) {
     if (s_currentFileIndex < s_files.size()) {
-        s_files[s_currentFileIndex].addToCommandHistory(command);
+        s_files[s_currentFileIndex].getCommandHistory().append(parts);
     }
 }
 
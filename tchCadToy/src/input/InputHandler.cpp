@@ -1,12 +1,48 @@
 #include "input/InputHandler.h"
+#include "input/InputRecorder.h"
 #include "render/Renderer.h"
 #include "debug/Logger.h"
 #include "command/CommandParser.h"
+#include "command/InteractiveTool.h"
+#include "sys/Global.h"
 #include "imgui.h"
 #include "imgui_internal.h"
+#include "imgui_impl_glfw.h"
 
 namespace tch {
 
+namespace {
+
+// 回放时把录制的事件交给ImGui，与实际输入时GLFW回调的顺序一致；ImGui再转交给InputHandler的回调时事件被忽略。
+// 窗口大小事件直接作用于实际窗口
+void forwardReplayEventToImGui(GLFWwindow* window, const RawInputEvent& event) {
+    switch (event.type) {
+        case RawInputType::Key:
+            ImGui_ImplGlfw_KeyCallback(window, event.code, event.scancode, event.action, event.mods);
+            break;
+        case RawInputType::Char:
+            ImGui_ImplGlfw_CharCallback(window, event.codepoint);
+            break;
+        case RawInputType::MouseButton:
+            ImGui_ImplGlfw_MouseButtonCallback(window, event.code, event.action, event.mods);
+            break;
+        case RawInputType::MouseMove:
+            ImGui_ImplGlfw_CursorPosCallback(window, event.x, event.y);
+            break;
+        case RawInputType::MouseScroll:
+            ImGui_ImplGlfw_ScrollCallback(window, event.x, event.y);
+            break;
+        case RawInputType::WindowSize:
+            // 按录制时的大小调整实际窗口，帧缓冲与ImGui（每帧自行读取窗口大小）随之一致；产生的实际事件在回放期间被忽略
+            if (event.x > 0 && event.y > 0) {
+                glfwSetWindowSize(window, static_cast<int>(event.x), static_cast<int>(event.y));
+            }
+            break;
+    }
+}
+
+} // namespace
+
 // 静态成员初始化
 GLFWwindow* InputHandler::s_window = nullptr;
 glm::vec2 InputHandler::s_mousePosition(0.0f, 0.0f);
@@ -18,76 +54,92 @@ bool InputHandler::s_keys[GLFW_KEY_LAST + 1] = {false};
 // 全局标志：标记当前按键是否已被快捷键逻辑消耗
 bool InputHandler::s_keyWasConsumedByShortcut = false;
 std::unordered_map<InputEventType, std::function<void()>> InputHandler::s_callbacks;
-std::vector<ShortcutItem> InputHandler::s_shortcuts;
+Keymap InputHandler::s_keymap;
+SpscRing<RawInputEvent, InputHandler::kEventQueueCapacity> InputHandler::s_eventQueue;
+std::atomic<std::size_t> InputHandler::s_droppedEvents{0};
+double InputHandler::s_eventTime = 0.0;
+double InputHandler::s_scrollAccumulator = 0.0;
 
 
 
 // 注册默认快捷键
 void InputHandler::registerDefaultShortcuts() {
-    // Ctrl+N new
-    registerCtrlShortcut(GLFW_KEY_N, "new", "New", "N");
-    
-    // Ctrl+O open
-    registerCtrlShortcut(GLFW_KEY_O, "open", "Open", "O");
-    
-    // Ctrl+S save
-    registerCtrlShortcut(GLFW_KEY_S, "save", "Save", "S");
-    
-    // Ctrl+Shift+S saveas
-    registerCtrlShiftShortcut(GLFW_KEY_S, "saveas", "Save As", "S");
-    
-    // Ctrl+W close
-    registerCtrlShortcut(GLFW_KEY_W, "close", "Close", "W");
-    
-    // Ctrl+Q quit
-    registerCtrlShortcut(GLFW_KEY_Q, "quit", "Quit", "Q");
-    
-    // Ctrl+Z undo
-    registerCtrlShortcut(GLFW_KEY_Z, "undo", "Undo", "Z");
-    
-    // Ctrl+Y redo
-    registerCtrlShortcut(GLFW_KEY_Y, "redo", "Redo", "Y");
-    
-    // Ctrl+X cutclip
-    registerCtrlShortcut(GLFW_KEY_X, "cut", "Cut", "X");
-    
-    // Ctrl+C copyclip
-    registerCtrlShortcut(GLFW_KEY_C, "copy", "Copy", "C");
-    
-    // Ctrl+V pasteclip
-    registerCtrlShortcut(GLFW_KEY_V, "paste", "Paste", "V");
-    
-    // Ctrl+A selectall
-    registerCtrlShortcut(GLFW_KEY_A, "selectall", "Select All", "A");
+    // 默认绑定都是合法且互不冲突的，这里不检查错误
+    static const std::pair<const char*, const char*> s_defaultBindings[] = {
+        {"Ctrl+N", "new"},
+        {"Ctrl+O", "open"},
+        {"Ctrl+S", "save"},
+        {"Ctrl+Shift+S", "saveas"},
+        {"Ctrl+W", "close"},
+        {"Ctrl+Q", "quit"},
+        {"Ctrl+Z", "undo"},
+        {"Ctrl+Y", "redo"},
+        {"Ctrl+X", "cut"},
+        {"Ctrl+C", "copy"},
+        {"Ctrl+V", "paste"},
+        {"Ctrl+A", "selectall"},
+        {"Del", "erase"},
+    };
+    std::string error;
+    for (const auto& [keys, command] : s_defaultBindings) {
+        s_keymap.bind(keys, command, error);
+    }
+}
+
+// 获取按键绑定表
+Keymap& InputHandler::getKeymap() {
+    return s_keymap;
+}
+
+// 恢复默认绑定后加载用户绑定文件
+bool InputHandler::reloadKeymap(const std::filesystem::path& path) {
+    s_keymap.clear();
+    registerDefaultShortcuts();
     
-    // DEL erase
-    registerShortcut(GLFW_KEY_DELETE, "erase", "Erase", "Del");
+    // 默认的用户绑定文件是可选的
+    if (path.empty()) {
+        std::filesystem::path defaultPath = g_pathCwd / "keymap.json";
+        return !std::filesystem::exists(defaultPath) || s_keymap.loadFromFile(defaultPath);
+    }
+    return s_keymap.loadFromFile(path);
 }
 
 // 初始化输入处理器
 void InputHandler::initialize(GLFWwindow* window) {
     // 保存窗口指针
     s_window = window;
-    // 设置GLFW回调函数
+    // 设置GLFW回调函数，回调只把事件加入输入队列，由processEvents在主循环中分发
     glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
-        InputHandler::handleKeyPress(key, scancode, action, mods);
+        // 无法映射的按键（GLFW_KEY_UNKNOWN）既不能绑定也无法记录状态，不进入队列
+        if (key == GLFW_KEY_UNKNOWN) {
+            return;
+        }
+        InputHandler::enqueueEvent({RawInputType::Key, 0.0, key, scancode, action, mods});
     });
     
     // 设置字符回调函数
     glfwSetCharCallback(window, [](GLFWwindow* window, unsigned int codepoint) {
-        InputHandler::handleCharInput(codepoint);
+        RawInputEvent event{RawInputType::Char};
+        event.codepoint = codepoint;
+        InputHandler::enqueueEvent(event);
     });
     
     glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods) {
-        InputHandler::handleMousePress(button, action, mods);
+        InputHandler::enqueueEvent({RawInputType::MouseButton, 0.0, button, 0, action, mods});
     });
     
     glfwSetCursorPosCallback(window, [](GLFWwindow* window, double xpos, double ypos) {
-        InputHandler::handleMouseMove(xpos, ypos);
+        RawInputEvent event{RawInputType::MouseMove};
+        event.x = xpos;
+        event.y = ypos;
+        InputHandler::enqueueEvent(event);
     });
     
     glfwSetScrollCallback(window, [](GLFWwindow* window, double xoffset, double yoffset) {
-        InputHandler::handleMouseScroll(xoffset, yoffset);
+        RawInputEvent event{RawInputType::MouseScroll};
+        event.x = xoffset;
+        event.y = yoffset;
+        InputHandler::enqueueEvent(event);
     });
     
     // 鼠标进入/离开窗口的光标显示由ImGui控制，不再需要单独处理
@@ -97,15 +149,124 @@ void InputHandler::initialize(GLFWwindow* window) {
     
     // 注册窗口大小变化回调
     glfwSetWindowSizeCallback(window, [](GLFWwindow* window, int width, int height) {
-        InputHandler::handleWindowSize(width, height);
+        RawInputEvent event{RawInputType::WindowSize};
+        event.x = width;
+        event.y = height;
+        InputHandler::enqueueEvent(event);
     });
     
-    // 注册默认快捷键
-    registerDefaultShortcuts();
+    // 注册默认快捷键并加载用户绑定
+    reloadKeymap();
+}
+
+// 记录事件时间并加入输入队列
+void InputHandler::enqueueEvent(RawInputEvent event) {
+    // 回放期间忽略实际的输入
+    if (InputRecorder::isReplaying()) {
+        return;
+    }
+    event.time = glfwGetTime();
+    if (!s_eventQueue.push(event)) {
+        s_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// 分发排队的输入事件
+void InputHandler::processEvents() {
+    double now = glfwGetTime();
+    
+    // 回放时本帧的事件来自录制文件，先交给ImGui，再与实际输入一样合并分发
+    std::span<const RawInputEvent> replayEvents;
+    bool replaying = InputRecorder::isReplaying();
+    if (replaying && InputRecorder::takeReplayFrame(now, replayEvents)) {
+        for (const RawInputEvent& replayEvent : replayEvents) {
+            forwardReplayEventToImGui(s_window, replayEvent);
+        }
+    }
+    
+    // 只处理调用时已在队列中的事件，分发期间新产生的事件留到下一帧，每帧的处理量不超过队列容量；
+    // 相邻的同类可合并事件先暂存，遇到不同的事件时再分发
+    std::size_t count = replaying ? replayEvents.size() : s_eventQueue.size();
+    RawInputEvent pending;
+    bool hasPending = false;
+    RawInputEvent event;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (replaying) {
+            event = replayEvents[i];
+        } else if (!s_eventQueue.pop(event)) {
+            break;
+        }
+        // 录制合并前的事件，回放时经同样的合并得到相同的分发序列
+        InputRecorder::recordEvent(event);
+        
+        bool coalescable = event.type == RawInputType::MouseMove || event.type == RawInputType::MouseScroll ||
+                           event.type == RawInputType::WindowSize;
+        if (hasPending && coalescable && pending.type == event.type) {
+            if (event.type == RawInputType::MouseScroll) {
+                pending.x += event.x;
+                pending.y += event.y;
+            } else {
+                pending.x = event.x;
+                pending.y = event.y;
+            }
+            pending.time = event.time;
+            continue;
+        }
+        
+        if (hasPending) {
+            dispatchEvent(pending);
+        }
+        pending = event;
+        hasPending = true;
+    }
+    if (hasPending) {
+        dispatchEvent(pending);
+    }
+    InputRecorder::recordFrame(now);
+    
+    std::size_t dropped = s_droppedEvents.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        LOG_WARNING("Input event queue full, {} events dropped", dropped);
+    }
+}
+
+// 获取正在分发的事件的时间
+double InputHandler::getEventTime() {
+    return s_eventTime;
+}
+
+// 把队列中的事件分发到对应的处理函数
+void InputHandler::dispatchEvent(const RawInputEvent& event) {
+    s_eventTime = event.time;
+    switch (event.type) {
+        case RawInputType::Key:
+            handleKeyPress(event.code, event.scancode, event.action, event.mods);
+            break;
+        case RawInputType::Char:
+            handleCharInput(event.codepoint);
+            break;
+        case RawInputType::MouseButton:
+            handleMousePress(event.code, event.action, event.mods);
+            break;
+        case RawInputType::MouseMove:
+            handleMouseMove(event.x, event.y);
+            break;
+        case RawInputType::MouseScroll:
+            handleMouseScroll(event.x, event.y);
+            break;
+        case RawInputType::WindowSize:
+            handleWindowSize(static_cast<int>(event.x), static_cast<int>(event.y));
+            break;
+    }
 }
 
 // 处理键盘输入
 void InputHandler::handleKeyPress(int key, int scancode, int action, int mods) {
+    // 键码用作按键状态的下标
+    if (key < 0 || key > GLFW_KEY_LAST) {
+        return;
+    }
+    
     // 仅处理按下和释放，不处理GLFW_REPEAT，快捷键不应该重复执行，而命令输入的重复在第一个字符后会交由命令输入框处理
     if (action == GLFW_PRESS) {
         // 每按下一个新键，重置状态
@@ -116,65 +277,31 @@ void InputHandler::handleKeyPress(int key, int scancode, int action, int mods) {
         // 检查当前焦点是否位于命令栏或其子窗口
         bool bFocusIsOnCommandBar = Renderer::FocusIsOnWindow("CommandBar");
         
-        // 画布上或者命令栏才处理快捷键或者命令输入
-        if (!bFocusIsOnCommandBar && ImGui::GetIO().WantCaptureKeyboard) {
+        // 画布上或者命令栏才处理快捷键或者命令输入，命令历史搜索框中的输入交由搜索框自行处理
+        if ((!bFocusIsOnCommandBar && ImGui::GetIO().WantCaptureKeyboard) || Renderer::FocusIsOnHistorySearch()) {
             return;
         }
         
-        // 优先匹配按键更多的模式
-        // 1. 检查Ctrl+Shift+键快捷键
-        bool ctrlShiftPressed = (mods & GLFW_MOD_CONTROL) && (mods & GLFW_MOD_SHIFT);
-        if (ctrlShiftPressed) {
-            for (const auto& shortcut : s_shortcuts) {
-                if (shortcut.type == ShortcutType::CTRL_SHIFT_KEY && shortcut.key == key) {
-                    LOG_INFO("Executing shortcut: Ctrl+Shift+{} ({}, command: {})", shortcut.keyString, shortcut.name, shortcut.commandName);
-                    CommandParser::executeCommand(shortcut.commandName, {});
-                    // 标记当前按键已被快捷键消耗
-                    s_keyWasConsumedByShortcut = true;
-                    // 触发按键按下回调
-                    if (s_callbacks.contains(InputEventType::KEY_PRESS)) {
-                        s_callbacks[InputEventType::KEY_PRESS]();
-                    }
-                    return;
-                }
+        // 查找按键绑定：键码与修饰键合为一次哈希查找；多键序列的中间按键与中途不匹配的按键都被消耗
+        std::string command;
+        KeymapResult result = s_keymap.feed(key, mods, command);
+        if (result != KeymapResult::None) {
+            if (result == KeymapResult::Command) {
+                LOG_INFO("Executing key binding: {}", command);
+                CommandParser::parseCommand(command);
             }
-        }
-        
-        // 2. 检查Ctrl+键快捷键
-        bool ctrlPressed = (mods & GLFW_MOD_CONTROL);
-        if (ctrlPressed && !ctrlShiftPressed) {
-            for (const auto& shortcut : s_shortcuts) {
-                if (shortcut.type == ShortcutType::CTRL_KEY && shortcut.key == key) {
-                    LOG_INFO("Executing shortcut: Ctrl+{} ({}, command: {})", shortcut.keyString, shortcut.name, shortcut.commandName);
-                    CommandParser::executeCommand(shortcut.commandName, {});
-                    // 标记当前按键已被快捷键消耗
-                    s_keyWasConsumedByShortcut = true;
-                    // 触发按键按下回调
-                    if (s_callbacks.contains(InputEventType::KEY_PRESS)) {
-                        s_callbacks[InputEventType::KEY_PRESS]();
-                    }
-                    return;
-                }
+            // 标记当前按键已被快捷键消耗
+            s_keyWasConsumedByShortcut = true;
+            // 触发按键按下回调
+            if (s_callbacks.contains(InputEventType::KEY_PRESS)) {
+                s_callbacks[InputEventType::KEY_PRESS]();
             }
+            return;
         }
         
-        // 3. 检查单个按键快捷键
+        // 没有修饰键时处理命令栏的特殊按键
         bool noModifiers = (mods == 0);
         if (noModifiers) {
-            for (const auto& shortcut : s_shortcuts) {
-                if (shortcut.type == ShortcutType::SINGLE_KEY && shortcut.key == key) {
-                    LOG_INFO("Executing shortcut: {} ({}, command: {})", shortcut.keyString, shortcut.name, shortcut.commandName);
-                    CommandParser::executeCommand(shortcut.commandName, {});
-                    // 标记当前按键已被快捷键消耗
-                    s_keyWasConsumedByShortcut = true;
-                    // 触发按键按下回调
-                    if (s_callbacks.contains(InputEventType::KEY_PRESS)) {
-                        s_callbacks[InputEventType::KEY_PRESS]();
-                    }
-                    return;
-                }
-            }
-            
             // 处理特殊的"非字符"输入动作
             bool bFocusIsOnCommandInput = Renderer::FocusIsOnCommandInput();
             // Backsapce
@@ -230,7 +357,7 @@ void InputHandler::handleKeyPress(int key, int scancode, int action, int mods) {
 void InputHandler::handleCharInput(unsigned int codepoint) {
     // 只有在按键回调handleKeyPress没有把当前输入作为快捷键拦截掉的情况下才处理字符
     // 字符回调的会自动处理CapsLock和Shift转换后的结果，而不需要也不应该有任何自行检测CapsLock与Shift的操作
-    if (!s_keyWasConsumedByShortcut) {
+    if (!s_keyWasConsumedByShortcut && !Renderer::FocusIsOnHistorySearch()) {
         // 如果焦点不在命令栏输入框上，则将焦点拉回到输入框，并将输入的字符添加到缓冲区
         // 而焦点在命令输入栏的话，输入控件会自行处理，则不需要做任何多余处理
         if (!Renderer::FocusIsOnCommandInput()) {
@@ -259,6 +386,12 @@ void InputHandler::handleMousePress(int button, int action, int mods) {
             s_mouseMiddleButtonPressedInDrawableArea = Renderer::getLogicalViewport().isPointInDrawableArea(s_mousePosition);
         }
         
+        // 左键点击可绘制区域时向等待取点的交互工具提交点
+        if (button == GLFW_MOUSE_BUTTON_LEFT && ToolScheduler::isActive() && Renderer::getLogicalViewport().isPointInDrawableArea(s_mousePosition)) {
+            glm::dvec3 logicPos = Renderer::getLogicalViewport().screenToLogic(s_mousePosition);
+            ToolScheduler::submitPoint(glm::vec2(static_cast<float>(logicPos.x), static_cast<float>(logicPos.y)));
+        }
+        
         // 触发鼠标按下回调
         if (s_callbacks.contains(InputEventType::MOUSE_PRESS)) {
             s_callbacks[InputEventType::MOUSE_PRESS]();
@@ -328,11 +461,17 @@ void InputHandler::handleMouseScroll(double xoffset, double yoffset) {
     
     // 检查鼠标是否在可绘制区域内
     if (Renderer::getLogicalViewport().isPointInDrawableArea(mousePos)) {
+        // 合并后的偏移可能包含多格，每格缩放一次；触控板不足一格的偏移累积到下一次
+        s_scrollAccumulator += yoffset;
+        int steps = static_cast<int>(s_scrollAccumulator);
+        s_scrollAccumulator -= steps;
+        
         // 根据滚轮方向进行缩放（反转方向：向上滚放大，向下滚缩小）
-        if (yoffset > 0) {
+        for (; steps > 0; --steps) {
             // 滚轮向上，缩小栅格
             Renderer::zoomOut(mousePos);
-        } else if (yoffset < 0) {
+        }
+        for (; steps < 0; ++steps) {
             // 滚轮向下，放大栅格
             Renderer::zoomIn(mousePos);
         }
@@ -400,52 +539,6 @@ void InputHandler::unregisterCallback(InputEventType eventType) {
     s_callbacks.erase(eventType);
 }
 
-// 注册单个按键快捷键
-void InputHandler::registerShortcut(int key, const std::string& commandName, const std::string& name, const std::string& keyString) {
-    // 先移除已存在的相同快捷键
-    unregisterShortcut(key, ShortcutType::SINGLE_KEY);
-    // 添加新的快捷键
-    s_shortcuts.push_back({key, ShortcutType::SINGLE_KEY, commandName, name, keyString});
-    LOG_INFO("Registered shortcut: {} (key: {}, keyString: {}, command: {})", name, key, keyString, commandName);
-}
-
-// 注册Ctrl+键快捷键
-void InputHandler::registerCtrlShortcut(int key, const std::string& commandName, const std::string& name, const std::string& keyString) {
-    // 先移除已存在的相同快捷键
-    unregisterShortcut(key, ShortcutType::CTRL_KEY);
-    // 添加新的快捷键
-    s_shortcuts.push_back({key, ShortcutType::CTRL_KEY, commandName, name, keyString});
-    LOG_INFO("Registered Ctrl shortcut: {} (key: {}, keyString: {}, command: {})", name, key, keyString, commandName);
-}
-
-// 注册Ctrl+Shift+键快捷键
-void InputHandler::registerCtrlShiftShortcut(int key, const std::string& commandName, const std::string& name, const std::string& keyString) {
-    // 先移除已存在的相同快捷键
-    unregisterShortcut(key, ShortcutType::CTRL_SHIFT_KEY);
-    // 添加新的快捷键
-    s_shortcuts.push_back({key, ShortcutType::CTRL_SHIFT_KEY, commandName, name, keyString});
-    LOG_INFO("Registered Ctrl+Shift shortcut: {} (key: {}, keyString: {}, command: {})", name, key, keyString, commandName);
-}
-
-// 取消注册快捷键
-void InputHandler::unregisterShortcut(int key, ShortcutType type) {
-    auto it = std::remove_if(s_shortcuts.begin(), s_shortcuts.end(),
-        [key, type](const ShortcutItem& item) {
-            return item.key == key && item.type == type;
-        });
-    if (it != s_shortcuts.end()) {
-        std::string name = it->name;
-        s_shortcuts.erase(it, s_shortcuts.end());
-        LOG_INFO("Unregistered shortcut: {}", name);
-    }
-}
-
-// 清除所有快捷键
-void InputHandler::clearAllShortcuts() {
-    LOG_INFO("Clearing all shortcuts");
-    s_shortcuts.clear();
-}
-
 // 设置鼠标指针可见性
 void InputHandler::setMouseCursorVisible(bool visible) {
     if (s_window) {
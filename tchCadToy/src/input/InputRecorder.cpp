@@ -0,0 +1,443 @@
+#include "input/InputRecorder.h"
+#include "debug/Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iterator>
+
+namespace tch {
+
+namespace {
+
+// 录制文件格式：文件头为魔数、版本、窗口宽高与光标位置；其后每条记录为1字节类型、与上一条记录的间隔（微秒，变长整数）
+// 以及按类型而定的数据。整数为变长编码（有符号数先做zigzag变换），浮点数为8字节小端
+constexpr char kInputRecordMagic[4] = {'T', 'C', 'H', 'I'};
+constexpr std::uint64_t kInputRecordVersion = 1;
+constexpr std::uint8_t kInputRecordFrame = 0x80;          // 帧边界记录的类型
+constexpr std::size_t kInputRecordFlushSize = 64 * 1024;  // 缓冲区超过该大小时写入文件
+constexpr double kInputRecordSlowFrame = 1.0 / 30.0;      // 统计中计为卡顿的帧耗时
+
+// 写入无符号变长整数：每字节7位，最高位表示后面还有字节
+void writeRecordVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// 写入有符号变长整数
+void writeRecordSigned(std::vector<std::uint8_t>& out, std::int64_t value) {
+    writeRecordVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+// 写入8字节小端浮点数
+void writeRecordDouble(std::vector<std::uint8_t>& out, double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<std::uint8_t>(bits >> (i * 8)));
+    }
+}
+
+// 录制文件读取器：读取越界时置失败标记，之后的读取都失败
+class InputRecordReader {
+public:
+    explicit InputRecordReader(const std::vector<std::uint8_t>& data) : m_data(data) {}
+    
+    bool atEnd() const { return m_offset >= m_data.size(); }
+    bool failed() const { return m_failed; }
+    
+    std::uint8_t readByte() {
+        if (m_failed || m_offset >= m_data.size()) {
+            m_failed = true;
+            return 0;
+        }
+        return m_data[m_offset++];
+    }
+    
+    std::uint64_t readVarint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t byte = readByte();
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        m_failed = true;
+        return 0;
+    }
+    
+    std::int64_t readSigned() {
+        std::uint64_t value = readVarint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+    
+    double readDouble() {
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= static_cast<std::uint64_t>(readByte()) << (i * 8);
+        }
+        double value = 0.0;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    const std::vector<std::uint8_t>& m_data;
+    std::size_t m_offset = 0;
+    bool m_failed = false;
+};
+
+// 回放的事件是否有效：键码与鼠标按钮会被用作下标
+bool isValidRecordedEvent(const RawInputEvent& event) {
+    switch (event.type) {
+        case RawInputType::Key:
+            return event.code >= 0 && event.code <= GLFW_KEY_LAST;
+        case RawInputType::MouseButton:
+            return event.code >= 0 && event.code <= GLFW_MOUSE_BUTTON_LAST;
+        case RawInputType::MouseMove:
+        case RawInputType::MouseScroll:
+            return std::isfinite(event.x) && std::isfinite(event.y);
+        default:
+            return true;
+    }
+}
+
+} // namespace
+
+// 静态成员初始化
+InputRecorder::State InputRecorder::s_state = InputRecorder::State::Idle;
+std::ofstream InputRecorder::s_output;
+std::vector<std::uint8_t> InputRecorder::s_buffer;
+double InputRecorder::s_recordStart = 0.0;
+std::uint64_t InputRecorder::s_lastRecordMicros = 0;
+std::size_t InputRecorder::s_recordedEvents = 0;
+std::size_t InputRecorder::s_recordedFrames = 0;
+std::vector<RawInputEvent> InputRecorder::s_replayEvents;
+std::vector<InputRecorder::ReplayFrame> InputRecorder::s_replayFrames;
+std::size_t InputRecorder::s_replayFrame = 0;
+ReplaySpeed InputRecorder::s_replaySpeed = ReplaySpeed::Original;
+double InputRecorder::s_replayStart = 0.0;
+double InputRecorder::s_lastFrameTime = -1.0;
+std::vector<double> InputRecorder::s_frameTimes;
+
+// 开始录制
+bool InputRecorder::startRecording(GLFWwindow* window, const std::filesystem::path& path) {
+    if (s_state == State::Recording || s_state == State::Replaying) {
+        LOG_WARNING("Cannot start recording input: a recording or replay is in progress");
+        return false;
+    }
+    
+    s_output.open(path, std::ios::binary | std::ios::trunc);
+    if (!s_output) {
+        LOG_ERROR("Failed to open input recording file: {}", path.string());
+        return false;
+    }
+    
+    int width = 0;
+    int height = 0;
+    glfwGetWindowSize(window, &width, &height);
+    double cursorX = 0.0;
+    double cursorY = 0.0;
+    glfwGetCursorPos(window, &cursorX, &cursorY);
+    
+    s_buffer.clear();
+    s_buffer.insert(s_buffer.end(), std::begin(kInputRecordMagic), std::end(kInputRecordMagic));
+    writeRecordVarint(s_buffer, kInputRecordVersion);
+    writeRecordVarint(s_buffer, static_cast<std::uint64_t>(std::max(width, 0)));
+    writeRecordVarint(s_buffer, static_cast<std::uint64_t>(std::max(height, 0)));
+    writeRecordDouble(s_buffer, cursorX);
+    writeRecordDouble(s_buffer, cursorY);
+    
+    s_recordStart = glfwGetTime();
+    s_lastRecordMicros = 0;
+    s_recordedEvents = 0;
+    s_recordedFrames = 0;
+    s_state = State::Recording;
+    LOG_INFO("Recording input to {}", path.string());
+    return true;
+}
+
+// 结束录制
+void InputRecorder::stopRecording() {
+    if (s_state != State::Recording) {
+        return;
+    }
+    flush();
+    std::streamoff size = s_output.tellp();
+    s_output.close();
+    s_state = State::Idle;
+    LOG_INFO("Input recording finished: {} frames, {} events, {} bytes", s_recordedFrames, s_recordedEvents, static_cast<long long>(size));
+}
+
+// 是否正在录制
+bool InputRecorder::isRecording() {
+    return s_state == State::Recording;
+}
+
+// 录制一个原始事件
+void InputRecorder::recordEvent(const RawInputEvent& event) {
+    if (s_state != State::Recording) {
+        return;
+    }
+    
+    s_buffer.push_back(static_cast<std::uint8_t>(event.type));
+    writeTime(event.time);
+    switch (event.type) {
+        case RawInputType::Key:
+            writeRecordSigned(s_buffer, event.code);
+            writeRecordSigned(s_buffer, event.scancode);
+            s_buffer.push_back(static_cast<std::uint8_t>(event.action));
+            s_buffer.push_back(static_cast<std::uint8_t>(event.mods));
+            break;
+        case RawInputType::Char:
+            writeRecordVarint(s_buffer, event.codepoint);
+            break;
+        case RawInputType::MouseButton:
+            s_buffer.push_back(static_cast<std::uint8_t>(event.code));
+            s_buffer.push_back(static_cast<std::uint8_t>(event.action));
+            s_buffer.push_back(static_cast<std::uint8_t>(event.mods));
+            break;
+        case RawInputType::MouseMove:
+        case RawInputType::MouseScroll:
+            writeRecordDouble(s_buffer, event.x);
+            writeRecordDouble(s_buffer, event.y);
+            break;
+        case RawInputType::WindowSize:
+            writeRecordVarint(s_buffer, static_cast<std::uint64_t>(std::max(event.x, 0.0)));
+            writeRecordVarint(s_buffer, static_cast<std::uint64_t>(std::max(event.y, 0.0)));
+            break;
+    }
+    ++s_recordedEvents;
+}
+
+// 录制帧边界
+void InputRecorder::recordFrame(double time) {
+    if (s_state != State::Recording) {
+        return;
+    }
+    
+    s_buffer.push_back(kInputRecordFrame);
+    writeTime(time);
+    ++s_recordedFrames;
+    if (s_buffer.size() >= kInputRecordFlushSize) {
+        flush();
+    }
+}
+
+// 写入与上一条记录的时间间隔，时间不会倒退
+void InputRecorder::writeTime(double time) {
+    double micros = std::round((time - s_recordStart) * 1e6);
+    std::uint64_t current = micros > 0.0 ? static_cast<std::uint64_t>(micros) : 0;
+    current = std::max(current, s_lastRecordMicros);
+    writeRecordVarint(s_buffer, current - s_lastRecordMicros);
+    s_lastRecordMicros = current;
+}
+
+// 把缓冲区写入文件
+void InputRecorder::flush() {
+    s_output.write(reinterpret_cast<const char*>(s_buffer.data()), static_cast<std::streamsize>(s_buffer.size()));
+    s_buffer.clear();
+    if (!s_output) {
+        LOG_ERROR("Failed to write input recording, recording stopped");
+        s_output.close();
+        s_state = State::Idle;
+    }
+}
+
+// 加载录制文件并开始回放
+bool InputRecorder::startReplay(GLFWwindow* window, const std::filesystem::path& path, ReplaySpeed speed) {
+    if (s_state == State::Recording || s_state == State::Replaying) {
+        LOG_WARNING("Cannot start replay: a recording or replay is in progress");
+        return false;
+    }
+    
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        LOG_ERROR("Failed to open input recording: {}", path.string());
+        return false;
+    }
+    std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    
+    InputRecordReader reader(data);
+    char magic[4] = {};
+    for (char& c : magic) {
+        c = static_cast<char>(reader.readByte());
+    }
+    if (reader.failed() || !std::equal(std::begin(magic), std::end(magic), std::begin(kInputRecordMagic))) {
+        LOG_ERROR("Not an input recording: {}", path.string());
+        return false;
+    }
+    std::uint64_t version = reader.readVarint();
+    if (version != kInputRecordVersion) {
+        LOG_ERROR("Unsupported input recording version {}: {}", version, path.string());
+        return false;
+    }
+    int width = static_cast<int>(reader.readVarint());
+    int height = static_cast<int>(reader.readVarint());
+    double cursorX = reader.readDouble();
+    double cursorY = reader.readDouble();
+    
+    // 第一帧先恢复录制开始时的窗口大小与光标位置
+    std::vector<RawInputEvent> events;
+    std::vector<ReplayFrame> frames;
+    RawInputEvent sizeEvent{RawInputType::WindowSize};
+    sizeEvent.x = width;
+    sizeEvent.y = height;
+    events.push_back(sizeEvent);
+    RawInputEvent cursorEvent{RawInputType::MouseMove};
+    cursorEvent.x = cursorX;
+    cursorEvent.y = cursorY;
+    events.push_back(cursorEvent);
+    
+    std::uint64_t micros = 0;
+    while (!reader.atEnd() && !reader.failed()) {
+        std::uint8_t type = reader.readByte();
+        micros += reader.readVarint();
+        double time = static_cast<double>(micros) / 1e6;
+        if (type == kInputRecordFrame) {
+            frames.push_back({time, events.size()});
+            continue;
+        }
+        
+        RawInputEvent event{static_cast<RawInputType>(type), time};
+        switch (event.type) {
+            case RawInputType::Key:
+                event.code = static_cast<int>(reader.readSigned());
+                event.scancode = static_cast<int>(reader.readSigned());
+                event.action = reader.readByte();
+                event.mods = reader.readByte();
+                break;
+            case RawInputType::Char:
+                event.codepoint = static_cast<unsigned int>(reader.readVarint());
+                break;
+            case RawInputType::MouseButton:
+                event.code = reader.readByte();
+                event.action = reader.readByte();
+                event.mods = reader.readByte();
+                break;
+            case RawInputType::MouseMove:
+            case RawInputType::MouseScroll:
+                event.x = reader.readDouble();
+                event.y = reader.readDouble();
+                break;
+            case RawInputType::WindowSize:
+                event.x = static_cast<double>(reader.readVarint());
+                event.y = static_cast<double>(reader.readVarint());
+                break;
+            default:
+                LOG_ERROR("Unknown record type {} in input recording: {}", type, path.string());
+                return false;
+        }
+        // 无法识别的按键（GLFW_KEY_UNKNOWN）不参与分发，旧录制中可能存在，直接跳过
+        if (event.type == RawInputType::Key && event.code == GLFW_KEY_UNKNOWN) {
+            continue;
+        }
+        if (!isValidRecordedEvent(event)) {
+            LOG_ERROR("Invalid event in input recording: {}", path.string());
+            return false;
+        }
+        events.push_back(event);
+    }
+    if (reader.failed()) {
+        LOG_ERROR("Input recording is truncated: {}", path.string());
+        return false;
+    }
+    // 录制未正常结束时，最后一帧之后的事件作为一帧
+    if (frames.empty() || frames.back().end < events.size()) {
+        frames.push_back({static_cast<double>(micros) / 1e6, events.size()});
+    }
+    
+    if (width > 0 && height > 0) {
+        glfwSetWindowSize(window, width, height);
+    }
+    
+    // 事件时间换算到回放的时间轴
+    s_replayStart = glfwGetTime();
+    for (RawInputEvent& event : events) {
+        event.time += s_replayStart;
+    }
+    s_replayEvents = std::move(events);
+    s_replayFrames = std::move(frames);
+    s_replayFrame = 0;
+    s_replaySpeed = speed;
+    s_lastFrameTime = -1.0;
+    s_frameTimes.clear();
+    s_frameTimes.reserve(s_replayFrames.size());
+    s_state = State::Replaying;
+    LOG_INFO("Replaying {} frames ({} events) from {}", s_replayFrames.size(), s_replayEvents.size(), path.string());
+    return true;
+}
+
+// 是否正在回放
+bool InputRecorder::isReplaying() {
+    return s_state == State::Replaying;
+}
+
+// 回放是否已结束
+bool InputRecorder::isReplayFinished() {
+    return s_state == State::Finished;
+}
+
+// 取出本帧要注入的事件
+bool InputRecorder::takeReplayFrame(double now, std::span<const RawInputEvent>& events) {
+    if (s_state != State::Replaying) {
+        return false;
+    }
+    
+    if (s_lastFrameTime >= 0.0) {
+        s_frameTimes.push_back(now - s_lastFrameTime);
+    }
+    s_lastFrameTime = now;
+    
+    // 最后一帧注入后再过一帧才结束，使最后一帧的耗时也计入统计
+    if (s_replayFrame >= s_replayFrames.size()) {
+        finishReplay();
+        return false;
+    }
+    
+    const ReplayFrame& frame = s_replayFrames[s_replayFrame];
+    if (s_replaySpeed == ReplaySpeed::Original && now - s_replayStart < frame.time) {
+        return false;
+    }
+    std::size_t begin = s_replayFrame == 0 ? 0 : s_replayFrames[s_replayFrame - 1].end;
+    events = std::span<const RawInputEvent>(s_replayEvents.data() + begin, frame.end - begin);
+    ++s_replayFrame;
+    return true;
+}
+
+// 结束回放并输出统计
+void InputRecorder::finishReplay() {
+    s_state = State::Finished;
+    s_replayEvents.clear();
+    s_replayEvents.shrink_to_fit();
+    LOG_INFO("{}", getReplaySummary());
+}
+
+// 回放的帧时间统计
+std::string InputRecorder::getReplaySummary() {
+    if (s_frameTimes.empty()) {
+        return "Replay: no frames";
+    }
+    
+    std::vector<double> sorted = s_frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())));
+        return sorted[index] * 1000.0;
+    };
+    double total = 0.0;
+    for (double frameTime : sorted) {
+        total += frameTime;
+    }
+    std::size_t slowFrames = static_cast<std::size_t>(sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), kInputRecordSlowFrame));
+    
+    return std::format("Replay: {} frames in {:.3f} s, frame time avg {:.2f} ms, p50 {:.2f} ms, p95 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms, {} frames over {:.1f} ms",
+                       sorted.size(), total, total * 1000.0 / static_cast<double>(sorted.size()), percentile(0.50), percentile(0.95),
+                       percentile(0.99), sorted.back() * 1000.0, slowFrames, kInputRecordSlowFrame * 1000.0);
+}
+
+} // namespace tch
@@ -0,0 +1,420 @@
+#include "input/Keymap.h"
+#include "debug/Logger.h"
+#include "rapidjson/document.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+namespace tch {
+
+namespace {
+
+// 具名按键，前面的名称用于格式化，解析时全部名称都可用
+struct KeymapKeyName {
+    int key;
+    const char* name;
+};
+
+constexpr KeymapKeyName kKeymapKeyNames[] = {
+    {GLFW_KEY_SPACE, "Space"},
+    {GLFW_KEY_ESCAPE, "Esc"},
+    {GLFW_KEY_ENTER, "Enter"},
+    {GLFW_KEY_TAB, "Tab"},
+    {GLFW_KEY_BACKSPACE, "Backspace"},
+    {GLFW_KEY_INSERT, "Ins"},
+    {GLFW_KEY_DELETE, "Del"},
+    {GLFW_KEY_RIGHT, "Right"},
+    {GLFW_KEY_LEFT, "Left"},
+    {GLFW_KEY_DOWN, "Down"},
+    {GLFW_KEY_UP, "Up"},
+    {GLFW_KEY_PAGE_UP, "PageUp"},
+    {GLFW_KEY_PAGE_DOWN, "PageDown"},
+    {GLFW_KEY_HOME, "Home"},
+    {GLFW_KEY_END, "End"},
+    {GLFW_KEY_ESCAPE, "Escape"},
+    {GLFW_KEY_ENTER, "Return"},
+    {GLFW_KEY_INSERT, "Insert"},
+    {GLFW_KEY_DELETE, "Delete"},
+};
+
+// 键码与ASCII相同的标点键
+constexpr std::string_view kKeymapPunctuation = "`-=[]\\;',./";
+
+// 功能键个数（F1-F25）
+constexpr int kKeymapFunctionKeyCount = 25;
+
+// 修饰键名称
+struct KeymapModifierName {
+    int mod;
+    const char* name;
+};
+
+constexpr KeymapModifierName kKeymapModifierNames[] = {
+    {GLFW_MOD_CONTROL, "Ctrl"},
+    {GLFW_MOD_SHIFT, "Shift"},
+    {GLFW_MOD_ALT, "Alt"},
+    {GLFW_MOD_SUPER, "Super"},
+    {GLFW_MOD_CONTROL, "Control"},
+    {GLFW_MOD_SUPER, "Cmd"},
+    {GLFW_MOD_SUPER, "Win"},
+};
+
+// 不区分大小写比较
+bool keymapNameEquals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+// 解析键名，无效时返回GLFW_KEY_UNKNOWN
+int parseKeymapKey(std::string_view name) {
+    if (name.empty()) {
+        return GLFW_KEY_UNKNOWN;
+    }
+    if (name.size() == 1) {
+        char c = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+        if (c >= 'A' && c <= 'Z') {
+            return GLFW_KEY_A + (c - 'A');
+        }
+        if (c >= '0' && c <= '9') {
+            return GLFW_KEY_0 + (c - '0');
+        }
+        if (kKeymapPunctuation.find(c) != std::string_view::npos) {
+            return c;
+        }
+        return GLFW_KEY_UNKNOWN;
+    }
+    
+    // 功能键
+    if (name.size() <= 3 && (name[0] == 'F' || name[0] == 'f')) {
+        int index = 0;
+        auto [end, ec] = std::from_chars(name.data() + 1, name.data() + name.size(), index);
+        if (ec == std::errc() && end == name.data() + name.size() && index >= 1 && index <= kKeymapFunctionKeyCount) {
+            return GLFW_KEY_F1 + index - 1;
+        }
+    }
+    
+    for (const auto& entry : kKeymapKeyNames) {
+        if (keymapNameEquals(name, entry.name)) {
+            return entry.key;
+        }
+    }
+    return GLFW_KEY_UNKNOWN;
+}
+
+// 格式化键名
+std::string formatKeymapKey(int key) {
+    if (key >= GLFW_KEY_A && key < GLFW_KEY_A + 26) {
+        return std::string(1, static_cast<char>('A' + (key - GLFW_KEY_A)));
+    }
+    if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) {
+        return std::string(1, static_cast<char>('0' + (key - GLFW_KEY_0)));
+    }
+    if (key >= 0 && key < 128 && kKeymapPunctuation.find(static_cast<char>(key)) != std::string_view::npos) {
+        return std::string(1, static_cast<char>(key));
+    }
+    if (key >= GLFW_KEY_F1 && key < GLFW_KEY_F1 + kKeymapFunctionKeyCount) {
+        return "F" + std::to_string(key - GLFW_KEY_F1 + 1);
+    }
+    for (const auto& entry : kKeymapKeyNames) {
+        if (entry.key == key) {
+            return entry.name;
+        }
+    }
+    return "Key" + std::to_string(key);
+}
+
+} // namespace
+
+// 绑定按键序列到命令
+bool Keymap::bind(std::string_view keys, const std::string& command, std::string& error) {
+    std::vector<KeyChord> sequence;
+    if (!parseSequence(keys, sequence)) {
+        error = "invalid key sequence '" + std::string(keys) + "'";
+        return false;
+    }
+    if (command.empty()) {
+        error = "command is empty";
+        return false;
+    }
+    
+    // 与已有绑定互为前缀时，较长的序列永远无法触发
+    std::uint32_t node = 0;
+    for (std::size_t i = 0; i < sequence.size(); ++i) {
+        auto it = m_nodes[node].children.find(encode(sequence[i].key, sequence[i].mods));
+        if (it == m_nodes[node].children.end()) {
+            break;
+        }
+        node = it->second;
+        const Node& current = m_nodes[node];
+        if (i + 1 < sequence.size() && !current.command.empty()) {
+            std::vector<KeyChord> prefix(sequence.begin(), sequence.begin() + static_cast<std::ptrdiff_t>(i + 1));
+            error = formatSequence(prefix) + " is already bound to '" + current.command + "'";
+            return false;
+        }
+        if (i + 1 == sequence.size() && current.command.empty() && current.bindingCount > 0) {
+            error = formatSequence(sequence) + " is the prefix of other key sequences";
+            return false;
+        }
+    }
+    
+    // 已绑定时只替换命令
+    std::uint32_t existing = findNode(sequence);
+    if (existing != 0 && !m_nodes[existing].command.empty()) {
+        m_nodes[existing].command = command;
+        return true;
+    }
+    
+    // 创建路径上缺少的节点，路径上每个节点的绑定数加一；push_back可能使引用失效，只保存下标
+    node = 0;
+    ++m_nodes[0].bindingCount;
+    for (const auto& chord : sequence) {
+        std::uint32_t code = encode(chord.key, chord.mods);
+        auto it = m_nodes[node].children.find(code);
+        std::uint32_t child = 0;
+        if (it == m_nodes[node].children.end()) {
+            child = static_cast<std::uint32_t>(m_nodes.size());
+            m_nodes.emplace_back();
+            m_nodes[node].children.emplace(code, child);
+        } else {
+            child = it->second;
+        }
+        node = child;
+        ++m_nodes[node].bindingCount;
+    }
+    m_nodes[node].command = command;
+    
+    // 进行中的序列可能经过了变化的节点
+    resetSequence();
+    return true;
+}
+
+// 解除绑定
+bool Keymap::unbind(std::string_view keys) {
+    std::vector<KeyChord> sequence;
+    if (!parseSequence(keys, sequence)) {
+        return false;
+    }
+    std::uint32_t target = findNode(sequence);
+    if (target == 0 || m_nodes[target].command.empty()) {
+        return false;
+    }
+    m_nodes[target].command.clear();
+    
+    // 节点保留，绑定数为0的节点在查找时视为不存在
+    std::uint32_t node = 0;
+    --m_nodes[0].bindingCount;
+    for (const auto& chord : sequence) {
+        node = m_nodes[node].children.at(encode(chord.key, chord.mods));
+        --m_nodes[node].bindingCount;
+    }
+    resetSequence();
+    return true;
+}
+
+// 清除全部绑定
+void Keymap::clear() {
+    m_nodes.assign(1, Node{});
+    resetSequence();
+}
+
+// 查找绑定的命令
+const std::string* Keymap::find(std::string_view keys) const {
+    std::vector<KeyChord> sequence;
+    if (!parseSequence(keys, sequence)) {
+        return nullptr;
+    }
+    std::uint32_t node = findNode(sequence);
+    if (node == 0 || m_nodes[node].command.empty()) {
+        return nullptr;
+    }
+    return &m_nodes[node].command;
+}
+
+// 输入一次按键
+KeymapResult Keymap::feed(int key, int mods, std::string& command) {
+    // 修饰键本身（如按住Ctrl）不影响序列
+    if (key >= GLFW_KEY_LEFT_SHIFT && key <= GLFW_KEY_RIGHT_SUPER) {
+        return isPending() ? KeymapResult::Pending : KeymapResult::None;
+    }
+    
+    const Node& current = m_nodes[m_state];
+    auto it = current.children.find(encode(key, mods));
+    if (it == current.children.end() || m_nodes[it->second].bindingCount == 0) {
+        bool wasPending = isPending();
+        resetSequence();
+        return wasPending ? KeymapResult::Unbound : KeymapResult::None;
+    }
+    
+    const Node& next = m_nodes[it->second];
+    if (!next.command.empty()) {
+        command = next.command;
+        resetSequence();
+        return KeymapResult::Command;
+    }
+    m_state = it->second;
+    m_pending.push_back({key, mods & kModifierMask});
+    return KeymapResult::Pending;
+}
+
+// 丢弃进行中的多键序列
+void Keymap::resetSequence() {
+    m_state = 0;
+    m_pending.clear();
+}
+
+// 已输入的多键序列前缀
+std::string Keymap::getPendingKeys() const {
+    return formatSequence(m_pending);
+}
+
+// 全部绑定
+std::vector<std::pair<std::string, std::string>> Keymap::getBindings() const {
+    std::vector<std::pair<std::string, std::string>> bindings;
+    std::vector<KeyChord> prefix;
+    collectBindings(0, prefix, bindings);
+    std::sort(bindings.begin(), bindings.end());
+    return bindings;
+}
+
+// 从JSON文件加载绑定
+bool Keymap::loadFromFile(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_WARNING("Failed to open keymap file: {}", path.string());
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string content = buffer.str();
+    
+    rapidjson::Document doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError() || !doc.IsObject()) {
+        LOG_ERROR("Keymap file is not a valid JSON object: {}", path.string());
+        return false;
+    }
+    
+    std::size_t bound = 0;
+    for (auto it = doc.MemberBegin(); it != doc.MemberEnd(); ++it) {
+        std::string keys = it->name.GetString();
+        if (it->value.IsNull()) {
+            unbind(keys);
+        } else if (it->value.IsString()) {
+            std::string error;
+            if (bind(keys, it->value.GetString(), error)) {
+                ++bound;
+            } else {
+                LOG_WARNING("Ignored key binding '{}' in {}: {}", keys, path.string(), error);
+            }
+        } else {
+            LOG_WARNING("Ignored key binding '{}' in {}: value must be a command string or null", keys, path.string());
+        }
+    }
+    LOG_INFO("Loaded {} key bindings from {}", bound, path.string());
+    return true;
+}
+
+// 解析按键序列
+bool Keymap::parseSequence(std::string_view text, std::vector<KeyChord>& out) {
+    out.clear();
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        // 序列中的按键以空白分隔
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        std::size_t end = pos;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end]))) {
+            ++end;
+        }
+        if (end == pos) {
+            break;
+        }
+        std::string_view token = text.substr(pos, end - pos);
+        pos = end;
+        
+        // 修饰键在前，以+连接，最后一段为键名
+        KeyChord chord;
+        std::size_t plus = token.rfind('+');
+        std::string_view keyName = plus == std::string_view::npos ? token : token.substr(plus + 1);
+        std::string_view modifiers = plus == std::string_view::npos ? std::string_view() : token.substr(0, plus + 1);
+        while (!modifiers.empty()) {
+            std::size_t next = modifiers.find('+');
+            std::string_view name = modifiers.substr(0, next);
+            modifiers.remove_prefix(next + 1);
+            auto modifier = std::find_if(std::begin(kKeymapModifierNames), std::end(kKeymapModifierNames), [name](const KeymapModifierName& entry) {
+                return keymapNameEquals(name, entry.name);
+            });
+            if (modifier == std::end(kKeymapModifierNames)) {
+                return false;
+            }
+            chord.mods |= modifier->mod;
+        }
+        chord.key = parseKeymapKey(keyName);
+        if (chord.key == GLFW_KEY_UNKNOWN) {
+            return false;
+        }
+        out.push_back(chord);
+    }
+    return !out.empty();
+}
+
+// 格式化一次按键
+std::string Keymap::formatChord(const KeyChord& chord) {
+    std::string text;
+    for (int mod : {GLFW_MOD_CONTROL, GLFW_MOD_SHIFT, GLFW_MOD_ALT, GLFW_MOD_SUPER}) {
+        if (chord.mods & mod) {
+            auto modifier = std::find_if(std::begin(kKeymapModifierNames), std::end(kKeymapModifierNames), [mod](const KeymapModifierName& entry) {
+                return entry.mod == mod;
+            });
+            text += modifier->name;
+            text += '+';
+        }
+    }
+    return text + formatKeymapKey(chord.key);
+}
+
+// 格式化按键序列
+std::string Keymap::formatSequence(const std::vector<KeyChord>& sequence) {
+    std::string text;
+    for (const auto& chord : sequence) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += formatChord(chord);
+    }
+    return text;
+}
+
+// 查找序列对应的节点
+std::uint32_t Keymap::findNode(const std::vector<KeyChord>& sequence) const {
+    std::uint32_t node = 0;
+    for (const auto& chord : sequence) {
+        auto it = m_nodes[node].children.find(encode(chord.key, chord.mods));
+        if (it == m_nodes[node].children.end()) {
+            return 0;
+        }
+        node = it->second;
+    }
+    return node;
+}
+
+// 收集以node为根的全部绑定
+void Keymap::collectBindings(std::uint32_t node, std::vector<KeyChord>& prefix, std::vector<std::pair<std::string, std::string>>& out) const {
+    if (!m_nodes[node].command.empty()) {
+        out.emplace_back(formatSequence(prefix), m_nodes[node].command);
+    }
+    for (const auto& [code, child] : m_nodes[node].children) {
+        if (m_nodes[child].bindingCount == 0) {
+            continue;
+        }
+        prefix.push_back({static_cast<int>(code >> 4), static_cast<int>(code & kModifierMask)});
+        collectBindings(child, prefix, out);
+        prefix.pop_back();
+    }
+}
+
+} // namespace tch
@@ -0,0 +1,85 @@
+#include "render/CommandHistoryView.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cctype>
+
+namespace tch {
+
+// 在当前窗口中绘制历史
+void CommandHistoryView::draw(const CommandHistory& history, bool scrollToBottom) {
+    if (m_historyId != history.getId()) {
+        m_historyId = history.getId();
+        m_matches.clear();
+        m_scanSequence = history.getFirstSequence();
+        m_scrollPending = true;
+    }
+    updateMatches(history);
+    
+    // 滚动位置来自上一帧的布局；在底部时每帧都贴底，新行出现后仍停留在底部
+    bool atBottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+    
+    // 只提交可见的行，其余行由clipper按行高占位，滚动条长度与逐行绘制时一致
+    std::uint64_t firstSequence = history.getFirstSequence();
+    std::size_t rowCount = isSearching() ? m_matches.size() : history.size();
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(rowCount));
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            std::size_t index = isSearching() ? static_cast<std::size_t>(m_matches[row] - firstSequence) : static_cast<std::size_t>(row);
+            std::string_view line = history[index];
+            ImGui::TextUnformatted(line.data(), line.data() + line.size());
+        }
+    }
+    clipper.End();
+    
+    // clipper结束后光标位于全部行之后，SetScrollHereY(1.0f)会滚动到真正的末尾
+    if (scrollToBottom || m_scrollPending || atBottom) {
+        ImGui::SetScrollHereY(1.0f);
+        m_scrollPending = false;
+    }
+}
+
+// 绘制搜索框
+void CommandHistoryView::drawSearchInput(const char* hint, float width) {
+    ImGui::PushItemWidth(width);
+    if (ImGui::InputTextWithHint(kSearchInputId, hint, m_searchBuffer.data(), m_searchBuffer.size())) {
+        // 搜索内容变化后从最旧的行重新检查
+        m_query.assign(m_searchBuffer.data());
+        std::transform(m_query.begin(), m_query.end(), m_query.begin(), ::tolower);
+        m_matches.clear();
+        m_scanSequence = 0;
+        m_scrollPending = true;
+    }
+    ImGui::PopItemWidth();
+}
+
+// 丢弃已不在历史中的匹配，并继续检查未检查过的行
+void CommandHistoryView::updateMatches(const CommandHistory& history) {
+    if (!isSearching()) {
+        return;
+    }
+    
+    std::uint64_t firstSequence = history.getFirstSequence();
+    while (!m_matches.empty() && m_matches.front() < firstSequence) {
+        m_matches.pop_front();
+    }
+    
+    // 新追加的行与尚未检查完的旧行共用每帧的检查额度
+    m_scanSequence = std::max(m_scanSequence, firstSequence);
+    std::uint64_t endSequence = std::min<std::uint64_t>(history.getEndSequence(), m_scanSequence + kScanLinesPerFrame);
+    for (; m_scanSequence < endSequence; ++m_scanSequence) {
+        if (matches(history[static_cast<std::size_t>(m_scanSequence - firstSequence)])) {
+            m_matches.push_back(m_scanSequence);
+        }
+    }
+}
+
+// 行中是否包含搜索内容
+bool CommandHistoryView::matches(std::string_view line) const {
+    auto it = std::search(line.begin(), line.end(), m_query.begin(), m_query.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+    return it != line.end();
+}
+
+} // namespace tch
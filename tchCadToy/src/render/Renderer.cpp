@@ -1,5 +1,6 @@
 #include "render/Renderer.h"
 #include "file/FileManager.h"
+#include "render/CommandHistoryView.h"
 #include "Layer.h"
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -9,6 +10,8 @@
 #include "debug/Logger.h"
 #include "utils/LocalizationManager.h"
 #include "command/CommandParser.h"
+#include "command/BackgroundCommand.h"
+#include "command/InteractiveTool.h"
 #include "input/InputHandler.h"
 #include <algorithm>
 #include <array>
@@ -55,6 +58,7 @@ static bool s_commandBarVisible = true; // 命令栏是否可见
 static float s_commandBarHeight = 150.0f; // 命令栏高度
 static std::array<char, 256> s_cmdBuffer{}; // 命令输入缓冲区
 static std::string s_commandPendingToBeExecuted; // 待执行的新命令
+static CommandHistoryView s_commandHistoryView; // 命令历史视图
 
 
 // 选项对话框相关
@@ -70,9 +74,6 @@ static bool s_metricsWindowVisible = false;  // Metrics/Debugger窗口是否可
 
 // 文件栏相关 - 使用FileManager类管理
 
-// 逻辑视口初始化
-LogicalViewport Renderer::s_logicalViewport;
-
 // 初始化渲染器
 void Renderer::initialize(GLFWwindow* window) {
     s_window = window;
@@ -86,9 +87,6 @@ void Renderer::initialize(GLFWwindow* window) {
     glfwGetFramebufferSize(window, &width, &height);
     setViewport(width, height);
     
-    // 初始化逻辑视口
-    s_logicalViewport.initialize(width, height);
-    
     // 设置坐标原点为窗口中心
     s_originX = width / 2.0f;
     s_originY = height / 2.0f;
@@ -105,6 +103,9 @@ void Renderer::initialize(GLFWwindow* window) {
     
     // 初始化文件管理器
     FileManager::initialize();
+    
+    // 初始化当前文档的逻辑视口
+    getLogicalViewport().initialize(width, height);
 }
 
 // 清理渲染器
@@ -154,8 +155,10 @@ void Renderer::updateDrawableArea() {
     left = std::max(0, std::min(left, width - 1));
     right = std::max(1, std::min(right, width));
     
-    // 更新逻辑视口的可绘制区域
-    s_logicalViewport.setDrawableArea(left, top, right, bottom);
+    // 更新逻辑视口的可绘制区域；每个文档有独立视口，切换标签页后在此同步窗口大小
+    LogicalViewport& viewport = getLogicalViewport();
+    viewport.setWindowSize(width, height);
+    viewport.setDrawableArea(left, top, right, bottom);
 }
 
 // 开始渲染
@@ -232,7 +235,7 @@ void Renderer::updateViewport(int width, int height) {
     setViewport(width, height);
     
     // 更新逻辑视口的窗口大小
-    s_logicalViewport.setWindowSize(width, height);
+    getLogicalViewport().setWindowSize(width, height);
 }
 
 // 绘制所有图形
@@ -251,8 +254,8 @@ void Renderer::drawAll() {
         drawAxes();
     }
     
-    // 绘制所有图层
-    LayerManager::getInstance().draw();
+    // 绘制当前文档的所有图层
+    FileManager::getCurrentDocument().getLayerManager().draw();
 }
 
 // 获取渲染器状态
@@ -267,12 +270,12 @@ void Renderer::drawCursor(const glm::vec2& position) {
     }
     
     // 检查鼠标位置是否在可绘制区域内
-    bool isInDrawableArea = s_logicalViewport.isPointInDrawableArea(position);
+    bool isInDrawableArea = getLogicalViewport().isPointInDrawableArea(position);
     
     // 只有当鼠标在可绘制区域内时，才更新光标位置
     if (isInDrawableArea) {
         // 更新当前光标位置（使用逻辑视口转换）
-        glm::dvec3 logicPos = s_logicalViewport.screenToLogic(position);
+        glm::dvec3 logicPos = getLogicalViewport().screenToLogic(position);
         s_cursorPosition = logicPos;
     }
     
@@ -303,7 +306,7 @@ void Renderer::drawCursor(const glm::vec2& position) {
         cursorScreenPos = position;
     } else {
         // 如果鼠标不在可绘制区域内，使用逻辑光标位置转换到屏幕坐标
-        cursorScreenPos = s_logicalViewport.logicToScreen(s_cursorPosition);
+        cursorScreenPos = getLogicalViewport().logicToScreen(s_cursorPosition);
     }
     
     // 绘制拾取框
@@ -389,15 +392,15 @@ void Renderer::drawGrid() {
     glDisable(GL_DEPTH_TEST);
     
     // 获取逻辑视口边界
-    glm::dvec2 logicMin = s_logicalViewport.getLogicMin();
-    glm::dvec2 logicMax = s_logicalViewport.getLogicMax();
+    glm::dvec2 logicMin = getLogicalViewport().getLogicMin();
+    glm::dvec2 logicMax = getLogicalViewport().getLogicMax();
     
     // 计算逻辑视口的宽度和高度
     double logicWidth = logicMax.x - logicMin.x;
     double logicHeight = logicMax.y - logicMin.y;
     
     // 获取可绘制区域大小
-    glm::ivec2 drawableSize = s_logicalViewport.getDrawableAreaSize();
+    glm::ivec2 drawableSize = getLogicalViewport().getDrawableAreaSize();
     int drawableWidth = drawableSize.x;
     int drawableHeight = drawableSize.y;
     
@@ -466,17 +469,17 @@ void Renderer::drawGrid() {
     
     // 绘制垂直线
     for (double x = startX; x <= logicMax.x; x += subGridSize) {
-        glm::vec2 screenPos = s_logicalViewport.logicToScreen(glm::dvec3(x, logicMin.y, 0.0));
+        glm::vec2 screenPos = getLogicalViewport().logicToScreen(glm::dvec3(x, logicMin.y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
-        screenPos = s_logicalViewport.logicToScreen(glm::dvec3(x, logicMax.y, 0.0));
+        screenPos = getLogicalViewport().logicToScreen(glm::dvec3(x, logicMax.y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
     }
     
     // 绘制水平线
     for (double y = startY; y <= logicMax.y; y += subGridSize) {
-        glm::vec2 screenPos = s_logicalViewport.logicToScreen(glm::dvec3(logicMin.x, y, 0.0));
+        glm::vec2 screenPos = getLogicalViewport().logicToScreen(glm::dvec3(logicMin.x, y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
-        screenPos = s_logicalViewport.logicToScreen(glm::dvec3(logicMax.x, y, 0.0));
+        screenPos = getLogicalViewport().logicToScreen(glm::dvec3(logicMax.x, y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
     }
     glEnd();
@@ -491,17 +494,17 @@ void Renderer::drawGrid() {
     
     // 绘制垂直线
     for (double x = mainStartX; x <= logicMax.x; x += mainGridSize) {
-        glm::vec2 screenPos = s_logicalViewport.logicToScreen(glm::dvec3(x, logicMin.y, 0.0));
+        glm::vec2 screenPos = getLogicalViewport().logicToScreen(glm::dvec3(x, logicMin.y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
-        screenPos = s_logicalViewport.logicToScreen(glm::dvec3(x, logicMax.y, 0.0));
+        screenPos = getLogicalViewport().logicToScreen(glm::dvec3(x, logicMax.y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
     }
     
     // 绘制水平线
     for (double y = mainStartY; y <= logicMax.y; y += mainGridSize) {
-        glm::vec2 screenPos = s_logicalViewport.logicToScreen(glm::dvec3(logicMin.x, y, 0.0));
+        glm::vec2 screenPos = getLogicalViewport().logicToScreen(glm::dvec3(logicMin.x, y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
-        screenPos = s_logicalViewport.logicToScreen(glm::dvec3(logicMax.x, y, 0.0));
+        screenPos = getLogicalViewport().logicToScreen(glm::dvec3(logicMax.x, y, 0.0));
         glVertex2f(screenPos.x, screenPos.y);
     }
     glEnd();
@@ -544,10 +547,10 @@ void Renderer::drawAxes() {
     
     // 获取可绘制区域边界
     int drawableLeft, drawableTop, drawableRight, drawableBottom;
-    s_logicalViewport.getDrawableArea(drawableLeft, drawableTop, drawableRight, drawableBottom);
+    getLogicalViewport().getDrawableArea(drawableLeft, drawableTop, drawableRight, drawableBottom);
     
     // 计算逻辑原点在屏幕上的位置
-    glm::vec2 originScreenPos = s_logicalViewport.logicToScreen(glm::dvec3(0.0, 0.0, 0.0));
+    glm::vec2 originScreenPos = getLogicalViewport().logicToScreen(glm::dvec3(0.0, 0.0, 0.0));
     float originScreenX = originScreenPos.x;
     float originScreenY = originScreenPos.y;
     
@@ -605,28 +608,28 @@ glm::vec2 Renderer::getOrigin() {
 
 void Renderer::zoomIn() {
     // 使用逻辑视口进行缩放
-    s_logicalViewport.zoomIn();
+    getLogicalViewport().zoomIn();
 }
 
 void Renderer::zoomOut() {
     // 使用逻辑视口进行缩放
-    s_logicalViewport.zoomOut();
+    getLogicalViewport().zoomOut();
 }
 
 void Renderer::zoomIn(const glm::vec2& mousePos) {
     // 使用逻辑视口进行缩放，以鼠标位置为中心
-    s_logicalViewport.zoomIn(mousePos);
+    getLogicalViewport().zoomIn(mousePos);
 }
 
 void Renderer::zoomOut(const glm::vec2& mousePos) {
     // 使用逻辑视口进行缩放，以鼠标位置为中心
-    s_logicalViewport.zoomOut(mousePos);
+    getLogicalViewport().zoomOut(mousePos);
 }
 
 // 平移功能
 void Renderer::pan(const glm::dvec2& deltaLogic) {
     // 使用逻辑视口进行平移
-    s_logicalViewport.pan(deltaLogic);
+    getLogicalViewport().pan(deltaLogic);
 }
 
 // 初始化ImGui
@@ -725,6 +728,19 @@ void Renderer::drawStatusBar(const glm::vec2& cursorPos) {
     if (ImGui::Begin("StatusBar", nullptr, flags)) {
         // 直接使用已保存的光标位置（以窗口中央为原点的坐标系）
         ImGui::Text("%.4f, %.4f, %.4f", s_cursorPosition.x, s_cursorPosition.y, s_cursorPosition.z);
+        
+        // 后台命令的进度
+        if (BackgroundCommand::isRunning()) {
+            ImGui::SameLine();
+            ImGui::ProgressBar(BackgroundCommand::getProgress(), ImVec2(ImGui::GetFontSize() * 16.0f, 0.0f), BackgroundCommand::getName().c_str());
+        }
+        
+        // 等待下一个键的多键快捷键
+        const Keymap& keymap = InputHandler::getKeymap();
+        if (keymap.isPending()) {
+            ImGui::SameLine();
+            ImGui::Text("(%s) was pressed. Waiting for second key of chord...", keymap.getPendingKeys().c_str());
+        }
         ImGui::End();
     }
 }
@@ -748,7 +764,7 @@ void Renderer::drawOptionsDialog() {
         
         if (ImGui::BeginPopupModal("Options", &s_optionsDialogVisible, flags)) {
             // 对话框标题
-            ImGui::Text(loc.get("optionsDialog.title").c_str());
+            ImGui::TextUnformatted(loc.get(LocKey::OptionsDialogTitle).data());
             ImGui::Separator();
             
             // 对话框内容
@@ -760,21 +776,21 @@ void Renderer::drawOptionsDialog() {
             // 创建选项卡栏
             if (ImGui::BeginTabBar("OptionsTabs")) {
                 // 第一个选项卡：显示
-                if (ImGui::BeginTabItem(loc.get("optionsDialog.tab.display").c_str())) {
+                if (ImGui::BeginTabItem(loc.get(LocKey::OptionsDialogTabDisplay).data())) {
                     // Grid & Axes 标题
-                    ImGui::Text(loc.get("optionsDialog.gridAxes").c_str());
+                    ImGui::TextUnformatted(loc.get(LocKey::OptionsDialogGridAxes).data());
                     ImGui::Spacing();
                     
                     // 选项
-                    ImGui::Checkbox(loc.get("optionsDialog.showGrid").c_str(), &showGrid);
-                    ImGui::Checkbox(loc.get("optionsDialog.showAxes").c_str(), &showAxes);
+                    ImGui::Checkbox(loc.get(LocKey::OptionsDialogShowGrid).data(), &showGrid);
+                    ImGui::Checkbox(loc.get(LocKey::OptionsDialogShowAxes).data(), &showAxes);
                     
                     // 在十字光标大小设置前添加分隔线，与前面的栅格坐标轴设置分开
                     ImGui::Separator();
                     
                     // 十字光标大小
                     ImGui::Spacing();
-                    ImGui::Text(loc.get("optionsDialog.crossCursorSize").c_str());
+                    ImGui::TextUnformatted(loc.get(LocKey::OptionsDialogCrossCursorSize).data());
                     ImGui::Spacing();
                     
                     // 滑块控件，范围5-100，使用整数，长度设为500
@@ -786,10 +802,10 @@ void Renderer::drawOptionsDialog() {
                 }
                 
                 // 第二个选项卡：选择集
-                if (ImGui::BeginTabItem(loc.get("optionsDialog.tab.selection").c_str())) {
+                if (ImGui::BeginTabItem(loc.get(LocKey::OptionsDialogTabSelection).data())) {
                     // 选择框大小
                     ImGui::Spacing();
-                    ImGui::Text(loc.get("optionsDialog.pickBoxSize").c_str());
+                    ImGui::TextUnformatted(loc.get(LocKey::OptionsDialogPickBoxSize).data());
                     ImGui::Spacing();
                     
                     // 首先绘制预览框
@@ -828,14 +844,14 @@ void Renderer::drawOptionsDialog() {
                 }
                 
                 // 第三个选项卡：语言
-                if (ImGui::BeginTabItem(loc.get("optionsDialog.tab.language").c_str())) {
+                if (ImGui::BeginTabItem(loc.get(LocKey::OptionsDialogTabLanguage).data())) {
                     // 语言选择
                     ImGui::Spacing();
-                    ImGui::Text(loc.get("optionsDialog.language").c_str());
+                    ImGui::TextUnformatted(loc.get(LocKey::OptionsDialogLanguage).data());
                     ImGui::Spacing();
                     
                     // 获取当前语言
-                    std::string currentLanguage = loc.getCurrentLanguage();
+                    const std::string& currentLanguage = loc.getCurrentLanguage();
                     
                     // 语言选择下拉框，显示固定的语言选项
                     if (ImGui::BeginCombo("##LanguageSelect", (currentLanguage == "en" ? "English" : "中文"))) {
@@ -877,7 +893,7 @@ void Renderer::drawOptionsDialog() {
             ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 170);
             
             // 确定按钮
-            if (ImGui::Button(loc.get("optionsDialog.ok").c_str(), ImVec2(80, 30))) {
+            if (ImGui::Button(loc.get(LocKey::OptionsDialogOk).data(), ImVec2(80, 30))) {
                 // 应用设置
                 s_showGrid = showGrid;
                 s_showAxes = showAxes;
@@ -889,7 +905,7 @@ void Renderer::drawOptionsDialog() {
             
             // 取消按钮
             ImGui::SameLine();
-            if (ImGui::Button(loc.get("optionsDialog.cancel").c_str(), ImVec2(80, 30))) {
+            if (ImGui::Button(loc.get(LocKey::OptionsDialogCancel).data(), ImVec2(80, 30))) {
                 // 不应用设置，直接关闭对话框
                 ImGui::CloseCurrentPopup();
                 s_optionsDialogVisible = false;
@@ -905,72 +921,72 @@ void Renderer::drawMenuBar() {
     auto& loc = LocalizationManager::getInstance();
     if (ImGui::BeginMainMenuBar()) {
         // File菜单
-        if (ImGui::BeginMenu(loc.get("menu.file").c_str())) {
-            if (ImGui::MenuItem(loc.get("menu.file.new").c_str(), "Ctrl+N")) {
+        if (ImGui::BeginMenu(loc.get(LocKey::MenuFile).data())) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuFileNew).data(), "Ctrl+N")) {
                 CommandParser::executeCommand("new", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.file.open").c_str(), "Ctrl+O")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuFileOpen).data(), "Ctrl+O")) {
                 CommandParser::executeCommand("open", {});
             }
-            ImGui::MenuItem(loc.get("menu.file.openRecent").c_str());
-            if (ImGui::MenuItem(loc.get("menu.file.save").c_str(), "Ctrl+S")) {
+            ImGui::MenuItem(loc.get(LocKey::MenuFileOpenRecent).data());
+            if (ImGui::MenuItem(loc.get(LocKey::MenuFileSave).data(), "Ctrl+S")) {
                 CommandParser::executeCommand("save", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.file.saveAs").c_str(), "Ctrl+Shift+S")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuFileSaveAs).data(), "Ctrl+Shift+S")) {
                 CommandParser::executeCommand("saveas", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.file.close").c_str(), "Ctrl+W")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuFileClose).data(), "Ctrl+W")) {
                 CommandParser::executeCommand("close", {});
             }
             ImGui::Separator();
-            if (ImGui::MenuItem(loc.get("menu.file.quit").c_str(), "Ctrl+Q")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuFileQuit).data(), "Ctrl+Q")) {
                 CommandParser::executeCommand("quit", {});
             }
             ImGui::EndMenu();
         }
         
         // Edit菜单
-        if (ImGui::BeginMenu(loc.get("menu.edit").c_str())) {
-            if (ImGui::MenuItem(loc.get("menu.edit.undo").c_str(), "Ctrl+Z")) {
+        if (ImGui::BeginMenu(loc.get(LocKey::MenuEdit).data())) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditUndo).data(), "Ctrl+Z")) {
                 CommandParser::executeCommand("undo", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.edit.redo").c_str(), "Ctrl+Y")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditRedo).data(), "Ctrl+Y")) {
                 CommandParser::executeCommand("redo", {});
             }
             ImGui::Separator();
-            if (ImGui::MenuItem(loc.get("menu.edit.cut").c_str(), "Ctrl+X")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditCut).data(), "Ctrl+X")) {
                 CommandParser::executeCommand("cut", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.edit.copy").c_str(), "Ctrl+C")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditCopy).data(), "Ctrl+C")) {
                 CommandParser::executeCommand("copy", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.edit.paste").c_str(), "Ctrl+V")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditPaste).data(), "Ctrl+V")) {
                 CommandParser::executeCommand("paste", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.edit.selectAll").c_str(), "Ctrl+A")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditSelectAll).data(), "Ctrl+A")) {
                 CommandParser::executeCommand("selectall", {});
             }
-            if (ImGui::MenuItem(loc.get("menu.edit.erase").c_str(), "Del")) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuEditErase).data(), "Del")) {
                 CommandParser::executeCommand("erase", {});
             }
             ImGui::EndMenu();
         }
         
         // Tools菜单
-        if (ImGui::BeginMenu(loc.get("menu.tools").c_str())) {
-            if (ImGui::MenuItem(loc.get("menu.tools.options").c_str())) {
+        if (ImGui::BeginMenu(loc.get(LocKey::MenuTools).data())) {
+            if (ImGui::MenuItem(loc.get(LocKey::MenuToolsOptions).data())) {
                 // 执行OPTIONS命令
                 Renderer::showOptionsDialog(true);
             }
-            ImGui::MenuItem(loc.get("menu.tools.properties").c_str(), nullptr, &s_propertyBarVisible);
+            ImGui::MenuItem(loc.get(LocKey::MenuToolsProperties).data(), nullptr, &s_propertyBarVisible);
             ImGui::Separator();
-            ImGui::MenuItem(loc.get("menu.tools.demo").c_str(), nullptr, &s_demoWindowVisible);
-            ImGui::MenuItem(loc.get("menu.tools.metrics").c_str(), nullptr, &s_metricsWindowVisible);
+            ImGui::MenuItem(loc.get(LocKey::MenuToolsDemo).data(), nullptr, &s_demoWindowVisible);
+            ImGui::MenuItem(loc.get(LocKey::MenuToolsMetrics).data(), nullptr, &s_metricsWindowVisible);
             ImGui::EndMenu();
         }
         
         // Language菜单
-        if (ImGui::BeginMenu(loc.get("menu.language").c_str())) {
+        if (ImGui::BeginMenu(loc.get(LocKey::MenuLanguage).data())) {
             if (ImGui::MenuItem("English", nullptr, loc.getCurrentLanguage() == "en")) {
                 loc.setLanguage("en");
             }
@@ -1014,8 +1030,10 @@ void Renderer::drawPropertyBar() {
                              ImGuiWindowFlags_NoBringToFrontOnFocus;
     
     auto& loc = LocalizationManager::getInstance();
-    // 使用ImGui的命名机制，##前面的内容显示在界面上，##后面的内容作为内部标识符
-    std::string windowName = loc.get("propertyBar.title") + "##PropertyBar";
+    // 使用ImGui的命名机制，##前面的内容显示在界面上，##后面的内容作为内部标识符；复用缓冲区，每帧不分配内存
+    static std::string windowName;
+    windowName.assign(loc.get(LocKey::PropertyBarTitle));
+    windowName += "##PropertyBar";
     if (ImGui::Begin(windowName.c_str(), &s_propertyBarVisible, flags)) {
         // 预留空白区域，等待添加实际属性
         
@@ -1123,7 +1141,7 @@ void Renderer::drawFileBar() {
 
 // 获取逻辑视口
 LogicalViewport& Renderer::getLogicalViewport() {
-    return s_logicalViewport;
+    return FileManager::getCurrentDocument().getViewport();
 }
 
 // 绘制命令栏
@@ -1159,40 +1177,20 @@ void Renderer::drawCommandBar() {
         const float footerReserveHeight = ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
         ImGui::BeginChild("CommandHistory", ImVec2(0, -footerReserveHeight), false, ImGuiWindowFlags_HorizontalScrollbar);
         
-        // TODO：使用ImGuiListClipper会导致滚动条的行为变得奇怪，无法自动滚动到末尾，暂不使用
-        // // 使用静态的ImGuiListClipper来优化渲染，只绘制可见区域，提升历史条目过多时的性能
-        // static ImGuiListClipper clipper;
-        // float itemHeight = ImGui::GetTextLineHeight();
-        // clipper.Begin(s_commandHistory.size(), itemHeight);
+        // 只绘制可见的历史行，搜索时只列出匹配的行
+        s_commandHistoryView.draw(FileManager::getCurrentFileCommandHistory(), s_bScrollCommandHistoryToBottom);
+        s_bScrollCommandHistoryToBottom = false;
         
-        // while (clipper.Step()) {
-        //     for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
-        //         // 绘制每一条命令历史
-        //         ImGui::TextUnformatted(s_commandHistory[i].c_str());
-        //     }
-        // }
-        // clipper.End();
-        
-        const auto& commandHistory = FileManager::getCurrentFileCommandHistory();
-        for (std::size_t i = 0; i < commandHistory.size(); i++)
-        {
-            ImGui::TextUnformatted(commandHistory[i].c_str());
-        }
-        
-        // 根据标志决定是否滚动到最后，在绘制项目之前执行
-        if (!commandHistory.empty() && s_bScrollCommandHistoryToBottom) {
-            ImGui::SetScrollHereY(1.0f);
-            s_bScrollCommandHistoryToBottom = false;
-        }
-
         ImGui::EndChild();
-
+        
         // 命令输入栏部分
         ImGui::Separator();
         
-        // 调整布局：Command提示在左边，上下居中，输入框占满剩余空间
+        // 调整布局：Command提示在左边，上下居中，输入框占满剩余空间；交互工具等待输入时显示工具的提示
+        // 拷贝一份提示：取消交互工具时会清除工具的提示，而取消记录还要用到它
+        std::string prompt(ToolScheduler::getPrompt().empty() ? loc.get(LocKey::CommandBarPrompt) : std::string_view(ToolScheduler::getPrompt()));
         ImGui::AlignTextToFramePadding();
-        ImGui::Text(loc.get("commandBar.prompt").c_str());
+        ImGui::TextUnformatted(prompt.c_str());
         ImGui::SameLine();
         
         // 如果需要设置焦点到命令输入框
@@ -1201,16 +1199,21 @@ void Renderer::drawCommandBar() {
             s_bShouldFocusOnCommandInput = false;
         }
         
-        // 使用PushItemWidth使输入框占满剩余空间
-        ImGui::PushItemWidth(-1);
+        // 使用PushItemWidth使输入框占满搜索框左侧的剩余空间
+        const float searchWidth = ImGui::GetFontSize() * 12.0f;
+        ImGui::PushItemWidth(-(searchWidth + ImGui::GetStyle().ItemSpacing.x));
         
         // 检查是否需要取消命令
         if (s_bShouldCancelCommand) {
+            // Esc同时取消正在执行的后台命令与交互工具
+            BackgroundCommand::cancel();
+            ToolScheduler::cancel();
             // 取消命令执行，在命令历史中添加取消标记
             std::string command(s_cmdBuffer.data());
             // 使用localization资源构建取消命令的历史记录
-            std::string promptStr = loc.get("commandBar.prompt") + " " + command + loc.get("commandBar.prompt.cancel");
-            addContentToCommandHistory(promptStr);
+            addContentToCommandHistory({prompt, " ", command, loc.get(LocKey::CommandBarPromptCancel)});
+            // 用户执行命令时总是滚动到底部
+            s_bScrollCommandHistoryToBottom = true;
             s_bShouldCancelCommand = false;
             s_bShouldExecuteCommand = false;
             // 清空缓冲区
@@ -1226,9 +1229,11 @@ void Renderer::drawCommandBar() {
             s_bShouldExecuteCommand = false;
             // 执行命令
             std::string command(s_cmdBuffer.data());
-            std::string promptStr = loc.get("commandBar.prompt") + " " + command;
-            addContentToCommandHistory(promptStr);
-            if (!command.empty()) {
+            addContentToCommandHistory({prompt, " ", command});
+            // 用户执行命令时总是滚动到底部
+            s_bScrollCommandHistoryToBottom = true;
+            // 交互工具等待输入时输入交给工具（空输入结束工具），否则作为命令执行
+            if (!ToolScheduler::submitText(command) && !command.empty()) {
                 CommandParser::parseCommand(command);
             }
             // 清空缓冲区
@@ -1236,13 +1241,14 @@ void Renderer::drawCommandBar() {
             // 设置清除命令输入缓冲区的标记，因为内部ImGui内部会维护InputText的状态，所以回调中还需要再清除一次
             s_bNeedClearCommandBuffer = true;
         }
-
+        
         // 处理通过pushCommandToExecute推送的命令
         if (!s_commandPendingToBeExecuted.empty()) {
             // 执行待执行的命令
             std::string command = s_commandPendingToBeExecuted;
-            std::string promptStr = loc.get("commandBar.prompt") + " " + command;
-            addContentToCommandHistory(promptStr);
+            addContentToCommandHistory({loc.get(LocKey::CommandBarPrompt), " ", command});
+            // 用户执行命令时总是滚动到底部
+            s_bScrollCommandHistoryToBottom = true;
             if (!command.empty()) {
                 CommandParser::parseCommand(command);
             }
@@ -1263,6 +1269,33 @@ void Renderer::drawCommandBar() {
                     return 1;
                 }
             }
+            // Tab补全命令名，空格会直接执行命令，所以缓冲区中只有命令名本身
+            if (data->EventFlag == ImGuiInputTextFlags_CallbackCompletion) {
+                std::string prefix(data->Buf, data->BufTextLen);
+                auto candidates = CommandParser::completeCommand(prefix);
+                if (!candidates.empty()) {
+                    // 补全到所有候选的公共前缀
+                    std::string common = candidates.front();
+                    for (const auto& candidate : candidates) {
+                        std::size_t length = 0;
+                        while (length < common.size() && length < candidate.size() && common[length] == candidate[length]) {
+                            ++length;
+                        }
+                        common.resize(length);
+                    }
+                    if (common.size() > prefix.size()) {
+                        data->DeleteChars(0, data->BufTextLen);
+                        data->InsertChars(0, common.c_str());
+                    } else if (candidates.size() > 1) {
+                        // 无法继续补全时列出全部候选
+                        std::string line;
+                        for (const auto& candidate : candidates) {
+                            line += (line.empty() ? "" : "  ") + candidate;
+                        }
+                        addContentToCommandHistory(line);
+                    }
+                }
+            }
             if (data->EventFlag == ImGuiInputTextFlags_CallbackAlways) {
                 // 命令输入缓冲区被修改，那么就解除选中并移动光标到末尾
                 if (s_bCommandBufferModified) {
@@ -1283,9 +1316,9 @@ void Renderer::drawCommandBar() {
             }
             return 0;
         };
-
-        ImGui::InputTextWithHint("##CommandInput", loc.get("commandBar.inputPrompt").c_str(), s_cmdBuffer.data(), s_cmdBuffer.size(), 
-            ImGuiInputTextFlags_CallbackAlways | ImGuiInputTextFlags_CallbackCharFilter, 
+        
+        ImGui::InputTextWithHint("##CommandInput", loc.get(LocKey::CommandBarInputPrompt).data(), s_cmdBuffer.data(), s_cmdBuffer.size(), 
+            ImGuiInputTextFlags_CallbackAlways | ImGuiInputTextFlags_CallbackCharFilter | ImGuiInputTextFlags_CallbackCompletion, 
             inputTextCallback, nullptr);
         
         // 回车或者空格执行后强制把焦点拉回来，防止输入框失焦
@@ -1296,6 +1329,10 @@ void Renderer::drawCommandBar() {
         // 平衡PushItemWidth调用
         ImGui::PopItemWidth();
         
+        // 命令历史搜索框
+        ImGui::SameLine();
+        s_commandHistoryView.drawSearchInput(loc.get(LocKey::CommandBarSearchPrompt).data(), searchWidth);
+        
         ImGui::End();
     }
     
@@ -1355,11 +1392,14 @@ void Renderer::drawCommandBar() {
     }
 }
 
-// 添加内容到命令历史记录
-void Renderer::addContentToCommandHistory(const std::string& command) {
+// 添加内容到命令历史记录，历史视图停留在底部时会跟随新内容滚动，用户向上翻看时不打断
+void Renderer::addContentToCommandHistory(std::string_view command) {
     FileManager::addToCurrentFileCommandHistory(command);
-    // 设置滚动标志为true，确保新命令添加后会滚动到最底部
-    s_bScrollCommandHistoryToBottom = true;
+}
+
+// 把几段文本拼接为一行添加到命令历史记录，不生成临时字符串
+void Renderer::addContentToCommandHistory(std::initializer_list<std::string_view> parts) {
+    FileManager::addToCurrentFileCommandHistory(parts);
 }
 
 // 设置是否应该将焦点设置到命令输入框
@@ -1437,6 +1477,12 @@ bool Renderer::FocusIsOnWindow(const std::string& windowName) {
     return false;
 }
 
+// 检查焦点是否在命令历史搜索框上
+bool Renderer::FocusIsOnHistorySearch() {
+    ImGuiWindow* window = ImGui::FindWindowByName("CommandBar");
+    return window && ImGui::GetActiveID() == window->GetID(CommandHistoryView::kSearchInputId);
+}
+
 // 检查焦点是否在命令输入框上
 bool Renderer::FocusIsOnCommandInput() {
     // 获取当前活跃控件的ID
@@ -0,0 +1,81 @@
+#include "sys/LaunchOptions.h"
+#include <format>
+#include <string_view>
+
+namespace tch {
+
+// 解析命令行参数
+bool parseLaunchOptions(int argc, char* argv[], LaunchOptions& options, std::string& error) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        
+        // 带值的参数
+        if (arg == "--script" || arg == "--output" || arg == "--socket" || arg == "--record" || arg == "--replay" ||
+            arg == "--binary-log") {
+            if (i + 1 >= argc) {
+                error = std::format("Missing value for {}", arg);
+                return false;
+            }
+            std::string& value = arg == "--script" ? options.scriptPath : arg == "--output" ? options.outputPath :
+                                 arg == "--socket" ? options.socketPath : arg == "--record" ? options.recordPath :
+                                 arg == "--replay" ? options.replayPath : options.binaryLogPath;
+            value = argv[++i];
+        } else if (arg == "--replay-speed") {
+            std::string_view speed = i + 1 < argc ? std::string_view(argv[++i]) : std::string_view();
+            if (speed != "original" && speed != "max") {
+                error = "--replay-speed must be original or max";
+                return false;
+            }
+            options.replayMaxSpeed = speed == "max";
+        } else if (arg == "--exit-after-replay") {
+            options.exitAfterReplay = true;
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--serve") {
+            options.serve = true;
+        } else {
+            error = std::format("Unknown option: {}", arg);
+            return false;
+        }
+    }
+    
+    // --socket隐含--serve
+    if (!options.socketPath.empty()) {
+        options.serve = true;
+    }
+    if (options.serve && (!options.scriptPath.empty() || options.headless)) {
+        error = "--serve cannot be combined with --script or --headless";
+        return false;
+    }
+    if (options.headless && options.scriptPath.empty()) {
+        error = "--headless requires --script";
+        return false;
+    }
+    if (!options.outputPath.empty() && options.scriptPath.empty()) {
+        error = "--output requires --script";
+        return false;
+    }
+    if ((!options.recordPath.empty() || !options.replayPath.empty()) && (options.serve || options.headless)) {
+        error = "--record and --replay cannot be combined with --serve or --headless";
+        return false;
+    }
+    if (!options.recordPath.empty() && !options.replayPath.empty()) {
+        error = "--record cannot be combined with --replay";
+        return false;
+    }
+    if ((options.replayMaxSpeed || options.exitAfterReplay) && options.replayPath.empty()) {
+        error = "--replay-speed and --exit-after-replay require --replay";
+        return false;
+    }
+    return true;
+}
+
+// 获取命令行用法说明
+std::string launchUsage(const char* exeName) {
+    return std::format("Usage: {0} [--script FILE.scr [--headless] [--output FILE.json|.dxf|.svg]]\n"
+                       "       {0} [--script FILE.scr] [--record FILE | --replay FILE [--replay-speed original|max] [--exit-after-replay]]\n"
+                       "       {0} --serve [--socket PATH]\n"
+                       "       every form also accepts --binary-log FILE", exeName);
+}
+
+} // namespace tch
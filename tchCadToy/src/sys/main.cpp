@@ -2,16 +2,77 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include "input/InputHandler.h"
+#include "input/InputRecorder.h"
 #include "render/Renderer.h"
+#include "command/AutomationServer.h"
+#include "command/BackgroundCommand.h"
+#include "command/InteractiveTool.h"
 #include "command/CommandParser.h"
+#include "command/ScriptRunner.h"
+#include "file/FileManager.h"
 #include "debug/Logger.h"
 #include "sys/Global.h"
+#include "sys/LaunchOptions.h"
+#include <algorithm>
+#include <filesystem>
+#include <format>
 #include <iostream>
 
 using namespace tch;
 
+// 脚本执行后保存（.json）或导出（.dxf/.svg）当前文件
+static bool writeScriptOutput(const std::string& outputPath)
+{
+    std::string extension = std::filesystem::path(outputPath).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    const char* command = (extension == ".dxf" || extension == ".svg") ? "EXPORT" : "SAVEAS";
+    return CommandParser::executeCommand(command, {outputPath});
+}
+
+// 无界面模式：不创建窗口与GL上下文，执行脚本并保存结果后退出
+static int runHeadless(const LaunchOptions& options)
+{
+    FileManager::initialize();
+    
+    ScriptResult result;
+    bool success = ScriptRunner::runFile(options.scriptPath, result);
+    for (const auto& failure : result.failures) {
+        std::cerr << std::format("{}:{}: {} -> {}", options.scriptPath, failure.line, failure.command, failure.message) << std::endl;
+    }
+    if (result.failedCommands > result.failures.size()) {
+        std::cerr << std::format("... and {} more failed commands", result.failedCommands - result.failures.size()) << std::endl;
+    }
+    std::cout << result.summary() << std::endl;
+    
+    if (!options.outputPath.empty() && !writeScriptOutput(options.outputPath)) {
+        std::cerr << "Failed to write output: " << options.outputPath << std::endl;
+        return 1;
+    }
+    return success ? 0 : 1;
+}
+
 int main(int argc, char* argv[])
 {
+    // 解析命令行参数
+    LaunchOptions options;
+    std::string optionError;
+    if (!parseLaunchOptions(argc, argv, options, optionError)) {
+        std::cerr << optionError << std::endl << launchUsage(argv[0]) << std::endl;
+        return 1;
+    }
+    
+    // 通过标准输出应答的自动化服务把日志改写到标准错误，避免混入响应
+    if (options.serve && options.socketPath.empty()) {
+        globalLogger().removeOutputStream(std::cout);
+        globalLogger().addOutputStream(std::cerr);
+    }
+    
+    // 日志同时写入二进制文件，用tchLogDecoder还原为文本
+    if (!options.binaryLogPath.empty() && !globalLogger().openBinaryLogFile(options.binaryLogPath)) {
+        std::cerr << "Failed to open binary log: " << options.binaryLogPath << std::endl;
+        return 1;
+    }
+    
     // 系统初始化
     checkOS();
     checkSystemEndian();
@@ -42,6 +103,17 @@ int main(int argc, char* argv[])
     // 测试日志文件
     LOG_INFO("Testing log file...");
     
+    // 无界面模式执行脚本后直接退出
+    if (options.headless) {
+        return runHeadless(options);
+    }
+    
+    // 自动化服务：不创建窗口，文档只存在于内存中，由请求打开与关闭
+    if (options.serve) {
+        FileManager::initialize();
+        return options.socketPath.empty() ? AutomationServer::runStdio() : AutomationServer::runSocket(options.socketPath);
+    }
+    
     // 初始化GLFW
     LOG_INFO("Initializing GLFW...");
     if (!glfwInit()) {
@@ -87,11 +159,41 @@ int main(int argc, char* argv[])
     Renderer::initialize(window);
     LOG_INFO("Renderer initialized successfully!");
     
-    // 主循环
+    // 执行启动脚本，期间不绘制，输出在结束后统一写入命令历史
+    if (!options.scriptPath.empty()) {
+        ScriptResult result;
+        ScriptRunner::runFile(options.scriptPath, result);
+        ScriptRunner::publishToCommandHistory(result);
+        if (!options.outputPath.empty()) {
+            writeScriptOutput(options.outputPath);
+        }
+    }
+    
+    // 录制或回放输入，两者期间命令都同步执行，使回放的每一帧与录制时执行相同的命令
+    bool inputSession = false;
+    if (!options.recordPath.empty()) {
+        inputSession = InputRecorder::startRecording(window, options.recordPath);
+    } else if (!options.replayPath.empty()) {
+        inputSession = InputRecorder::startReplay(window, options.replayPath, options.replayMaxSpeed ? ReplaySpeed::Maximum : ReplaySpeed::Original);
+        if (!inputSession && options.exitAfterReplay) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+    }
+    
+    // 主循环，耗时的命令在后台执行，不带参数的绘图命令启动交互工具
     LOG_INFO("Entering main loop...");
+    BackgroundCommand::setAsyncEnabled(!inputSession);
+    ToolScheduler::setEnabled(true);
     while (!glfwWindowShouldClose(window)) {
-        // 处理事件
+        // 处理事件：GLFW回调只把事件加入输入队列，在这里合并后统一分发
         glfwPollEvents();
+        InputHandler::processEvents();
+        
+        // 提交已完成的后台命令
+        BackgroundCommand::poll();
+        
+        // 有输入时恢复交互工具
+        ToolScheduler::poll();
         
         // 开始渲染
         Renderer::beginRender();
@@ -116,10 +218,23 @@ int main(int argc, char* argv[])
         
         // 结束渲染
         Renderer::endRender();
+        
+        // 回放结束后按需退出
+        if (options.exitAfterReplay && InputRecorder::isReplayFinished()) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+    }
+    
+    // 结束录制，输出回放的帧时间统计
+    InputRecorder::stopRecording();
+    if (!options.replayPath.empty() && inputSession) {
+        std::cout << InputRecorder::getReplaySummary() << std::endl;
     }
     
     // 清理资源
     LOG_INFO("Cleaning up resources...");
+    BackgroundCommand::shutdown();
+    ToolScheduler::cancel();
     Renderer::cleanup();
     
     // 销毁窗口
@@ -3,12 +3,34 @@
 
 namespace tch {
 
+namespace {
+
+// 当前线程的输出目标，为空时输出到命令栏；各线程独立，自动化服务的工作线程互不干扰
+thread_local CmdLineSink s_cmdLineSink = nullptr;
+
+} // namespace
+
 /**
  * @brief 全局输出函数，在命令栏中输出信息
  * @param message 要输出的信息
  */
 void cmdLinePrint(const std::string& message) {
+    if (s_cmdLineSink) {
+        s_cmdLineSink(message);
+        return;
+    }
     Renderer::addContentToCommandHistory(message);
 }
 
+/**
+ * @brief 设置命令栏输出目标
+ * @param sink 新的输出目标，nullptr表示恢复输出到命令栏
+ * @return 之前的输出目标
+ */
+CmdLineSink setCmdLineSink(CmdLineSink sink) {
+    CmdLineSink previous = s_cmdLineSink;
+    s_cmdLineSink = sink;
+    return previous;
+}
+
 } // namespace tch
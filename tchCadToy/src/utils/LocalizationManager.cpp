@@ -27,6 +27,10 @@ LocalizationManager& LocalizationManager::getInstance() {
 
 // 初始化
 bool LocalizationManager::initialize() {
+    // 重新初始化时丢弃已加载的文本表
+    m_currentTable = nullptr;
+    m_languages.clear();
+    
     // 构建语言资源文件路径
     std::filesystem::path langDir = g_pathCwd / "res" / "lang";
     
@@ -36,7 +40,7 @@ bool LocalizationManager::initialize() {
         return false;
     }
     
-    // 加载英语资源
+    // 加载英语资源，其他语言缺少的键使用英文文本，因此必须最先加载
     std::filesystem::path enPath = langDir / "en.json";
     if (!loadLanguage("en", enPath.string())) {
         LOG_WARNING("Failed to load English language file: {}", enPath.string());
@@ -54,12 +58,14 @@ bool LocalizationManager::initialize() {
         return false;
     }
     
+    m_currentTable = findLanguage(m_currentLanguage);
     LOG_INFO("LocalizationManager initialized successfully. Loaded {} languages.", m_languages.size());
     return true;
 }
 
 // 清理
 void LocalizationManager::cleanup() {
+    m_currentTable = nullptr;
     m_languages.clear();
     s_instance.reset();
 }
@@ -97,59 +103,89 @@ bool LocalizationManager::loadLanguage(const std::string& langCode, const std::s
         return false;
     }
     
-    // 提取键值对
-    std::unordered_map<std::string, std::string> langMap;
+    // 按键表取出文本，多出的键不会被界面使用，给出警告便于发现拼写错误
+    std::array<std::string_view, kLocKeyCount> values{};
+    std::array<bool, kLocKeyCount> found{};
+    std::size_t blobSize = 0;
     for (auto it = doc.MemberBegin(); it != doc.MemberEnd(); ++it) {
-        if (it->name.IsString() && it->value.IsString()) {
-            std::string key = it->name.GetString();
-            std::string value = it->value.GetString();
-            langMap[key] = value;
+        if (!it->name.IsString() || !it->value.IsString()) {
+            continue;
+        }
+        std::string_view name(it->name.GetString(), it->name.GetStringLength());
+        LocKey key = findLocKey(name);
+        if (key == LocKey::Count) {
+            LOG_WARNING("Unknown localization key {} in {}", name, filePath);
+            continue;
+        }
+        std::size_t index = static_cast<std::size_t>(key);
+        if (found[index]) {
+            blobSize -= values[index].size() + 1;
+        }
+        values[index] = std::string_view(it->value.GetString(), it->value.GetStringLength());
+        found[index] = true;
+        blobSize += values[index].size() + 1;
+    }
+    
+    // 全部文本拷贝到一块内存中，拷贝完成后再建立视图，避免扩容使视图失效
+    auto table = std::make_unique<LanguageTable>();
+    table->code = langCode;
+    table->blob.reserve(blobSize);
+    std::array<std::size_t, kLocKeyCount> offsets{};
+    for (std::size_t i = 0; i < kLocKeyCount; ++i) {
+        if (found[i]) {
+            offsets[i] = table->blob.size();
+            table->blob += values[i];
+            table->blob += '\0';
+        }
+    }
+    
+    // 缺少的键使用英文文本，英文也缺少时使用键名
+    const LanguageTable* fallback = findLanguage("en");
+    std::size_t missing = 0;
+    for (std::size_t i = 0; i < kLocKeyCount; ++i) {
+        if (found[i]) {
+            table->texts[i] = std::string_view(table->blob.data() + offsets[i], values[i].size());
+        } else {
+            table->texts[i] = fallback ? fallback->texts[i] : kLocKeyNames[i];
+            ++missing;
         }
     }
+    if (missing > 0) {
+        LOG_WARNING("Language file {} is missing {} of {} keys", filePath, missing, kLocKeyCount);
+    }
     
-    // 添加到语言映射
-    m_languages[langCode] = langMap;
-    LOG_INFO("Loaded language: {} with {} entries", langCode, langMap.size());
+    // 添加到语言列表
+    LOG_INFO("Loaded language: {} with {} entries", langCode, kLocKeyCount - missing);
+    m_languages.push_back(std::move(table));
     return true;
 }
 
+// 查找已加载的语言
+const LocalizationManager::LanguageTable* LocalizationManager::findLanguage(std::string_view langCode) const {
+    for (const auto& table : m_languages) {
+        if (table->code == langCode) {
+            return table.get();
+        }
+    }
+    return nullptr;
+}
+
 // 设置当前语言
 void LocalizationManager::setLanguage(const std::string& langCode) {
-    if (m_languages.find(langCode) != m_languages.end()) {
+    if (const LanguageTable* table = findLanguage(langCode)) {
         m_currentLanguage = langCode;
+        m_currentTable = table;
         LOG_INFO("Switched to language: {}", langCode);
     } else {
         LOG_WARNING("Language not found: {}", langCode);
     }
 }
 
-// 获取当前语言
-std::string LocalizationManager::getCurrentLanguage() {
-    return m_currentLanguage;
-}
-
-// 获取本地化文本
-std::string LocalizationManager::get(const std::string& key) {
-    // 检查当前语言是否存在
-    if (m_languages.find(m_currentLanguage) == m_languages.end()) {
-        return key;
-    }
-    
-    // 检查键是否存在
-    const auto& langMap = m_languages[m_currentLanguage];
-    if (langMap.find(key) == langMap.end()) {
-        return key;
-    }
-    
-    // 返回本地化文本
-    return langMap.at(key);
-}
-
 // 获取所有可用语言
-std::vector<std::string> LocalizationManager::getAvailableLanguages() {
+std::vector<std::string> LocalizationManager::getAvailableLanguages() const {
     std::vector<std::string> languages;
-    for (const auto& pair : m_languages) {
-        languages.push_back(pair.first);
+    for (const auto& table : m_languages) {
+        languages.push_back(table->code);
     }
     return languages;
 }
@@ -0,0 +1,107 @@
+#pragma once
+#include "Geometry.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace tch {
+
+// 属性查询条件，未设置的条件不参与过滤，多个条件之间为“与”
+struct AttributeQuery {
+    std::optional<ShapeType> type;   // 图形类型
+    std::optional<int> layerId;      // 所在图层
+    std::optional<glm::vec3> color;  // 颜色，按每分量8位比较
+};
+
+// 分页位集：每kPageBits个句柄为一页，只为含有成员的页分配内存，页清空后立即释放
+class PagedBitmap {
+public:
+    static constexpr std::size_t kPageBits = 4096;
+    static constexpr std::size_t kPageWords = kPageBits / 64;
+    using Page = std::array<std::uint64_t, kPageWords>;
+    
+    // 设置/清除单个句柄
+    void set(std::uint32_t handle);
+    void reset(std::uint32_t handle);
+    
+    // 句柄是否在集合中
+    bool test(std::uint32_t handle) const;
+    
+    // 成员个数
+    std::size_t size() const {
+        return m_count;
+    }
+    
+    bool empty() const {
+        return m_count == 0;
+    }
+    
+    // 页数（含未分配的页）
+    std::size_t getPageCount() const {
+        return m_pages.size();
+    }
+    
+    // 获取指定页，未分配时返回nullptr
+    const Page* getPage(std::size_t pageIndex) const {
+        return pageIndex < m_pages.size() ? m_pages[pageIndex].words.get() : nullptr;
+    }
+
+private:
+    struct PageSlot {
+        std::unique_ptr<Page> words;
+        std::uint32_t count = 0;
+    };
+    
+    std::vector<PageSlot> m_pages; // 页表
+    std::size_t m_count = 0;       // 成员个数
+};
+
+// 图形属性的二级索引：按类型、颜色与图层各维护一组分页位集，另以句柄为下标记录每个图形的属性。
+// 图形加入、移出图层或被原地修改时由图层管理器增量维护，每个图形常驻约8字节加上各位集中的1位
+class AttributeIndex {
+public:
+    // 登记图形，已登记时按当前属性更新
+    void insert(const Shape& shape);
+    
+    // 注销图形，按登记时记录的属性从各位集中移除
+    void erase(std::uint32_t handle);
+    
+    // 图形属性可能已改变（如颜色），重新登记
+    void update(const Shape& shape);
+    
+    // 清空索引
+    void clear();
+    
+    // 查询满足条件的句柄，按句柄从小到大追加到out；
+    // 只遍历条件中成员最少的位集所分配的页，耗时与该位集的规模成正比，而非与图形总数成正比
+    void query(const AttributeQuery& query, std::vector<std::uint32_t>& out) const;
+    
+    // 已登记的图形个数
+    std::size_t size() const {
+        return m_count;
+    }
+    
+    // 颜色的索引键：每分量量化为8位
+    static std::uint32_t colorKey(const glm::vec3& color);
+
+private:
+    // 从各位集中添加/移除句柄
+    void link(std::uint32_t handle, std::uint32_t typeColor, std::int32_t layerId);
+    void unlink(std::uint32_t handle, std::uint32_t typeColor, std::int32_t layerId);
+    
+    // 类型与颜色打包为一个键：高8位为类型加1（0表示未登记），低24位为颜色键
+    static std::uint32_t packTypeColor(ShapeType type, std::uint32_t colorKey);
+    
+    std::vector<std::uint32_t> m_typeColors;                  // 句柄到类型与颜色的映射
+    std::vector<std::int32_t> m_layerIds;                     // 句柄到图层ID的映射
+    std::array<PagedBitmap, 4> m_byType;                      // 按类型
+    std::unordered_map<std::uint32_t, PagedBitmap> m_byColor; // 按颜色键
+    std::unordered_map<int, PagedBitmap> m_byLayer;           // 按图层ID
+    std::size_t m_count = 0;                                  // 已登记的图形个数
+};
+
+} // namespace tch
@@ -0,0 +1,192 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace tch {
+
+// 二进制日志：文件头为魔数"TCHL"与版本，其后是一串以1字节类型开头的记录。
+// 格式字符串与源码位置第一次出现时各写一条定义记录并按出现顺序编号，日志记录只引用编号；
+// 日志记录依次为级别、与上一条日志的时间差（微秒）、位置编号、格式编号与带类型标记的参数，以结束标记收尾。
+// 整数为变长编码（有符号数先做zigzag变换），浮点数为小端定长，字符串为长度加字节。
+// 每次打开文件都会写入文件头并重新编号，追加写入的多个会话可以顺序读出
+
+// 二进制日志中参数的类型标记
+enum class BinaryLogArgType : std::uint8_t {
+    End = 0,    // 参数结束
+    Bool,       // 1字节
+    Char,       // 1字节
+    Int,        // 有符号整数
+    UInt,       // 无符号整数
+    Float,      // 4字节
+    Double,     // 8字节
+    String      // 长度加字节
+};
+
+// 解码出的一个参数
+using BinaryLogArg = std::variant<bool, char, std::int64_t, std::uint64_t, float, double, std::string>;
+
+// 二进制日志的编码：记录写入内部缓冲区，由调用方写入文件后清空；不是线程安全的
+class BinaryLogWriter {
+public:
+    // 日志的源码位置，指针作为定义表的键，必须指向静态存储的字符串（如std::source_location返回的字符串）
+    struct Site {
+        const char* file = "";          // 源文件名
+        std::uint32_t line = 0;         // 行号
+        const char* function = "";      // 函数名
+    };
+    
+    // 开始新的会话：清空定义表与缓冲区，写入文件头
+    void reset();
+    
+    // 开始一条日志记录，micros为自1970-01-01 UTC起的微秒数；格式与位置第一次出现时先写入定义记录，format必须指向静态存储的字符串
+    void beginMessage(int level, std::int64_t micros, const Site& site, const char* format);
+    
+    // 追加一个参数，按类型选择标记；字符串按std::string_view写入
+    template <typename T>
+    void appendArg(const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            appendTag(BinaryLogArgType::Bool);
+            m_buffer.push_back(value ? 1 : 0);
+        } else if constexpr (std::is_same_v<T, char>) {
+            appendTag(BinaryLogArgType::Char);
+            m_buffer.push_back(value);
+        } else if constexpr (std::is_same_v<T, float>) {
+            appendTag(BinaryLogArgType::Float);
+            appendFloat(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            appendTag(BinaryLogArgType::Double);
+            appendDouble(static_cast<double>(value));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            appendTag(BinaryLogArgType::Int);
+            appendSigned(static_cast<std::int64_t>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            appendTag(BinaryLogArgType::UInt);
+            appendVarint(static_cast<std::uint64_t>(value));
+        } else {
+            appendTag(BinaryLogArgType::String);
+            appendString(std::string_view(value));
+        }
+    }
+    
+    // 结束当前日志记录
+    void endMessage();
+    
+    // 尚未写出的编码数据
+    const std::string& data() const {
+        return m_buffer;
+    }
+    
+    // 写出后清空缓冲区，定义表保留
+    void clearData() {
+        m_buffer.clear();
+    }
+
+private:
+    // 源码位置定义表的键
+    struct SiteKey {
+        const char* file;
+        std::uint32_t line;
+        const char* function;
+        
+        bool operator==(const SiteKey& other) const = default;
+    };
+    
+    struct SiteKeyHash {
+        std::size_t operator()(const SiteKey& key) const {
+            std::size_t hash = std::hash<const void*>()(key.file);
+            hash ^= std::hash<const void*>()(key.function) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            return hash ^ (key.line * 0x9e3779b1u);
+        }
+    };
+    
+    void appendTag(BinaryLogArgType type) {
+        m_buffer.push_back(static_cast<char>(type));
+    }
+    
+    // 追加变长编码的无符号整数
+    void appendVarint(std::uint64_t value);
+    
+    // 追加zigzag变换后变长编码的有符号整数
+    void appendSigned(std::int64_t value);
+    
+    // 追加小端定长的浮点数
+    void appendFloat(float value);
+    void appendDouble(double value);
+    
+    // 追加长度加字节的字符串
+    void appendString(std::string_view str);
+    
+    std::string m_buffer;                                               // 编码数据
+    std::unordered_map<const char*, std::uint32_t> m_formatIds;         // 格式字符串 -> 编号
+    std::unordered_map<SiteKey, std::uint32_t, SiteKeyHash> m_siteIds;  // 源码位置 -> 编号
+    std::int64_t m_lastMicros = 0;                                      // 上一条日志的时间
+};
+
+// 从二进制日志中解码出的一条日志，其中的字符串视图在下一次调用BinaryLogReader::next前有效
+struct BinaryLogEntry {
+    int level = 0;                      // 日志级别
+    std::int64_t micros = 0;            // 自1970-01-01 UTC起的微秒数
+    std::string_view file;              // 源文件名
+    std::uint32_t line = 0;             // 行号
+    std::string_view function;          // 函数名
+    std::string_view format;            // 格式字符串
+    std::vector<BinaryLogArg> args;     // 参数
+};
+
+// 二进制日志的解码：从输入流中逐条读出日志
+class BinaryLogReader {
+public:
+    explicit BinaryLogReader(std::istream& input);
+    
+    // 读取下一条日志，读完或数据损坏时返回false，数据损坏（包括最后一条记录被截断）时getError非空
+    bool next(BinaryLogEntry& entry);
+    
+    // 数据损坏的原因
+    const std::string& getError() const {
+        return m_error;
+    }
+
+private:
+    // 源码位置定义
+    struct SiteDefinition {
+        std::string file;
+        std::uint32_t line = 0;
+        std::string function;
+    };
+    
+    bool readByte(std::uint8_t& value);
+    bool readVarint(std::uint64_t& value);
+    bool readString(std::string& str);
+    bool readBytes(void* data, std::size_t size);
+    
+    // 读取文件头剩余的部分（魔数的第一个字节已读出）并开始新的会话
+    bool readHeader();
+    
+    // 读取日志记录中的参数
+    bool readArgs(std::vector<BinaryLogArg>& args);
+    
+    // 记录数据损坏并返回false
+    bool fail(const std::string& error);
+    
+    std::istream& m_input;                      // 输入流
+    std::deque<std::string> m_formats;          // 当前会话的格式字符串，按编号
+    std::deque<SiteDefinition> m_sites;         // 当前会话的源码位置，按编号
+    std::int64_t m_lastMicros = 0;              // 上一条日志的时间
+    bool m_headerRead = false;                  // 是否已读到文件头
+    std::string m_error;                        // 数据损坏的原因
+};
+
+// 按格式字符串与解码出的参数格式化消息并追加到out，支持std::format的替换域（含显式下标与格式说明，不含嵌套的动态宽度）；
+// 格式不合法或参数不匹配时改为追加错误说明与格式字符串
+void formatBinaryLogMessage(std::string& out, std::string_view format, const std::vector<BinaryLogArg>& args);
+
+} // namespace tch
@@ -1,7 +1,9 @@
 #pragma once
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include "Hash.h"
 #include <memory>
 #include <vector>
 
@@ -18,8 +20,17 @@ enum class ShapeType {
 // 基础图形类
 class Shape {
 public:
+    Shape() = default;
     virtual ~Shape() = default;
     
+    // 复制时不复制句柄，副本加入图层时重新分配
+    Shape(const Shape& other) : m_color(other.m_color), m_layer(other.m_layer) {}
+    Shape& operator=(const Shape& other) {
+        m_color = other.m_color;
+        m_layer = other.m_layer;
+        return *this;
+    }
+    
     // 获取图形类型
     virtual ShapeType getType() const = 0;
     
@@ -35,6 +46,15 @@ public:
     // 绘制图形
     virtual void draw() const = 0;
     
+    // 获取轴对齐包围盒
+    virtual void getBounds(glm::vec2& minPoint, glm::vec2& maxPoint) const = 0;
+    
+    // 计算内容哈希（类型、颜色、图层与几何数据）
+    virtual std::uint64_t hash() const = 0;
+    
+    // 复制图形，副本与原图形共享颜色与图层属性
+    virtual std::shared_ptr<Shape> clone() const = 0;
+    
     // 设置颜色
     void setColor(const glm::vec3& color) {
         m_color = color;
@@ -54,10 +74,28 @@ public:
     int getLayer() const {
         return m_layer;
     }
+    
+    // 获取句柄，0表示尚未加入过图层
+    std::uint32_t getHandle() const {
+        return m_handle;
+    }
+    
+    // 设置句柄，由图层管理器调用
+    void setHandle(std::uint32_t handle) {
+        m_handle = handle;
+    }
 
 protected:
+    // 计算公共属性的哈希，供子类在此基础上合并几何数据
+    std::uint64_t hashBase() const {
+        std::uint64_t seed = HashUtils::mix(static_cast<std::uint64_t>(getType()) + 1);
+        seed = HashUtils::hashVec3(seed, m_color);
+        return HashUtils::combine(seed, static_cast<std::uint64_t>(static_cast<std::int64_t>(m_layer)));
+    }
+    
     glm::vec3 m_color = glm::vec3(1.0f, 1.0f, 1.0f); // 默认白色
     int m_layer = 0; // 默认图层
+    std::uint32_t m_handle = 0; // 句柄，首次加入图层时由图层管理器分配，之后不再改变
 };
 
 // 点类
@@ -98,6 +136,19 @@ public:
     
     void draw() const override;
     
+    void getBounds(glm::vec2& minPoint, glm::vec2& maxPoint) const override {
+        minPoint = m_position;
+        maxPoint = m_position;
+    }
+    
+    std::uint64_t hash() const override {
+        return HashUtils::hashVec2(hashBase(), m_position);
+    }
+    
+    std::shared_ptr<Shape> clone() const override {
+        return std::make_shared<Point>(*this);
+    }
+    
     // 获取位置
     glm::vec2 getPosition() const {
         return m_position;
@@ -158,6 +209,19 @@ public:
     
     void draw() const override;
     
+    void getBounds(glm::vec2& minPoint, glm::vec2& maxPoint) const override {
+        minPoint = glm::min(m_start, m_end);
+        maxPoint = glm::max(m_start, m_end);
+    }
+    
+    std::uint64_t hash() const override {
+        return HashUtils::hashVec2(HashUtils::hashVec2(hashBase(), m_start), m_end);
+    }
+    
+    std::shared_ptr<Shape> clone() const override {
+        return std::make_shared<Line>(*this);
+    }
+    
     // 获取起点
     glm::vec2 getStart() const {
         return m_start;
@@ -218,6 +282,20 @@ public:
     
     void draw() const override;
     
+    void getBounds(glm::vec2& minPoint, glm::vec2& maxPoint) const override {
+        glm::vec2 extent(std::abs(m_radius));
+        minPoint = m_center - extent;
+        maxPoint = m_center + extent;
+    }
+    
+    std::uint64_t hash() const override {
+        return HashUtils::hashFloat(HashUtils::hashVec2(hashBase(), m_center), m_radius);
+    }
+    
+    std::shared_ptr<Shape> clone() const override {
+        return std::make_shared<Circle>(*this);
+    }
+    
     // 获取圆心
     glm::vec2 getCenter() const {
         return m_center;
@@ -298,6 +376,21 @@ public:
     
     void draw() const override;
     
+    void getBounds(glm::vec2& minPoint, glm::vec2& maxPoint) const override {
+        glm::vec2 corner = m_position + glm::vec2(m_width, m_height);
+        minPoint = glm::min(m_position, corner);
+        maxPoint = glm::max(m_position, corner);
+    }
+    
+    std::uint64_t hash() const override {
+        std::uint64_t seed = HashUtils::hashVec2(hashBase(), m_position);
+        return HashUtils::hashFloat(HashUtils::hashFloat(seed, m_width), m_height);
+    }
+    
+    std::shared_ptr<Shape> clone() const override {
+        return std::make_shared<Rectangle>(*this);
+    }
+    
     // 获取位置
     glm::vec2 getPosition() const {
         return m_position;
@@ -342,6 +435,12 @@ namespace GeometryUtils {
     // 计算点到直线的距离
     float distanceToLine(const glm::vec2& point, const Line& line);
     
+    // 计算点到线段的距离，线段退化为一点时为到该点的距离
+    float distanceToSegment(const glm::vec2& point, const glm::vec2& start, const glm::vec2& end);
+    
+    // 线段是否与轴对齐矩形相交（含线段完全位于矩形内）
+    bool segmentIntersectsBox(const glm::vec2& start, const glm::vec2& end, const glm::vec2& minPoint, const glm::vec2& maxPoint);
+    
     // 计算两条直线的交点
     bool intersectLines(const Line& line1, const Line& line2, glm::vec2& intersection);
     
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <glm/glm.hpp>
+
+namespace tch {
+
+// 内容哈希工具函数，用于检测文档内容是否变化（非加密用途）
+namespace HashUtils {
+    // 64位混合函数（splitmix64终结步骤）
+    inline std::uint64_t mix(std::uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        value ^= value >> 31;
+        return value;
+    }
+    
+    // 按顺序合并哈希值，结果与合并顺序相关
+    inline std::uint64_t combine(std::uint64_t seed, std::uint64_t value) {
+        return mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+    }
+    
+    // 浮点数按位哈希
+    inline std::uint64_t hashFloat(std::uint64_t seed, float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return combine(seed, bits);
+    }
+    
+    // 二维向量哈希
+    inline std::uint64_t hashVec2(std::uint64_t seed, const glm::vec2& value) {
+        return hashFloat(hashFloat(seed, value.x), value.y);
+    }
+    
+    // 三维向量哈希
+    inline std::uint64_t hashVec3(std::uint64_t seed, const glm::vec3& value) {
+        return hashFloat(hashFloat(hashFloat(seed, value.x), value.y), value.z);
+    }
+    
+    // 字符串哈希（FNV-1a）
+    inline std::uint64_t hashString(std::uint64_t seed, std::string_view value) {
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : value) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        return combine(seed, hash);
+    }
+}
+
+} // namespace tch
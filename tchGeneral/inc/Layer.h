@@ -1,15 +1,21 @@
 #pragma once
 #include <Geometry.h>
+#include "AttributeIndex.h"
+#include "SpatialIndex.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 namespace tch {
 
+class LayerManager;
+
 // 图层类
 class Layer {
 public:
-    Layer(int id, const std::string& name) : m_id(id), m_name(name), m_visible(true) {}
+    // owner为所属的图层管理器，图形加入或移出图层时通知它维护句柄表
+    Layer(int id, const std::string& name, LayerManager* owner = nullptr) : m_id(id), m_name(name), m_visible(true), m_owner(owner) {}
     
     // 添加图形
     void addShape(const std::shared_ptr<Shape>& shape);
@@ -17,6 +23,12 @@ public:
     // 移除图形
     void removeShape(const std::shared_ptr<Shape>& shape);
     
+    // 批量添加图形，只使一次哈希块失效
+    void addShapes(const std::vector<std::shared_ptr<Shape>>& shapes);
+    
+    // 批量移除图形，单次遍历完成
+    void removeShapes(const std::vector<std::shared_ptr<Shape>>& shapes);
+    
     // 清空图形
     void clearShapes();
     
@@ -40,19 +52,48 @@ public:
     
     // 绘制图层上的图形
     void draw() const;
+    
+    // 每个哈希块包含的图形数量
+    static constexpr std::size_t kHashChunkSize = 1024;
+    
+    // 获取图层内容哈希（ID、名称、可见性与全部图形），只重新计算失效的块
+    std::uint64_t getHash() const;
+    
+    // 获取哈希块数量
+    std::size_t getChunkCount() const;
+    
+    // 获取指定块的哈希，块内为下标[chunkIndex * kHashChunkSize, (chunkIndex + 1) * kHashChunkSize)的图形
+    std::uint64_t getChunkHash(std::size_t chunkIndex) const;
+    
+    // 图形被原地修改后调用，使其所在块的哈希失效
+    void markShapeModified(const std::shared_ptr<Shape>& shape);
+    
+    // 一组图形被原地修改后调用，单次遍历完成
+    void markShapesModified(const std::vector<std::shared_ptr<Shape>>& shapes);
 
 private:
+    // 块哈希缓存
+    struct ChunkHash {
+        std::uint64_t hash = 0;
+        bool valid = false;
+    };
+    
+    // 使包含指定下标及其之后图形的块失效
+    void invalidateChunksFrom(std::size_t shapeIndex);
+    
     int m_id;
     std::string m_name;
     bool m_visible;
+    LayerManager* m_owner;
     std::vector<std::shared_ptr<Shape>> m_shapes;
+    mutable std::vector<ChunkHash> m_chunkHashes; // 块哈希缓存，非线程安全，由文档统一加锁访问
 };
 
-// 图层管理器
+// 图层管理器，每个文档各自持有一份
 class LayerManager {
 public:
-    // 获取单例实例
-    static LayerManager& getInstance();
+    // 构造函数，创建默认图层
+    LayerManager();
     
     // 禁止拷贝和赋值
     LayerManager(const LayerManager&) = delete;
@@ -84,14 +125,53 @@ public:
     
     // 清空所有图层
     void clearAllLayers();
+    
+    // 图形被原地修改后调用，通知其所在图层
+    void markShapeModified(const std::shared_ptr<Shape>& shape);
+    
+    // 一组图形被原地修改后调用，按图层分组通知
+    void markShapesModified(const std::vector<std::shared_ptr<Shape>>& shapes);
+    
+    // 按句柄获取图形，图形当前不在任何图层中时返回nullptr
+    std::shared_ptr<Shape> getShape(std::uint32_t handle) const;
+    
+    // 句柄上限（已分配的最大句柄加1），句柄位集按此确定大小
+    std::uint32_t getHandleLimit() const;
+    
+    // 获取按类型、颜色与图层建立的属性索引
+    const AttributeIndex& getAttributeIndex() const;
+    
+    // 获取空间索引，随句柄表增量维护，批量修改后在此整体重建；非线程安全，由文档统一加锁访问
+    const SpatialIndex& getSpatialIndex() const;
+    
+    // 获取全部图层的内容哈希，与图层的存储顺序无关
+    std::uint64_t getHash() const;
 
 private:
-    // 私有构造函数
-    LayerManager();
+    friend class Layer;
+    
+    // 登记加入图层的图形，首次登记时分配句柄
+    void registerShape(const std::shared_ptr<Shape>& shape);
+    
+    // 注销移出图层的图形，句柄保留在图形上，重新加入（如重做）时沿用
+    void unregisterShape(const Shape& shape);
+    
+    // 批量修改count个图形前调用，数量与已索引的图形相当时丢弃空间索引，留待下次访问时整体重建
+    void prepareBulkChange(std::size_t count);
     
     // 图层映射
     std::unordered_map<int, std::unique_ptr<Layer>> m_layers;
     
+    // 句柄到图形的映射，下标0保留；移出图层的图形对应空指针
+    std::vector<std::shared_ptr<Shape>> m_shapesByHandle;
+    
+    // 属性索引，随句柄表一起维护
+    AttributeIndex m_attributeIndex;
+    
+    // 空间索引，有效时随句柄表一起维护，失效后延迟重建
+    mutable SpatialIndex m_spatialIndex;
+    mutable bool m_spatialIndexValid;
+    
     // 下一个图层ID
     int m_nextLayerId;
     
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace tch {
+
+// 日志文本行的行首字段
+struct LogLinePrefix {
+    int level = 0;                                 // 日志级别，与Logger::LogLevel一致（0为Trace，5为Fatal）
+    std::string_view levelColor;                   // 级别颜色的控制码，不着色时为空
+    std::string_view resetColor;                   // 恢复颜色的控制码，不着色时为空
+    std::chrono::system_clock::time_point time;    // 日志时间
+    std::string_view file;                         // 源文件名（不含路径）
+    std::uint32_t line = 0;                        // 行号
+    std::string_view function;                     // 函数名
+};
+
+// 日志文本行的拼接：按"[ 级别 ][ 时间 ] [ 文件 : 行 : 函数 ]: "的格式追加行首，时间中到秒为止的部分每秒只格式化一次。
+// Logger写文本日志与二进制日志的解码工具共用，保证两者输出的文本一致；不是线程安全的
+class LogLineFormatter {
+public:
+    // 追加行首，调用方随后追加消息与换行
+    void appendPrefix(std::string& out, const LogLinePrefix& prefix);
+    
+    // 级别名称，超出范围的级别按Fatal处理
+    static std::string_view levelName(int level);
+    
+    // 按名称查找级别，找不到时返回-1
+    static int findLevel(std::string_view name);
+
+private:
+    // 追加"YYYY-MM-DD HH:MM:SS.mmm"（本地时间）
+    void appendTimestamp(std::string& out, std::chrono::system_clock::time_point time);
+    
+    std::int64_t m_cachedSecond = std::numeric_limits<std::int64_t>::min(); // m_cachedSecondText对应的秒
+    char m_cachedSecondText[32] = {};                                       // m_cachedSecond的"YYYY-MM-DD HH:MM:SS"
+};
+
+} // namespace tch
@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace tch {
+
+// 多生产者单消费者的有界无锁环形队列：容量固定（2的幂），槽位预先分配，满时tryPush返回false。
+// 每个槽位带有序号：生产者通过CAS领取写入位置后写入元素并发布序号，消费者按序号判断槽位是否已写完，
+// 因此生产者之间只竞争一个写入索引，与消费者之间没有锁
+template <typename T, std::size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+    
+    MpscRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+    
+    // 生产者（任意线程）：追加一个元素，队列已满时返回false且不移动value
+    template <typename U>
+    bool tryPush(U&& value) {
+        return tryEmplace([&value](T& slot) { slot = std::forward<U>(value); });
+    }
+    
+    // 生产者（任意线程）：领取一个槽位并调用fill(T&)就地写入，不经过临时对象；队列已满时返回false且不调用fill。
+    // 槽位中是上一次取出后留下的元素，fill需要写入全部有意义的成员
+    template <typename Fill>
+    bool tryEmplace(Fill&& fill) {
+        std::size_t pos = m_tail.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &m_slots[pos & (Capacity - 1)];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                // 槽位空闲，领取写入位置
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // 槽位还没有被消费者取走，队列已满
+                return false;
+            } else {
+                // 其他生产者已领取该位置
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        fill(slot->value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // 消费者：取出最早的元素，队列为空或最早的元素还没有写完时返回false
+    bool tryPop(T& out) {
+        std::size_t pos = m_head.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[pos & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        out = std::move(slot.value);
+        slot.sequence.store(pos + Capacity, std::memory_order_release);
+        m_head.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // 消费者：按顺序批量取出最多maxCount个元素，对每个元素调用fn(T&)，fn返回后槽位即被释放，返回取出的个数
+    template <typename Fn>
+    std::size_t drain(Fn&& fn, std::size_t maxCount = Capacity) {
+        std::size_t pos = m_head.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        for (; count < maxCount; ++count, ++pos) {
+            Slot& slot = m_slots[pos & (Capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            fn(slot.value);
+            slot.sequence.store(pos + Capacity, std::memory_order_release);
+        }
+        m_head.store(pos, std::memory_order_relaxed);
+        return count;
+    }
+    
+    // 元素个数（含正在写入的），其他线程同时读写时只是近似值
+    std::size_t size() const {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+    
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+    
+    // 槽位：sequence等于位置时可写入，等于位置+1时可读取
+    struct alignas(kCacheLine) Slot {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+    
+    alignas(kCacheLine) std::atomic<std::size_t> m_tail{0}; // 下一个要领取的写入位置，由生产者竞争
+    alignas(kCacheLine) std::atomic<std::size_t> m_head{0}; // 下一个要取出的位置，只由消费者写入
+    std::array<Slot, Capacity> m_slots;                     // 元素存储
+};
+
+} // namespace tch
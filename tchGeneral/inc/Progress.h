@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+namespace tch {
+
+// 长时间操作的进度与取消标记：执行操作的线程（可以是多个）上报进度并定期检查取消，其他线程读取进度或请求取消
+class ProgressMonitor {
+public:
+    static constexpr std::size_t kReportInterval = 1024; // 逐项处理时每隔多少项上报一次进度并检查取消
+    
+    // 设置总工作量
+    void setTotal(std::size_t total) {
+        m_total.store(total, std::memory_order_relaxed);
+    }
+    
+    // 增加已完成的工作量
+    void advance(std::size_t count) {
+        m_done.fetch_add(count, std::memory_order_relaxed);
+    }
+    
+    // 完成比例，范围[0, 1]，总工作量未知时为0
+    float getFraction() const {
+        std::size_t total = m_total.load(std::memory_order_relaxed);
+        if (total == 0) {
+            return 0.0f;
+        }
+        return std::min(1.0f, static_cast<float>(m_done.load(std::memory_order_relaxed)) / static_cast<float>(total));
+    }
+    
+    // 请求取消
+    void cancel() {
+        m_cancelled.store(true, std::memory_order_relaxed);
+    }
+    
+    // 是否已请求取消
+    bool isCancelled() const {
+        return m_cancelled.load(std::memory_order_relaxed);
+    }
+    
+    // 逐项处理的循环中每完成一项调用一次，pending为调用方的局部计数：
+    // 每kReportInterval项上报一次进度，已请求取消时返回false；progress为空时总是返回true
+    static bool step(ProgressMonitor* progress, std::size_t& pending) {
+        if (progress && ++pending == kReportInterval) {
+            progress->advance(pending);
+            pending = 0;
+            return !progress->isCancelled();
+        }
+        return true;
+    }
+
+private:
+    std::atomic<std::size_t> m_done{0};      // 已完成的工作量
+    std::atomic<std::size_t> m_total{0};     // 总工作量
+    std::atomic<bool> m_cancelled{false};    // 是否已请求取消
+};
+
+} // namespace tch
@@ -1,22 +1,72 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace tch {
 
+class LayerManager;
+class ProgressMonitor;
+class Shape;
+
+// DXF版本
+enum class DxfVersion {
+    R12,    // AC1009，结构最简单，兼容性最好
+    R2000   // AC1015，带句柄与子类标记
+};
+
+// JSON保存缓存：按图层与哈希块缓存已序列化的图形文本，块哈希未变化时直接复用
+struct JsonChunkCache {
+    struct Chunk {
+        std::uint64_t hash = 0; // 生成文本时的块哈希
+        std::string text;       // 块内图形的JSON文本
+    };
+    
+    std::unordered_map<int, std::vector<Chunk>> layers; // 图层ID -> 各块缓存
+    std::size_t reusedChunks = 0;                       // 最近一次保存复用的块数
+    std::size_t writtenChunks = 0;                      // 最近一次保存重新序列化的块数
+};
+
+// 从文件解析出的图层，尚未加入任何图层管理器
+struct LoadedLayer {
+    std::string name;                            // 图层名
+    bool visible = true;                         // 是否可见
+    std::vector<std::shared_ptr<Shape>> shapes;  // 图形
+};
+
 // 保存/加载模块
 class SaveLoad {
 public:
-    // 保存图形到文件
-    static bool saveToFile(const std::string& filePath);
+    // 保存图形到文件，提供缓存时只重新序列化哈希发生变化的块
+    static bool saveToFile(const LayerManager& layerManager, const std::string& filePath, JsonChunkCache* cache = nullptr);
     
     // 从文件加载图形
-    static bool loadFromFile(const std::string& filePath);
+    static bool loadFromFile(LayerManager& layerManager, const std::string& filePath);
+    
+    // 从内存中的JSON文本加载图形
+    static bool loadFromString(LayerManager& layerManager, std::string_view content);
+    
+    // 解析文件但不修改任何图层管理器，可在后台线程执行；取消或失败时返回false
+    static bool parseFile(const std::string& filePath, std::vector<LoadedLayer>& layers, ProgressMonitor* progress = nullptr);
+    
+    // 解析内存中的JSON文本，规则同parseFile
+    static bool parseString(std::string_view content, std::vector<LoadedLayer>& layers, ProgressMonitor* progress = nullptr);
+    
+    // 用解析结果替换图层管理器中的全部图层
+    static void applyLayers(LayerManager& layerManager, std::vector<LoadedLayer> layers);
+    
+    // 导出为SVG格式，取消时删除已写出的部分并返回false
+    static bool exportToSVG(const LayerManager& layerManager, const std::string& filePath, ProgressMonitor* progress = nullptr);
     
-    // 导出为SVG格式
-    static bool exportToSVG(const std::string& filePath);
+    // 导出为DXF格式（ASCII），图层映射到LAYER表，图形映射到实体；取消时不写文件并返回false
+    static bool exportToDXF(const LayerManager& layerManager, const std::string& filePath, DxfVersion version = DxfVersion::R2000,
+                            ProgressMonitor* progress = nullptr);
     
     // 导出为PNG格式
-    static bool exportToPNG(const std::string& filePath);
+    static bool exportToPNG(const LayerManager& layerManager, const std::string& filePath);
 
 private:
     // 私有构造函数
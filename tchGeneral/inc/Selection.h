@@ -0,0 +1,86 @@
+#pragma once
+#include "Geometry.h"
+#include "Layer.h"
+#include "SpatialIndex.h"
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace tch {
+
+// 选择方式
+enum class SelectMode {
+    Replace, // 替换当前选择
+    Add,     // 加入当前选择
+    Remove   // 从当前选择中移除
+};
+
+// 选择集：以图形句柄为下标的位集，每个图形只占1位。
+// 区域选择通过空间索引查询候选图形，不遍历全部图形
+class SelectionSet {
+public:
+    // 窗口选择：包围盒完全位于矩形内的图形，返回选中个数
+    std::size_t selectWindow(const SpatialIndex& index, const glm::vec2& corner1, const glm::vec2& corner2, SelectMode mode = SelectMode::Replace);
+    
+    // 交叉选择：轮廓与矩形相交或位于矩形内的图形，返回选中个数
+    std::size_t selectCrossing(const SpatialIndex& index, const glm::vec2& corner1, const glm::vec2& corner2, SelectMode mode = SelectMode::Replace);
+    
+    // 点选：轮廓到该点的距离不超过tolerance的图形中最后绘制的一个，返回选中个数
+    std::size_t selectAtPoint(const SpatialIndex& index, const glm::vec2& point, float tolerance, SelectMode mode = SelectMode::Replace);
+    
+    // 全选，返回选中个数
+    std::size_t selectAll(const LayerManager& layerManager, SelectMode mode = SelectMode::Replace);
+    
+    // 按属性选择：通过图层管理器的属性索引查询，不遍历全部图形，返回选中个数
+    std::size_t selectByAttributes(const LayerManager& layerManager, const AttributeQuery& query, SelectMode mode = SelectMode::Replace);
+    
+    // 过滤：只保留满足条件的图形，耗时与选中个数成正比，返回选中个数
+    std::size_t filter(const LayerManager& layerManager, const std::function<bool(const Shape&)>& predicate);
+    
+    // 清空选择
+    void clear();
+    
+    // 句柄是否被选中
+    bool contains(std::uint32_t handle) const;
+    
+    // 选中个数
+    std::size_t size() const {
+        return m_count;
+    }
+    
+    bool empty() const {
+        return m_count == 0;
+    }
+    
+    // 获取选中的图形，顺带剔除已不在图层中的句柄（如被撤销的图形）
+    std::vector<std::shared_ptr<Shape>> resolve(const LayerManager& layerManager);
+    
+    // 按句柄从小到大遍历选中的句柄
+    template <typename Func>
+    void forEach(Func func) const {
+        for (std::size_t word = 0; word < m_words.size(); ++word) {
+            for (std::uint64_t bits = m_words[word]; bits != 0; bits &= bits - 1) {
+                func(static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits)));
+            }
+        }
+    }
+
+private:
+    // 按选择方式合并一组图形
+    void apply(const std::vector<std::shared_ptr<Shape>>& shapes, SelectMode mode);
+    
+    // 按选择方式合并一组句柄
+    void apply(const std::vector<std::uint32_t>& handles, SelectMode mode);
+    
+    // 设置/清除单个句柄
+    void set(std::uint32_t handle);
+    void reset(std::uint32_t handle);
+    
+    std::vector<std::uint64_t> m_words; // 位集
+    std::size_t m_count = 0;            // 选中个数
+};
+
+} // namespace tch
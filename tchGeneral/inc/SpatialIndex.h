@@ -0,0 +1,69 @@
+#pragma once
+#include "Geometry.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace tch {
+
+class LayerManager;
+
+// 空间索引：基于均匀网格，按包围盒查询图形；条目以图形句柄为键，可逐个增删
+class SpatialIndex {
+public:
+    // 根据图层管理器中的所有图形重建索引，按当前场景重新确定网格
+    void build(const LayerManager& layerManager);
+    
+    // 清空索引
+    void clear();
+    
+    // 登记图形，已登记的句柄先移除旧位置；沿用现有网格，不重新划分
+    void insert(const std::shared_ptr<Shape>& shape);
+    
+    // 移除指定句柄的图形
+    void erase(std::uint32_t handle);
+    
+    // 增量修改使网格明显失衡（图形数量远超建立网格时，或大量图形落在网格之外）时返回true
+    bool needsRebuild() const;
+    
+    // 查询包围盒与指定矩形相交的图形
+    void query(const glm::vec2& minPoint, const glm::vec2& maxPoint, std::vector<std::shared_ptr<Shape>>& result) const;
+    
+    // 获取索引中的图形数量
+    std::size_t size() const;
+
+private:
+    // 索引条目，shape为空表示该句柄未登记
+    struct Entry {
+        std::shared_ptr<Shape> shape;
+        glm::vec2 minPoint;
+        glm::vec2 maxPoint;
+        bool oversized = false;
+    };
+    
+    // 把条目登记到其包围盒覆盖的网格，覆盖过多时作为大图形存放
+    void link(std::uint32_t handle);
+    
+    // 把条目从网格中移除
+    void unlink(std::uint32_t handle);
+    
+    // 计算坐标所在的网格
+    glm::ivec2 cellOf(const glm::vec2& point) const;
+    
+    // 网格坐标编码为哈希键
+    static std::uint64_t cellKey(int x, int y);
+    
+    std::vector<Entry> m_entries;                                       // 按句柄存放的条目
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells; // 网格到句柄的映射
+    std::vector<std::uint32_t> m_oversized;                              // 跨越网格过多的句柄，查询时逐个检查
+    std::size_t m_size = 0;                                              // 已登记的图形数量
+    std::size_t m_builtSize = 0;                                         // 划分网格时的图形数量
+    glm::vec2 m_origin = glm::vec2(0.0f);                                // 网格原点，即建立网格时场景包围盒最小点
+    glm::vec2 m_sceneMin = glm::vec2(0.0f);                              // 场景包围盒最小点，随登记扩大
+    glm::vec2 m_sceneMax = glm::vec2(0.0f);                              // 场景包围盒最大点，随登记扩大
+    float m_cellSize = 1.0f;                                             // 网格边长
+};
+
+} // namespace tch
@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace tch {
+
+// 单生产者单消费者的无锁环形队列：容量固定（2的幂），满时push返回false，不分配内存。
+// 生产者只写尾部索引，消费者只写头部索引，两个索引分别位于独立的缓存行
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+    
+    // 生产者：追加一个元素，队列已满时返回false
+    bool push(const T& value) {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // 消费者：取出最早的元素，队列为空时返回false
+    bool pop(T& out) {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = m_slots[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // 消费者：查看最早的元素而不取出，队列为空时返回nullptr
+    const T* peek() const {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_slots[head & (Capacity - 1)];
+    }
+    
+    // 元素个数，其他线程同时读写时只是近似值
+    std::size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+    
+    bool empty() const {
+        return size() == 0;
+    }
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+    
+    alignas(kCacheLine) std::atomic<std::size_t> m_head{0}; // 下一个要取出的位置，只由消费者写入
+    alignas(kCacheLine) std::atomic<std::size_t> m_tail{0}; // 下一个要写入的位置，只由生产者写入
+    alignas(kCacheLine) std::array<T, Capacity> m_slots{};  // 元素存储
+};
+
+} // namespace tch
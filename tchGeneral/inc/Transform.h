@@ -5,6 +5,8 @@
 
 namespace tch {
 
+class ProgressMonitor;
+
 // 变换模块
 class Transform {
 public:
@@ -26,6 +28,17 @@ public:
     // 缩放多个图形
     static void scale(const std::vector<std::shared_ptr<Shape>>& shapes, float factor, const glm::vec2& center);
     
+    // 矩形阵列：按rows行cols列复制图形，行距沿Y轴、列距沿X轴，第0行第0列为原图形本身，不再复制。
+    // 提供progress时上报进度，取消后返回空结果
+    static std::vector<std::shared_ptr<Shape>> rectangularArray(const std::vector<std::shared_ptr<Shape>>& sources,
+                                                                int rows, int cols, float rowSpacing, float colSpacing,
+                                                                ProgressMonitor* progress = nullptr);
+    
+    // 环形阵列：绕center共count项（含原图形），在fillAngle（弧度）范围内均匀分布，整圆时首尾不重合；progress规则同上
+    static std::vector<std::shared_ptr<Shape>> polarArray(const std::vector<std::shared_ptr<Shape>>& sources,
+                                                          int count, float fillAngle, const glm::vec2& center,
+                                                          ProgressMonitor* progress = nullptr);
+    
     // 计算变换矩阵
     static glm::mat3 calculateTransformMatrix(const glm::vec2& translation, float rotation, float scale);
     
@@ -4,6 +4,7 @@
 #include <string>
 #include "Geometry.h"
 #include "Layer.h"
+#include "Transform.h"
 #include <glm/glm.hpp>
 
 namespace tch {
@@ -29,7 +30,8 @@ public:
 // 绘制操作
 class DrawOperation : public Operation {
 public:
-    DrawOperation(const std::shared_ptr<Shape>& shape) : m_shape(shape) {}
+    DrawOperation(LayerManager& layerManager, const std::shared_ptr<Shape>& shape)
+        : m_layerManager(layerManager), m_shape(shape) {}
     
     void execute() override {
         // 绘制操作在创建时已经执行
@@ -39,7 +41,7 @@ public:
         // 从图层中移除图形
         if (m_shape) {
             int layerId = m_shape->getLayer();
-            auto layer = LayerManager::getInstance().getLayer(layerId);
+            auto layer = m_layerManager.getLayer(layerId);
             if (layer) {
                 layer->removeShape(m_shape);
             }
@@ -50,7 +52,7 @@ public:
         // 添加图形到图层
         if (m_shape) {
             int layerId = m_shape->getLayer();
-            auto layer = LayerManager::getInstance().getLayer(layerId);
+            auto layer = m_layerManager.getLayer(layerId);
             if (layer) {
                 layer->addShape(m_shape);
             }
@@ -60,26 +62,74 @@ public:
     std::string getName() const override {
         return "Draw";
     }
+    
+    // 获取图层管理器
+    LayerManager& getLayerManager() const {
+        return m_layerManager;
+    }
+    
+    // 获取绘制的图形
+    const std::shared_ptr<Shape>& getShape() const {
+        return m_shape;
+    }
 
 private:
+    LayerManager& m_layerManager;
     std::shared_ptr<Shape> m_shape;
 };
 
+// 批量绘制操作：一次添加到同一图层的多个图形（如阵列），作为一个撤销步骤
+class BulkDrawOperation : public Operation {
+public:
+    BulkDrawOperation(LayerManager& layerManager, int layerId, std::vector<std::shared_ptr<Shape>> shapes, const std::string& name)
+        : m_layerManager(layerManager), m_layerId(layerId), m_shapes(std::move(shapes)), m_name(name) {}
+    
+    void execute() override {
+        // 图形在创建时已经批量添加
+    }
+    
+    void undo() override {
+        auto layer = m_layerManager.getLayer(m_layerId);
+        if (layer) {
+            layer->removeShapes(m_shapes);
+        }
+    }
+    
+    void redo() override {
+        auto layer = m_layerManager.getLayer(m_layerId);
+        if (layer) {
+            layer->addShapes(m_shapes);
+        }
+    }
+    
+    std::string getName() const override {
+        return m_name;
+    }
+
+private:
+    LayerManager& m_layerManager;
+    int m_layerId;
+    std::vector<std::shared_ptr<Shape>> m_shapes;
+    std::string m_name;
+};
+
 // 平移操作
 class TranslateOperation : public Operation {
 public:
-    TranslateOperation(const std::shared_ptr<Shape>& shape, const glm::vec2& delta)
-        : m_shape(shape), m_delta(delta) {}
+    TranslateOperation(LayerManager& layerManager, const std::shared_ptr<Shape>& shape, const glm::vec2& delta)
+        : m_layerManager(layerManager), m_shape(shape), m_delta(delta) {}
     
     void execute() override {
         if (m_shape) {
             m_shape->translate(m_delta);
+            m_layerManager.markShapeModified(m_shape);
         }
     }
     
     void undo() override {
         if (m_shape) {
             m_shape->translate(-m_delta);
+            m_layerManager.markShapeModified(m_shape);
         }
     }
     
@@ -92,6 +142,7 @@ public:
     }
 
 private:
+    LayerManager& m_layerManager;
     std::shared_ptr<Shape> m_shape;
     glm::vec2 m_delta;
 };
@@ -99,18 +150,20 @@ private:
 // 旋转操作
 class RotateOperation : public Operation {
 public:
-    RotateOperation(const std::shared_ptr<Shape>& shape, float angle, const glm::vec2& center)
-        : m_shape(shape), m_angle(angle), m_center(center) {}
+    RotateOperation(LayerManager& layerManager, const std::shared_ptr<Shape>& shape, float angle, const glm::vec2& center)
+        : m_layerManager(layerManager), m_shape(shape), m_angle(angle), m_center(center) {}
     
     void execute() override {
         if (m_shape) {
             m_shape->rotate(m_angle, m_center);
+            m_layerManager.markShapeModified(m_shape);
         }
     }
     
     void undo() override {
         if (m_shape) {
             m_shape->rotate(-m_angle, m_center);
+            m_layerManager.markShapeModified(m_shape);
         }
     }
     
@@ -123,6 +176,7 @@ public:
     }
 
 private:
+    LayerManager& m_layerManager;
     std::shared_ptr<Shape> m_shape;
     float m_angle;
     glm::vec2 m_center;
@@ -131,18 +185,20 @@ private:
 // 缩放操作
 class ScaleOperation : public Operation {
 public:
-    ScaleOperation(const std::shared_ptr<Shape>& shape, float factor, const glm::vec2& center)
-        : m_shape(shape), m_factor(factor), m_center(center) {}
+    ScaleOperation(LayerManager& layerManager, const std::shared_ptr<Shape>& shape, float factor, const glm::vec2& center)
+        : m_layerManager(layerManager), m_shape(shape), m_factor(factor), m_center(center) {}
     
     void execute() override {
         if (m_shape) {
             m_shape->scale(m_factor, m_center);
+            m_layerManager.markShapeModified(m_shape);
         }
     }
     
     void undo() override {
         if (m_shape) {
             m_shape->scale(1.0f / m_factor, m_center);
+            m_layerManager.markShapeModified(m_shape);
         }
     }
     
@@ -155,31 +211,231 @@ public:
     }
 
 private:
+    LayerManager& m_layerManager;
     std::shared_ptr<Shape> m_shape;
     float m_factor;
     glm::vec2 m_center;
 };
 
-// 撤销/重做管理器
+// 组合操作：事务内的多个操作作为一个撤销步骤
+class CompoundOperation : public Operation {
+public:
+    explicit CompoundOperation(const std::string& name) : m_name(name) {}
+    
+    // 添加已执行的子操作
+    void add(const std::shared_ptr<Operation>& operation) {
+        m_operations.push_back(operation);
+    }
+    
+    // 子操作个数
+    size_t size() const {
+        return m_operations.size();
+    }
+    
+    // 把连续绘制到同一图层的DrawOperation合并为一个BulkDrawOperation：撤销时整段从图层末尾截断，
+    // 而不是逐个从头查找，大批量绘制的事务撤销为O(n)
+    void mergeDrawOperations() {
+        std::vector<std::shared_ptr<Operation>> merged;
+        merged.reserve(m_operations.size());
+        std::size_t index = 0;
+        while (index < m_operations.size()) {
+            auto* draw = dynamic_cast<DrawOperation*>(m_operations[index].get());
+            std::size_t end = index + 1;
+            if (draw && draw->getShape()) {
+                int layerId = draw->getShape()->getLayer();
+                while (end < m_operations.size()) {
+                    auto* next = dynamic_cast<DrawOperation*>(m_operations[end].get());
+                    if (!next || !next->getShape() || next->getShape()->getLayer() != layerId ||
+                        &next->getLayerManager() != &draw->getLayerManager()) {
+                        break;
+                    }
+                    ++end;
+                }
+            }
+            
+            if (end - index == 1) {
+                merged.push_back(std::move(m_operations[index]));
+            } else {
+                std::vector<std::shared_ptr<Shape>> shapes;
+                shapes.reserve(end - index);
+                for (std::size_t i = index; i < end; ++i) {
+                    shapes.push_back(static_cast<DrawOperation&>(*m_operations[i]).getShape());
+                }
+                int layerId = shapes.front()->getLayer();
+                merged.push_back(std::make_shared<BulkDrawOperation>(draw->getLayerManager(), layerId, std::move(shapes), "Draw"));
+            }
+            index = end;
+        }
+        m_operations = std::move(merged);
+    }
+    
+    void execute() override {
+        // 子操作加入时已经执行
+    }
+    
+    void undo() override {
+        // 按相反顺序撤销
+        for (auto it = m_operations.rbegin(); it != m_operations.rend(); ++it) {
+            (*it)->undo();
+        }
+    }
+    
+    void redo() override {
+        for (auto& operation : m_operations) {
+            operation->redo();
+        }
+    }
+    
+    std::string getName() const override {
+        return m_name;
+    }
+
+private:
+    std::string m_name;
+    std::vector<std::shared_ptr<Operation>> m_operations;
+};
+
+// 批量变换操作：对一组图形整体平移、旋转或缩放，作为一个撤销步骤
+class BatchTransformOperation : public Operation {
+public:
+    // 变换类型
+    enum class Kind {
+        Translate, // 平移，vector为位移
+        Rotate,    // 旋转，vector为中心，value为角度（弧度）
+        Scale      // 缩放，vector为中心，value为比例
+    };
+    
+    BatchTransformOperation(LayerManager& layerManager, std::vector<std::shared_ptr<Shape>> shapes, Kind kind, const glm::vec2& vector, float value = 0.0f)
+        : m_layerManager(layerManager), m_shapes(std::move(shapes)), m_kind(kind), m_vector(vector), m_value(value) {}
+    
+    void execute() override {
+        switch (m_kind) {
+            case Kind::Translate:
+                Transform::translate(m_shapes, m_vector);
+                break;
+            case Kind::Rotate:
+                Transform::rotate(m_shapes, m_value, m_vector);
+                break;
+            case Kind::Scale:
+                Transform::scale(m_shapes, m_value, m_vector);
+                break;
+        }
+        m_layerManager.markShapesModified(m_shapes);
+    }
+    
+    void undo() override {
+        switch (m_kind) {
+            case Kind::Translate:
+                Transform::translate(m_shapes, -m_vector);
+                break;
+            case Kind::Rotate:
+                Transform::rotate(m_shapes, -m_value, m_vector);
+                break;
+            case Kind::Scale:
+                Transform::scale(m_shapes, 1.0f / m_value, m_vector);
+                break;
+        }
+        m_layerManager.markShapesModified(m_shapes);
+    }
+    
+    void redo() override {
+        execute();
+    }
+    
+    std::string getName() const override {
+        switch (m_kind) {
+            case Kind::Translate:
+                return "Translate";
+            case Kind::Rotate:
+                return "Rotate";
+            case Kind::Scale:
+                return "Scale";
+        }
+        return "Transform";
+    }
+
+private:
+    LayerManager& m_layerManager;
+    std::vector<std::shared_ptr<Shape>> m_shapes;
+    Kind m_kind;
+    glm::vec2 m_vector;
+    float m_value;
+};
+
+// 设置颜色操作：修改一组图形的颜色，撤销时逐个恢复原颜色
+class SetColorOperation : public Operation {
+public:
+    SetColorOperation(LayerManager& layerManager, std::vector<std::shared_ptr<Shape>> shapes, const glm::vec3& color)
+        : m_layerManager(layerManager), m_shapes(std::move(shapes)), m_color(color) {
+        m_oldColors.reserve(m_shapes.size());
+        for (const auto& shape : m_shapes) {
+            m_oldColors.push_back(shape->getColor());
+        }
+    }
+    
+    void execute() override {
+        for (auto& shape : m_shapes) {
+            shape->setColor(m_color);
+        }
+        m_layerManager.markShapesModified(m_shapes);
+    }
+    
+    void undo() override {
+        for (std::size_t i = 0; i < m_shapes.size(); ++i) {
+            m_shapes[i]->setColor(m_oldColors[i]);
+        }
+        m_layerManager.markShapesModified(m_shapes);
+    }
+    
+    void redo() override {
+        execute();
+    }
+    
+    std::string getName() const override {
+        return "Color";
+    }
+
+private:
+    LayerManager& m_layerManager;
+    std::vector<std::shared_ptr<Shape>> m_shapes;
+    std::vector<glm::vec3> m_oldColors;
+    glm::vec3 m_color;
+};
+
+// 撤销/重做管理器，每个文档各自持有一份
 class UndoRedoManager {
 public:
-    // 获取单例实例
-    static UndoRedoManager& getInstance();
+    UndoRedoManager() = default;
     
     // 禁止拷贝和赋值
     UndoRedoManager(const UndoRedoManager&) = delete;
     UndoRedoManager& operator=(const UndoRedoManager&) = delete;
     
-    // 添加操作
+    // 添加操作，事务进行中时归入当前事务
     void addOperation(const std::shared_ptr<Operation>& operation);
     
-    // 撤销
+    // 开始事务，之后添加的操作合并为一个撤销步骤；可以嵌套，最外层提交时才入栈
+    void beginTransaction(const std::string& name);
+    
+    // 提交事务，结束最外层事务时返回true
+    bool commitTransaction();
+    
+    // 是否有进行中的事务
+    bool isInTransaction() const;
+    
+    // 当前事务中的操作个数
+    size_t getTransactionSize() const;
+    
+    // 事务嵌套层数，没有进行中的事务时为0
+    size_t getTransactionDepth() const;
+    
+    // 撤销，事务进行中时不可用
     bool undo();
     
-    // 重做
+    // 重做，事务进行中时不可用
     bool redo();
     
-    // 清空操作历史
+    // 清空操作历史，进行中的事务保持打开但丢弃已记录的操作
     void clear();
     
     // 检查是否可以撤销
@@ -195,11 +451,10 @@ public:
     size_t getRedoStackSize() const;
 
 private:
-    // 私有构造函数
-    UndoRedoManager() = default;
-    
     std::vector<std::shared_ptr<Operation>> m_undoStack;
     std::vector<std::shared_ptr<Operation>> m_redoStack;
+    std::shared_ptr<CompoundOperation> m_transaction; // 进行中的事务
+    size_t m_transactionDepth = 0;                    // 事务嵌套层数
     const size_t m_maxStackSize = 100; // 最大栈大小
 };
 
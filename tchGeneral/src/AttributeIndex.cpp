@@ -0,0 +1,228 @@
+#include "AttributeIndex.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace tch {
+
+// 分页位集实现
+
+// 设置单个句柄
+void PagedBitmap::set(std::uint32_t handle) {
+    std::size_t pageIndex = handle / kPageBits;
+    if (pageIndex >= m_pages.size()) {
+        m_pages.resize(pageIndex + 1);
+    }
+    
+    PageSlot& slot = m_pages[pageIndex];
+    if (!slot.words) {
+        slot.words = std::make_unique<Page>();
+    }
+    std::uint64_t& word = (*slot.words)[(handle % kPageBits) / 64];
+    std::uint64_t mask = std::uint64_t(1) << (handle % 64);
+    if (!(word & mask)) {
+        word |= mask;
+        ++slot.count;
+        ++m_count;
+    }
+}
+
+// 清除单个句柄
+void PagedBitmap::reset(std::uint32_t handle) {
+    std::size_t pageIndex = handle / kPageBits;
+    if (pageIndex >= m_pages.size() || !m_pages[pageIndex].words) {
+        return;
+    }
+    
+    PageSlot& slot = m_pages[pageIndex];
+    std::uint64_t& word = (*slot.words)[(handle % kPageBits) / 64];
+    std::uint64_t mask = std::uint64_t(1) << (handle % 64);
+    if (!(word & mask)) {
+        return;
+    }
+    word &= ~mask;
+    --slot.count;
+    --m_count;
+    
+    // 空页立即释放，页表末尾的空项一并收缩
+    if (slot.count == 0) {
+        slot.words.reset();
+        while (!m_pages.empty() && !m_pages.back().words) {
+            m_pages.pop_back();
+        }
+    }
+}
+
+// 句柄是否在集合中
+bool PagedBitmap::test(std::uint32_t handle) const {
+    const Page* page = getPage(handle / kPageBits);
+    return page && ((*page)[(handle % kPageBits) / 64] >> (handle % 64)) & 1;
+}
+
+// 属性索引实现
+
+// 登记图形
+void AttributeIndex::insert(const Shape& shape) {
+    // 句柄0表示未加入图层的图形，不参与索引
+    std::uint32_t handle = shape.getHandle();
+    if (handle == 0) {
+        return;
+    }
+    if (handle >= m_typeColors.size()) {
+        m_typeColors.resize(handle + 1, 0);
+        m_layerIds.resize(handle + 1, 0);
+    }
+    
+    std::uint32_t typeColor = packTypeColor(shape.getType(), colorKey(shape.getColor()));
+    std::int32_t layerId = shape.getLayer();
+    std::uint32_t oldTypeColor = m_typeColors[handle];
+    if (oldTypeColor != 0) {
+        // 属性未变时不触碰位集
+        if (oldTypeColor == typeColor && m_layerIds[handle] == layerId) {
+            return;
+        }
+        unlink(handle, oldTypeColor, m_layerIds[handle]);
+    } else {
+        ++m_count;
+    }
+    
+    link(handle, typeColor, layerId);
+    m_typeColors[handle] = typeColor;
+    m_layerIds[handle] = layerId;
+}
+
+// 注销图形
+void AttributeIndex::erase(std::uint32_t handle) {
+    if (handle >= m_typeColors.size() || m_typeColors[handle] == 0) {
+        return;
+    }
+    unlink(handle, m_typeColors[handle], m_layerIds[handle]);
+    m_typeColors[handle] = 0;
+    --m_count;
+}
+
+// 图形属性可能已改变，重新登记
+void AttributeIndex::update(const Shape& shape) {
+    std::uint32_t handle = shape.getHandle();
+    if (handle < m_typeColors.size() && m_typeColors[handle] != 0) {
+        insert(shape);
+    }
+}
+
+// 清空索引
+void AttributeIndex::clear() {
+    m_typeColors.clear();
+    m_layerIds.clear();
+    m_byType = {};
+    m_byColor.clear();
+    m_byLayer.clear();
+    m_count = 0;
+}
+
+// 查询满足条件的句柄
+void AttributeIndex::query(const AttributeQuery& query, std::vector<std::uint32_t>& out) const {
+    std::array<const PagedBitmap*, 3> bitmaps{};
+    std::size_t bitmapCount = 0;
+    
+    if (query.type) {
+        bitmaps[bitmapCount++] = &m_byType[static_cast<std::size_t>(*query.type)];
+    }
+    if (query.layerId) {
+        auto it = m_byLayer.find(*query.layerId);
+        if (it == m_byLayer.end()) {
+            return;
+        }
+        bitmaps[bitmapCount++] = &it->second;
+    }
+    if (query.color) {
+        auto it = m_byColor.find(colorKey(*query.color));
+        if (it == m_byColor.end()) {
+            return;
+        }
+        bitmaps[bitmapCount++] = &it->second;
+    }
+    
+    // 无条件时结果即全部已登记的图形
+    if (bitmapCount == 0) {
+        out.reserve(out.size() + m_count);
+        for (std::uint32_t handle = 1; handle < m_typeColors.size(); ++handle) {
+            if (m_typeColors[handle] != 0) {
+                out.push_back(handle);
+            }
+        }
+        return;
+    }
+    
+    // 以成员最少的位集驱动，其余位集只在对应页上按字求交
+    std::sort(bitmaps.begin(), bitmaps.begin() + bitmapCount, [](const PagedBitmap* a, const PagedBitmap* b) {
+        return a->size() < b->size();
+    });
+    const PagedBitmap& driver = *bitmaps[0];
+    out.reserve(out.size() + driver.size());
+    
+    std::array<const PagedBitmap::Page*, 3> pages{};
+    for (std::size_t pageIndex = 0; pageIndex < driver.getPageCount(); ++pageIndex) {
+        bool empty = false;
+        for (std::size_t i = 0; i < bitmapCount && !empty; ++i) {
+            pages[i] = bitmaps[i]->getPage(pageIndex);
+            empty = pages[i] == nullptr;
+        }
+        if (empty) {
+            continue;
+        }
+        
+        std::uint32_t pageBase = static_cast<std::uint32_t>(pageIndex * PagedBitmap::kPageBits);
+        for (std::size_t word = 0; word < PagedBitmap::kPageWords; ++word) {
+            std::uint64_t bits = (*pages[0])[word];
+            for (std::size_t i = 1; i < bitmapCount; ++i) {
+                bits &= (*pages[i])[word];
+            }
+            for (; bits != 0; bits &= bits - 1) {
+                out.push_back(pageBase + static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits)));
+            }
+        }
+    }
+}
+
+// 颜色的索引键
+std::uint32_t AttributeIndex::colorKey(const glm::vec3& color) {
+    auto quantize = [](float value) {
+        return static_cast<std::uint32_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    };
+    return (quantize(color.r) << 16) | (quantize(color.g) << 8) | quantize(color.b);
+}
+
+// 将句柄加入各位集
+void AttributeIndex::link(std::uint32_t handle, std::uint32_t typeColor, std::int32_t layerId) {
+    m_byType[(typeColor >> 24) - 1].set(handle);
+    m_byColor[typeColor & 0xFFFFFF].set(handle);
+    m_byLayer[layerId].set(handle);
+}
+
+// 将句柄从各位集中移除，颜色与图层位集清空后删除
+void AttributeIndex::unlink(std::uint32_t handle, std::uint32_t typeColor, std::int32_t layerId) {
+    m_byType[(typeColor >> 24) - 1].reset(handle);
+    
+    auto colorIt = m_byColor.find(typeColor & 0xFFFFFF);
+    if (colorIt != m_byColor.end()) {
+        colorIt->second.reset(handle);
+        if (colorIt->second.empty()) {
+            m_byColor.erase(colorIt);
+        }
+    }
+    
+    auto layerIt = m_byLayer.find(layerId);
+    if (layerIt != m_byLayer.end()) {
+        layerIt->second.reset(handle);
+        if (layerIt->second.empty()) {
+            m_byLayer.erase(layerIt);
+        }
+    }
+}
+
+// 类型与颜色打包为一个键
+std::uint32_t AttributeIndex::packTypeColor(ShapeType type, std::uint32_t colorKey) {
+    return ((static_cast<std::uint32_t>(type) + 1) << 24) | colorKey;
+}
+
+} // namespace tch
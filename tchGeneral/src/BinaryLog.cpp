@@ -0,0 +1,399 @@
+#include "BinaryLog.h"
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <iterator>
+
+namespace tch {
+
+namespace {
+
+constexpr char kBinaryLogMagic[4] = {'T', 'C', 'H', 'L'};
+constexpr std::uint64_t kBinaryLogVersion = 1;
+
+// 记录类型，魔数的第一个字节也作为记录类型出现，表示新会话的文件头
+enum class BinaryLogRecord : std::uint8_t {
+    Format = 1,     // 格式字符串定义：字符串
+    Site = 2,       // 源码位置定义：文件名、行号、函数名
+    Message = 3     // 日志：级别、时间差、位置编号、格式编号、参数
+};
+
+constexpr std::size_t kBinaryLogMaxString = 1 << 24; // 解码时允许的最大字符串长度，超过视为数据损坏
+
+// 按替换域的下标与格式说明格式化一个参数
+void formatBinaryLogField(std::string& out, std::string_view spec, const BinaryLogArg& arg) {
+    std::string fieldFormat;
+    fieldFormat.reserve(spec.size() + 2);
+    fieldFormat += '{';
+    fieldFormat += spec;
+    fieldFormat += '}';
+    std::visit([&out, &fieldFormat](const auto& value) {
+        std::vformat_to(std::back_inserter(out), fieldFormat, std::make_format_args(value));
+    }, arg);
+}
+
+} // namespace
+
+// 编码实现
+
+// 开始新的会话
+void BinaryLogWriter::reset() {
+    m_buffer.clear();
+    m_formatIds.clear();
+    m_siteIds.clear();
+    m_lastMicros = 0;
+    m_buffer.append(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+    appendVarint(kBinaryLogVersion);
+}
+
+// 开始一条日志记录
+void BinaryLogWriter::beginMessage(int level, std::int64_t micros, const Site& site, const char* format) {
+    auto formatIt = m_formatIds.find(format);
+    if (formatIt == m_formatIds.end()) {
+        formatIt = m_formatIds.emplace(format, static_cast<std::uint32_t>(m_formatIds.size())).first;
+        m_buffer.push_back(static_cast<char>(BinaryLogRecord::Format));
+        appendString(format);
+    }
+    
+    SiteKey key{ site.file, site.line, site.function };
+    auto siteIt = m_siteIds.find(key);
+    if (siteIt == m_siteIds.end()) {
+        siteIt = m_siteIds.emplace(key, static_cast<std::uint32_t>(m_siteIds.size())).first;
+        m_buffer.push_back(static_cast<char>(BinaryLogRecord::Site));
+        appendString(site.file);
+        appendVarint(site.line);
+        appendString(site.function);
+    }
+    
+    // 多个线程的日志进入队列的顺序与取时间的顺序可能不同，时间差可以为负
+    m_buffer.push_back(static_cast<char>(BinaryLogRecord::Message));
+    m_buffer.push_back(static_cast<char>(level));
+    appendSigned(micros - m_lastMicros);
+    m_lastMicros = micros;
+    appendVarint(siteIt->second);
+    appendVarint(formatIt->second);
+}
+
+// 结束当前日志记录
+void BinaryLogWriter::endMessage() {
+    appendTag(BinaryLogArgType::End);
+}
+
+// 写入无符号变长整数：每字节7位，最高位表示后面还有字节
+void BinaryLogWriter::appendVarint(std::uint64_t value) {
+    while (value >= 0x80) {
+        m_buffer.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    m_buffer.push_back(static_cast<char>(value));
+}
+
+// 写入有符号变长整数
+void BinaryLogWriter::appendSigned(std::int64_t value) {
+    appendVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+// 写入4字节小端浮点数
+void BinaryLogWriter::appendFloat(float value) {
+    std::uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; ++i) {
+        m_buffer.push_back(static_cast<char>(bits >> (i * 8)));
+    }
+}
+
+// 写入8字节小端浮点数
+void BinaryLogWriter::appendDouble(double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        m_buffer.push_back(static_cast<char>(bits >> (i * 8)));
+    }
+}
+
+// 写入长度加字节的字符串
+void BinaryLogWriter::appendString(std::string_view str) {
+    appendVarint(str.size());
+    m_buffer.append(str.data(), str.size());
+}
+
+// 解码实现
+
+BinaryLogReader::BinaryLogReader(std::istream& input) : m_input(input) {}
+
+// 读取下一条日志，定义记录与文件头在这里一并处理
+bool BinaryLogReader::next(BinaryLogEntry& entry) {
+    if (!m_error.empty()) {
+        return false;
+    }
+    
+    while (true) {
+        int type = m_input.rdbuf()->sbumpc();
+        if (type == std::char_traits<char>::eof()) {
+            return m_headerRead ? false : fail("missing header");
+        }
+        if (type == kBinaryLogMagic[0]) {
+            if (!readHeader()) {
+                return false;
+            }
+            continue;
+        }
+        if (!m_headerRead) {
+            return fail("missing header");
+        }
+        
+        switch (static_cast<BinaryLogRecord>(type)) {
+            case BinaryLogRecord::Format: {
+                std::string format;
+                if (!readString(format)) {
+                    return false;
+                }
+                m_formats.push_back(std::move(format));
+                break;
+            }
+            case BinaryLogRecord::Site: {
+                SiteDefinition site;
+                std::uint64_t line = 0;
+                if (!readString(site.file) || !readVarint(line) || !readString(site.function)) {
+                    return false;
+                }
+                site.line = static_cast<std::uint32_t>(line);
+                m_sites.push_back(std::move(site));
+                break;
+            }
+            case BinaryLogRecord::Message: {
+                std::uint8_t level = 0;
+                std::uint64_t delta = 0;
+                std::uint64_t siteId = 0;
+                std::uint64_t formatId = 0;
+                if (!readByte(level) || !readVarint(delta) || !readVarint(siteId) || !readVarint(formatId)) {
+                    return false;
+                }
+                if (siteId >= m_sites.size() || formatId >= m_formats.size()) {
+                    return fail("undefined site or format id");
+                }
+                m_lastMicros += static_cast<std::int64_t>(delta >> 1) ^ -static_cast<std::int64_t>(delta & 1);
+                
+                const SiteDefinition& site = m_sites[siteId];
+                entry.level = level;
+                entry.micros = m_lastMicros;
+                entry.file = site.file;
+                entry.line = site.line;
+                entry.function = site.function;
+                entry.format = m_formats[formatId];
+                return readArgs(entry.args);
+            }
+            default:
+                return fail(std::format("unknown record type {}", type));
+        }
+    }
+}
+
+// 读取文件头剩余的部分并开始新的会话
+bool BinaryLogReader::readHeader() {
+    char magic[sizeof(kBinaryLogMagic) - 1];
+    std::uint64_t version = 0;
+    if (!readBytes(magic, sizeof(magic)) || !readVarint(version)) {
+        return false;
+    }
+    if (std::memcmp(magic, kBinaryLogMagic + 1, sizeof(magic)) != 0) {
+        return fail("bad magic");
+    }
+    if (version != kBinaryLogVersion) {
+        return fail(std::format("unsupported version {}", version));
+    }
+    
+    m_formats.clear();
+    m_sites.clear();
+    m_lastMicros = 0;
+    m_headerRead = true;
+    return true;
+}
+
+// 读取参数直到结束标记
+bool BinaryLogReader::readArgs(std::vector<BinaryLogArg>& args) {
+    args.clear();
+    while (true) {
+        std::uint8_t type = 0;
+        if (!readByte(type)) {
+            return false;
+        }
+        switch (static_cast<BinaryLogArgType>(type)) {
+            case BinaryLogArgType::End:
+                return true;
+            case BinaryLogArgType::Bool:
+            case BinaryLogArgType::Char: {
+                std::uint8_t value = 0;
+                if (!readByte(value)) {
+                    return false;
+                }
+                if (static_cast<BinaryLogArgType>(type) == BinaryLogArgType::Bool) {
+                    args.emplace_back(value != 0);
+                } else {
+                    args.emplace_back(static_cast<char>(value));
+                }
+                break;
+            }
+            case BinaryLogArgType::Int:
+            case BinaryLogArgType::UInt: {
+                std::uint64_t value = 0;
+                if (!readVarint(value)) {
+                    return false;
+                }
+                if (static_cast<BinaryLogArgType>(type) == BinaryLogArgType::Int) {
+                    args.emplace_back(static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1));
+                } else {
+                    args.emplace_back(value);
+                }
+                break;
+            }
+            case BinaryLogArgType::Float: {
+                std::uint8_t bytes[4];
+                if (!readBytes(bytes, sizeof(bytes))) {
+                    return false;
+                }
+                std::uint32_t bits = 0;
+                for (int i = 0; i < 4; ++i) {
+                    bits |= static_cast<std::uint32_t>(bytes[i]) << (i * 8);
+                }
+                float value = 0.0f;
+                std::memcpy(&value, &bits, sizeof(value));
+                args.emplace_back(value);
+                break;
+            }
+            case BinaryLogArgType::Double: {
+                std::uint8_t bytes[8];
+                if (!readBytes(bytes, sizeof(bytes))) {
+                    return false;
+                }
+                std::uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i) {
+                    bits |= static_cast<std::uint64_t>(bytes[i]) << (i * 8);
+                }
+                double value = 0.0;
+                std::memcpy(&value, &bits, sizeof(value));
+                args.emplace_back(value);
+                break;
+            }
+            case BinaryLogArgType::String: {
+                std::string value;
+                if (!readString(value)) {
+                    return false;
+                }
+                args.emplace_back(std::move(value));
+                break;
+            }
+            default:
+                return fail(std::format("unknown argument type {}", type));
+        }
+    }
+}
+
+bool BinaryLogReader::readByte(std::uint8_t& value) {
+    int byte = m_input.rdbuf()->sbumpc();
+    if (byte == std::char_traits<char>::eof()) {
+        return fail("truncated record");
+    }
+    value = static_cast<std::uint8_t>(byte);
+    return true;
+}
+
+bool BinaryLogReader::readVarint(std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        std::uint8_t byte = 0;
+        if (!readByte(byte)) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return fail("bad varint");
+}
+
+bool BinaryLogReader::readString(std::string& str) {
+    std::uint64_t size = 0;
+    if (!readVarint(size)) {
+        return false;
+    }
+    if (size > kBinaryLogMaxString) {
+        return fail("string too long");
+    }
+    str.resize(static_cast<std::size_t>(size));
+    return readBytes(str.data(), str.size());
+}
+
+bool BinaryLogReader::readBytes(void* data, std::size_t size) {
+    if (static_cast<std::size_t>(m_input.rdbuf()->sgetn(static_cast<char*>(data), static_cast<std::streamsize>(size))) != size) {
+        return fail("truncated record");
+    }
+    return true;
+}
+
+// 记录数据损坏
+bool BinaryLogReader::fail(const std::string& error) {
+    if (m_error.empty()) {
+        m_error = error;
+    }
+    return false;
+}
+
+// 格式化实现
+
+// 按格式字符串与参数格式化消息
+void formatBinaryLogMessage(std::string& out, std::string_view format, const std::vector<BinaryLogArg>& args) {
+    std::size_t start = out.size();
+    try {
+        std::size_t nextIndex = 0; // 自动编号的下一个参数
+        std::size_t pos = 0;
+        while (pos < format.size()) {
+            std::size_t brace = format.find_first_of("{}", pos);
+            out.append(format.substr(pos, brace == std::string_view::npos ? std::string_view::npos : brace - pos));
+            if (brace == std::string_view::npos) {
+                break;
+            }
+            
+            // 转义的花括号
+            if (brace + 1 < format.size() && format[brace + 1] == format[brace]) {
+                out += format[brace];
+                pos = brace + 2;
+                continue;
+            }
+            if (format[brace] == '}') {
+                throw std::format_error("unmatched '}' in format string");
+            }
+            
+            std::size_t close = format.find('}', brace);
+            if (close == std::string_view::npos) {
+                throw std::format_error("unmatched '{' in format string");
+            }
+            std::string_view field = format.substr(brace + 1, close - brace - 1);
+            if (field.find('{') != std::string_view::npos) {
+                throw std::format_error("nested replacement fields are not supported");
+            }
+            
+            // 替换域为"[下标][:格式说明]"
+            std::size_t colon = field.find(':');
+            std::string_view indexText = field.substr(0, colon);
+            std::size_t index = nextIndex++;
+            if (!indexText.empty()) {
+                auto result = std::from_chars(indexText.data(), indexText.data() + indexText.size(), index);
+                if (result.ec != std::errc() || result.ptr != indexText.data() + indexText.size()) {
+                    throw std::format_error("invalid argument index");
+                }
+            }
+            if (index >= args.size()) {
+                throw std::format_error("argument index out of range");
+            }
+            formatBinaryLogField(out, colon == std::string_view::npos ? std::string_view() : field.substr(colon), args[index]);
+            pos = close + 1;
+        }
+    } catch (const std::exception& e) {
+        out.resize(start);
+        out += std::format("<format error: {}> {}", e.what(), format);
+    }
+}
+
+} // namespace tch
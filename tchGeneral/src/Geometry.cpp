@@ -1,5 +1,6 @@
 #include "Geometry.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <cmath>
 
 namespace tch {
@@ -73,6 +74,45 @@ namespace GeometryUtils {
         return glm::distance(point, closestPoint);
     }
     
+    // 计算点到线段的距离
+    float distanceToSegment(const glm::vec2& point, const glm::vec2& start, const glm::vec2& end) {
+        glm::vec2 direction = end - start;
+        float lengthSquared = glm::dot(direction, direction);
+        if (lengthSquared <= 0.0f) {
+            return glm::distance(point, start);
+        }
+        
+        float t = glm::clamp(glm::dot(point - start, direction) / lengthSquared, 0.0f, 1.0f);
+        return glm::distance(point, start + t * direction);
+    }
+    
+    // 线段是否与轴对齐矩形相交：按Liang-Barsky算法把线段裁剪到矩形内，裁剪后非空即相交
+    bool segmentIntersectsBox(const glm::vec2& start, const glm::vec2& end, const glm::vec2& minPoint, const glm::vec2& maxPoint) {
+        glm::vec2 direction = end - start;
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+        for (int axis = 0; axis < 2; ++axis) {
+            if (direction[axis] == 0.0f) {
+                // 与该轴的边界平行，起点在范围外时不相交
+                if (start[axis] < minPoint[axis] || start[axis] > maxPoint[axis]) {
+                    return false;
+                }
+                continue;
+            }
+            float tNear = (minPoint[axis] - start[axis]) / direction[axis];
+            float tFar = (maxPoint[axis] - start[axis]) / direction[axis];
+            if (tNear > tFar) {
+                std::swap(tNear, tFar);
+            }
+            t0 = std::max(t0, tNear);
+            t1 = std::min(t1, tFar);
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
     // 计算两条直线的交点
     bool intersectLines(const Line& line1, const Line& line2, glm::vec2& intersection) {
         glm::vec2 A = line1.getStart();
@@ -1,4 +1,6 @@
 #include "Layer.h"
+#include <algorithm>
+#include <unordered_set>
 
 namespace tch {
 
@@ -8,19 +10,106 @@ namespace tch {
 void Layer::addShape(const std::shared_ptr<Shape>& shape) {
     shape->setLayer(m_id);
     m_shapes.push_back(shape);
+    if (m_owner) {
+        m_owner->registerShape(shape);
+    }
+    invalidateChunksFrom(m_shapes.size() - 1);
 }
 
 // 移除图形
 void Layer::removeShape(const std::shared_ptr<Shape>& shape) {
     auto it = std::find(m_shapes.begin(), m_shapes.end(), shape);
     if (it != m_shapes.end()) {
+        // 之后的图形整体前移，所在块及之后的块都需重新计算
+        std::size_t index = static_cast<std::size_t>(it - m_shapes.begin());
+        if (m_owner) {
+            m_owner->unregisterShape(*shape);
+        }
         m_shapes.erase(it);
+        invalidateChunksFrom(index);
     }
 }
 
+// 批量添加图形
+void Layer::addShapes(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    if (shapes.empty()) {
+        return;
+    }
+    
+    if (m_owner) {
+        m_owner->prepareBulkChange(shapes.size());
+    }
+    std::size_t firstIndex = m_shapes.size();
+    m_shapes.reserve(firstIndex + shapes.size());
+    for (const auto& shape : shapes) {
+        shape->setLayer(m_id);
+        m_shapes.push_back(shape);
+        if (m_owner) {
+            m_owner->registerShape(shape);
+        }
+    }
+    invalidateChunksFrom(firstIndex);
+}
+
+// 批量移除图形
+void Layer::removeShapes(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    if (shapes.empty()) {
+        return;
+    }
+    if (m_owner) {
+        m_owner->prepareBulkChange(shapes.size());
+    }
+    
+    // 常见情况：要移除的正是最后批量添加的图形，直接截断
+    if (shapes.size() <= m_shapes.size() &&
+        std::equal(shapes.begin(), shapes.end(), m_shapes.end() - shapes.size())) {
+        std::size_t firstIndex = m_shapes.size() - shapes.size();
+        if (m_owner) {
+            for (const auto& shape : shapes) {
+                m_owner->unregisterShape(*shape);
+            }
+        }
+        m_shapes.resize(firstIndex);
+        invalidateChunksFrom(firstIndex);
+        return;
+    }
+    
+    std::unordered_set<const Shape*> removing;
+    removing.reserve(shapes.size());
+    for (const auto& shape : shapes) {
+        removing.insert(shape.get());
+    }
+    
+    auto first = std::find_if(m_shapes.begin(), m_shapes.end(), [&](const std::shared_ptr<Shape>& shape) {
+        return removing.contains(shape.get());
+    });
+    if (first == m_shapes.end()) {
+        return;
+    }
+    
+    std::size_t firstIndex = static_cast<std::size_t>(first - m_shapes.begin());
+    m_shapes.erase(std::remove_if(first, m_shapes.end(), [&](const std::shared_ptr<Shape>& shape) {
+        if (!removing.contains(shape.get())) {
+            return false;
+        }
+        if (m_owner) {
+            m_owner->unregisterShape(*shape);
+        }
+        return true;
+    }), m_shapes.end());
+    invalidateChunksFrom(firstIndex);
+}
+
 // 清空图形
 void Layer::clearShapes() {
+    if (m_owner) {
+        m_owner->prepareBulkChange(m_shapes.size());
+        for (const auto& shape : m_shapes) {
+            m_owner->unregisterShape(*shape);
+        }
+    }
     m_shapes.clear();
+    m_chunkHashes.clear();
 }
 
 // 获取图形列表
@@ -64,24 +153,95 @@ void Layer::draw() const {
     }
 }
 
+// 获取图层内容哈希
+std::uint64_t Layer::getHash() const {
+    std::uint64_t seed = HashUtils::mix(static_cast<std::uint64_t>(static_cast<std::int64_t>(m_id)));
+    seed = HashUtils::hashString(seed, m_name);
+    seed = HashUtils::combine(seed, m_visible ? 1 : 0);
+    seed = HashUtils::combine(seed, m_shapes.size());
+    for (std::size_t i = 0; i < getChunkCount(); ++i) {
+        seed = HashUtils::combine(seed, getChunkHash(i));
+    }
+    return seed;
+}
+
+// 获取哈希块数量
+std::size_t Layer::getChunkCount() const {
+    return (m_shapes.size() + kHashChunkSize - 1) / kHashChunkSize;
+}
+
+// 获取指定块的哈希
+std::uint64_t Layer::getChunkHash(std::size_t chunkIndex) const {
+    m_chunkHashes.resize(getChunkCount());
+    ChunkHash& chunk = m_chunkHashes[chunkIndex];
+    if (!chunk.valid) {
+        std::size_t begin = chunkIndex * kHashChunkSize;
+        std::size_t end = std::min(begin + kHashChunkSize, m_shapes.size());
+        std::uint64_t seed = HashUtils::mix(chunkIndex + 1);
+        for (std::size_t i = begin; i < end; ++i) {
+            seed = HashUtils::combine(seed, m_shapes[i]->hash());
+        }
+        chunk.hash = seed;
+        chunk.valid = true;
+    }
+    return chunk.hash;
+}
+
+// 图形被原地修改后调用，使其所在块的哈希失效
+void Layer::markShapeModified(const std::shared_ptr<Shape>& shape) {
+    auto it = std::find(m_shapes.begin(), m_shapes.end(), shape);
+    if (it != m_shapes.end()) {
+        std::size_t chunkIndex = static_cast<std::size_t>(it - m_shapes.begin()) / kHashChunkSize;
+        if (chunkIndex < m_chunkHashes.size()) {
+            m_chunkHashes[chunkIndex].valid = false;
+        }
+    }
+}
+
+// 一组图形被原地修改后调用
+void Layer::markShapesModified(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    if (shapes.size() == 1) {
+        markShapeModified(shapes.front());
+        return;
+    }
+    
+    std::unordered_set<const Shape*> modified;
+    modified.reserve(shapes.size());
+    for (const auto& shape : shapes) {
+        modified.insert(shape.get());
+    }
+    
+    m_chunkHashes.resize(getChunkCount());
+    for (std::size_t i = 0; i < m_shapes.size(); ++i) {
+        if (modified.contains(m_shapes[i].get())) {
+            m_chunkHashes[i / kHashChunkSize].valid = false;
+        }
+    }
+}
+
+// 使包含指定下标及其之后图形的块失效
+void Layer::invalidateChunksFrom(std::size_t shapeIndex) {
+    m_chunkHashes.resize(getChunkCount());
+    for (std::size_t i = shapeIndex / kHashChunkSize; i < m_chunkHashes.size(); ++i) {
+        m_chunkHashes[i].valid = false;
+    }
+}
+
 // 图层管理器实现
 
-// 私有构造函数
-LayerManager::LayerManager() : m_nextLayerId(0), m_currentLayerId(-1) {
+// 构造函数
+LayerManager::LayerManager() : m_spatialIndexValid(false), m_nextLayerId(0), m_currentLayerId(-1) {
+    // 句柄0保留，表示未分配
+    m_shapesByHandle.resize(1);
+    
     // 创建默认图层
     createLayer("Default");
 }
 
-// 获取单例实例
-LayerManager& LayerManager::getInstance() {
-    static LayerManager instance;
-    return instance;
-}
-
 // 创建新图层
 int LayerManager::createLayer(const std::string& name) {
     int layerId = m_nextLayerId++;
-    m_layers[layerId] = std::make_unique<Layer>(layerId, name);
+    m_layers[layerId] = std::make_unique<Layer>(layerId, name, this);
     
     if (m_currentLayerId == -1) {
         m_currentLayerId = layerId;
@@ -102,6 +262,10 @@ void LayerManager::deleteLayer(int layerId) {
         }
     }
     
+    // 图层上的图形随图层一起移除
+    if (Layer* layer = getLayer(layerId)) {
+        layer->clearShapes();
+    }
     m_layers.erase(layerId);
     
     if (m_layers.empty()) {
@@ -153,9 +317,127 @@ void LayerManager::draw() const {
     }
 }
 
+// 图形被原地修改后调用，通知其所在图层
+void LayerManager::markShapeModified(const std::shared_ptr<Shape>& shape) {
+    m_attributeIndex.update(*shape);
+    if (m_spatialIndexValid && getShape(shape->getHandle()) == shape) {
+        m_spatialIndex.insert(shape);
+    }
+    if (Layer* layer = getLayer(shape->getLayer())) {
+        layer->markShapeModified(shape);
+    }
+}
+
+// 一组图形被原地修改后调用
+void LayerManager::markShapesModified(const std::vector<std::shared_ptr<Shape>>& shapes) {
+    prepareBulkChange(shapes.size());
+    
+    // 按图层分组，每个图层只遍历一次
+    std::unordered_map<int, std::vector<std::shared_ptr<Shape>>> byLayer;
+    for (const auto& shape : shapes) {
+        m_attributeIndex.update(*shape);
+        if (m_spatialIndexValid && getShape(shape->getHandle()) == shape) {
+            m_spatialIndex.insert(shape);
+        }
+        byLayer[shape->getLayer()].push_back(shape);
+    }
+    for (const auto& [layerId, layerShapes] : byLayer) {
+        if (Layer* layer = getLayer(layerId)) {
+            layer->markShapesModified(layerShapes);
+        }
+    }
+}
+
+// 按句柄获取图形
+std::shared_ptr<Shape> LayerManager::getShape(std::uint32_t handle) const {
+    return handle < m_shapesByHandle.size() ? m_shapesByHandle[handle] : nullptr;
+}
+
+// 句柄上限
+std::uint32_t LayerManager::getHandleLimit() const {
+    return static_cast<std::uint32_t>(m_shapesByHandle.size());
+}
+
+// 获取属性索引
+const AttributeIndex& LayerManager::getAttributeIndex() const {
+    return m_attributeIndex;
+}
+
+// 获取空间索引，失效或增量修改使网格失衡时整体重建
+const SpatialIndex& LayerManager::getSpatialIndex() const {
+    if (!m_spatialIndexValid || m_spatialIndex.needsRebuild()) {
+        m_spatialIndex.build(*this);
+        m_spatialIndexValid = true;
+    }
+    return m_spatialIndex;
+}
+
+// 登记加入图层的图形
+void LayerManager::registerShape(const std::shared_ptr<Shape>& shape) {
+    std::uint32_t handle = shape->getHandle();
+    if (handle == 0 || handle >= m_shapesByHandle.size()) {
+        if (handle == 0) {
+            handle = static_cast<std::uint32_t>(m_shapesByHandle.size());
+            shape->setHandle(handle);
+        }
+        m_shapesByHandle.resize(handle + 1);
+    }
+    m_shapesByHandle[handle] = shape;
+    m_attributeIndex.insert(*shape);
+    if (m_spatialIndexValid) {
+        m_spatialIndex.insert(shape);
+    }
+}
+
+// 注销移出图层的图形
+void LayerManager::unregisterShape(const Shape& shape) {
+    std::uint32_t handle = shape.getHandle();
+    if (handle < m_shapesByHandle.size() && m_shapesByHandle[handle].get() == &shape) {
+        m_shapesByHandle[handle].reset();
+        m_attributeIndex.erase(handle);
+        if (m_spatialIndexValid) {
+            m_spatialIndex.erase(handle);
+        }
+    }
+}
+
+// 批量修改前调用，逐个更新不如整体重建时丢弃空间索引
+void LayerManager::prepareBulkChange(std::size_t count) {
+    if (m_spatialIndexValid && count * 4 > m_spatialIndex.size()) {
+        m_spatialIndex.clear();
+        m_spatialIndexValid = false;
+    }
+}
+
+// 获取全部图层的内容哈希，按图层ID排序后合并，与存储顺序无关
+std::uint64_t LayerManager::getHash() const {
+    std::vector<const Layer*> layers;
+    layers.reserve(m_layers.size());
+    for (const auto& pair : m_layers) {
+        layers.push_back(pair.second.get());
+    }
+    std::sort(layers.begin(), layers.end(), [](const Layer* a, const Layer* b) {
+        return a->getId() < b->getId();
+    });
+    
+    std::uint64_t seed = HashUtils::mix(layers.size());
+    for (const Layer* layer : layers) {
+        seed = HashUtils::combine(seed, layer->getHash());
+    }
+    return seed;
+}
+
 // 清空所有图层
 void LayerManager::clearAllLayers() {
     m_layers.clear();
+    
+    // 句柄继续递增不复用，旧句柄全部失效
+    for (auto& shape : m_shapesByHandle) {
+        shape.reset();
+    }
+    m_attributeIndex.clear();
+    m_spatialIndex.clear();
+    m_spatialIndexValid = false;
     m_nextLayerId = 0;
     m_currentLayerId = -1;
     createLayer("Default");
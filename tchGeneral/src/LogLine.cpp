@@ -0,0 +1,86 @@
+#include "LogLine.h"
+#include <charconv>
+#include <iterator>
+#include <ctime>
+
+namespace tch {
+
+namespace {
+
+// 级别名称，顺序与Logger::LogLevel一致
+constexpr std::string_view kLogLevelNames[] = { "Trace", "Debug", "Info", "Warning", "Error", "Fatal" };
+constexpr int kLogLevelCount = static_cast<int>(std::size(kLogLevelNames));
+
+// 追加用空格补齐到width的文本，alignRight为true时右对齐
+void appendLogField(std::string& out, std::string_view text, std::size_t width, bool alignRight) {
+    std::size_t padding = text.size() < width ? width - text.size() : 0;
+    if (alignRight) {
+        out.append(padding, ' ');
+    }
+    out += text;
+    if (!alignRight) {
+        out.append(padding, ' ');
+    }
+}
+
+} // namespace
+
+// 追加行首
+void LogLineFormatter::appendPrefix(std::string& out, const LogLinePrefix& prefix) {
+    char line[16];
+    char* lineEnd = std::to_chars(line, line + sizeof(line), prefix.line).ptr;
+    
+    out += prefix.levelColor;
+    out += "[ ";
+    appendLogField(out, levelName(prefix.level), 8, false);
+    out += " ]";
+    out += prefix.resetColor;
+    out += "[ ";
+    appendTimestamp(out, prefix.time);
+    out += " ] [ ";
+    appendLogField(out, prefix.file, 20, true);
+    out += " : ";
+    appendLogField(out, std::string_view(line, static_cast<std::size_t>(lineEnd - line)), 4, true);
+    out += " : ";
+    appendLogField(out, prefix.function, 30, false);
+    out += " ]: ";
+}
+
+// 级别名称
+std::string_view LogLineFormatter::levelName(int level) {
+    return level >= 0 && level < kLogLevelCount ? kLogLevelNames[level] : kLogLevelNames[kLogLevelCount - 1];
+}
+
+// 按名称查找级别
+int LogLineFormatter::findLevel(std::string_view name) {
+    for (int level = 0; level < kLogLevelCount; ++level) {
+        if (kLogLevelNames[level] == name) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+// 追加时间，到秒为止的部分在秒变化时才重新格式化
+void LogLineFormatter::appendTimestamp(std::string& out, std::chrono::system_clock::time_point time) {
+    auto seconds = std::chrono::floor<std::chrono::seconds>(time);
+    std::int64_t second = seconds.time_since_epoch().count();
+    if (second != m_cachedSecond) {
+        std::time_t timeC = static_cast<std::time_t>(second);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &timeC);
+#else
+        localtime_r(&timeC, &local);
+#endif
+        std::strftime(m_cachedSecondText, sizeof(m_cachedSecondText), "%Y-%m-%d %H:%M:%S", &local);
+        m_cachedSecond = second;
+    }
+    
+    int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(time - seconds).count());
+    char millis[4] = { '.', static_cast<char>('0' + ms / 100), static_cast<char>('0' + ms / 10 % 10), static_cast<char>('0' + ms % 10) };
+    out += m_cachedSecondText;
+    out.append(millis, sizeof(millis));
+}
+
+} // namespace tch
@@ -1,146 +1,664 @@
 #include "SaveLoad.h"
 #include "Layer.h"
 #include "Geometry.h"
+#include "Progress.h"
+#include <cstdio>
 #include <fstream>
+#include <charconv>
+#include <string_view>
+#include <cctype>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 
 namespace tch {
 
+namespace {
+
+// DXF输出缓冲区：组码与数值均使用std::to_chars直接格式化到大块连续内存中，避免iostream的格式化开销
+class DxfBuffer {
+public:
+    explicit DxfBuffer(std::size_t reserveSize = 1 << 20) {
+        m_data.reserve(reserveSize);
+    }
+    
+    // 字符串组
+    void group(int code, std::string_view value) {
+        appendCode(code);
+        m_data.append(value);
+        m_data.push_back('\n');
+    }
+    
+    // 字符串字面量组，避免被隐式转换为bool/int重载
+    void group(int code, const char* value) {
+        group(code, std::string_view(value));
+    }
+    
+    // 整数组
+    void group(int code, int value) {
+        appendCode(code);
+        appendNumber(value);
+    }
+    
+    // 浮点组，图形数据为单精度，使用float的最短表示输出，避免0.1被输出为0.10000000149011612
+    void group(int code, float value) {
+        appendCode(code);
+        appendNumber(value);
+    }
+    
+    // 句柄组，十六进制大写
+    void handle(int code, std::uint64_t value) {
+        appendCode(code);
+        char buf[32];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value, 16);
+        for (char* p = buf; p != result.ptr; ++p) {
+            *p = static_cast<char>(std::toupper(static_cast<unsigned char>(*p)));
+        }
+        m_data.append(buf, result.ptr);
+        m_data.push_back('\n');
+    }
+    
+    // 二维坐标点，组码为10/20（或11/21等），R12与R2000均额外输出Z=0
+    void point(int baseCode, const glm::vec2& p) {
+        group(baseCode, p.x);
+        group(baseCode + 10, p.y);
+        group(baseCode + 20, 0.0f);
+    }
+    
+    const std::string& data() const {
+        return m_data;
+    }
+
+private:
+    // 组码右对齐到3个字符宽度，与AutoCAD输出格式保持一致
+    void appendCode(int code) {
+        char buf[16];
+        auto result = std::to_chars(buf, buf + sizeof(buf), code);
+        std::size_t len = static_cast<std::size_t>(result.ptr - buf);
+        if (len < 3) {
+            m_data.append(3 - len, ' ');
+        }
+        m_data.append(buf, result.ptr);
+        m_data.push_back('\n');
+    }
+    
+    template <typename T>
+    void appendNumber(T value) {
+        char buf[64];
+        auto result = std::to_chars(buf, buf + sizeof(buf), value);
+        m_data.append(buf, result.ptr);
+        m_data.push_back('\n');
+    }
+    
+    std::string m_data;
+};
+
+// R2000固定对象句柄，实体句柄从kDxfFirstEntityHandle开始连续分配
+constexpr std::uint64_t kDxfBlockRecordTableHandle = 0x1;
+constexpr std::uint64_t kDxfLayerTableHandle = 0x2;
+constexpr std::uint64_t kDxfStyleTableHandle = 0x3;
+constexpr std::uint64_t kDxfLtypeTableHandle = 0x5;
+constexpr std::uint64_t kDxfViewTableHandle = 0x6;
+constexpr std::uint64_t kDxfUcsTableHandle = 0x7;
+constexpr std::uint64_t kDxfVportTableHandle = 0x8;
+constexpr std::uint64_t kDxfAppIdTableHandle = 0x9;
+constexpr std::uint64_t kDxfDimStyleTableHandle = 0xA;
+constexpr std::uint64_t kDxfRootDictionaryHandle = 0xC;
+constexpr std::uint64_t kDxfGroupDictionaryHandle = 0xD;
+constexpr std::uint64_t kDxfAppIdAcadHandle = 0x12;
+constexpr std::uint64_t kDxfLtypeByBlockHandle = 0x14;
+constexpr std::uint64_t kDxfLtypeByLayerHandle = 0x15;
+constexpr std::uint64_t kDxfLtypeContinuousHandle = 0x16;
+constexpr std::uint64_t kDxfModelSpaceRecordHandle = 0x1F;
+constexpr std::uint64_t kDxfPaperSpaceRecordHandle = 0x1B;
+constexpr std::uint64_t kDxfModelSpaceBlockHandle = 0x20;
+constexpr std::uint64_t kDxfModelSpaceEndBlkHandle = 0x21;
+constexpr std::uint64_t kDxfPaperSpaceBlockHandle = 0x1C;
+constexpr std::uint64_t kDxfPaperSpaceEndBlkHandle = 0x1D;
+constexpr std::uint64_t kDxfStyleStandardHandle = 0x11;
+constexpr std::uint64_t kDxfFirstLayerHandle = 0x100;
+
+// 图形数量超过该值且存在多个图层时，并行生成各图层的实体段
+constexpr std::size_t kDxfParallelShapeThreshold = 20000;
+
+// 将RGB颜色映射到最接近的AutoCAD颜色索引（ACI），R2000不支持真彩色组码420
+int toAciColor(const glm::vec3& color) {
+    struct AciEntry {
+        int index;
+        float r, g, b;
+    };
+    static constexpr AciEntry palette[] = {
+        {1, 1.0f, 0.0f, 0.0f},      // 红
+        {2, 1.0f, 1.0f, 0.0f},      // 黄
+        {3, 0.0f, 1.0f, 0.0f},      // 绿
+        {4, 0.0f, 1.0f, 1.0f},      // 青
+        {5, 0.0f, 0.0f, 1.0f},      // 蓝
+        {6, 1.0f, 0.0f, 1.0f},      // 品红
+        {7, 1.0f, 1.0f, 1.0f},      // 白/黑（随背景）
+        {8, 0.5f, 0.5f, 0.5f},      // 深灰
+        {9, 0.75f, 0.75f, 0.75f},   // 浅灰
+    };
+    
+    // 纯黑在DXF中同样使用7号色，由查看器根据背景反色；近黑与近白先于最近色查找处理，
+    // 否则黑色离8号深灰更近，会被导出为灰色
+    float darkest = std::min({color.r, color.g, color.b});
+    float brightest = std::max({color.r, color.g, color.b});
+    if (brightest <= 0.25f || darkest >= 0.875f) {
+        return 7;
+    }
+    
+    int best = 7;
+    float bestDistance = std::numeric_limits<float>::max();
+    for (const auto& entry : palette) {
+        float dr = color.r - entry.r;
+        float dg = color.g - entry.g;
+        float db = color.b - entry.b;
+        float distance = dr * dr + dg * dg + db * db;
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = entry.index;
+        }
+    }
+    return best;
+}
+
+// 输出实体公共部分：类型、句柄、所属图层、颜色
+void writeEntityHeader(DxfBuffer& out, std::string_view type, std::string_view layerName, const Shape& shape, DxfVersion version, std::uint64_t handle) {
+    out.group(0, type);
+    if (version == DxfVersion::R2000) {
+        out.handle(5, handle);
+        out.handle(330, kDxfModelSpaceRecordHandle);
+        out.group(100, "AcDbEntity");
+    }
+    out.group(8, layerName);
+    out.group(62, toAciColor(shape.getColor()));
+}
+
+// 输出单个图层上的所有实体，句柄从firstHandle开始连续分配；已请求取消时提前结束
+void writeLayerEntities(DxfBuffer& out, const Layer& layer, DxfVersion version, std::uint64_t firstHandle, ProgressMonitor* progress) {
+    const std::string layerName = layer.getName();
+    std::uint64_t handle = firstHandle;
+    std::size_t pending = 0;
+    
+    for (const auto& shape : layer.getShapes()) {
+        if (!ProgressMonitor::step(progress, pending)) {
+            return;
+        }
+        switch (shape->getType()) {
+        case ShapeType::POINT: {
+            const auto& point = static_cast<const Point&>(*shape);
+            writeEntityHeader(out, "POINT", layerName, point, version, handle++);
+            if (version == DxfVersion::R2000) {
+                out.group(100, "AcDbPoint");
+            }
+            out.point(10, point.getPosition());
+            break;
+        }
+        case ShapeType::LINE: {
+            const auto& line = static_cast<const Line&>(*shape);
+            writeEntityHeader(out, "LINE", layerName, line, version, handle++);
+            if (version == DxfVersion::R2000) {
+                out.group(100, "AcDbLine");
+            }
+            out.point(10, line.getStart());
+            out.point(11, line.getEnd());
+            break;
+        }
+        case ShapeType::CIRCLE: {
+            const auto& circle = static_cast<const Circle&>(*shape);
+            writeEntityHeader(out, "CIRCLE", layerName, circle, version, handle++);
+            if (version == DxfVersion::R2000) {
+                out.group(100, "AcDbCircle");
+            }
+            out.point(10, circle.getCenter());
+            out.group(40, circle.getRadius());
+            break;
+        }
+        case ShapeType::RECTANGLE: {
+            const auto& rect = static_cast<const Rectangle&>(*shape);
+            glm::vec2 p0 = rect.getPosition();
+            glm::vec2 corners[4] = {
+                p0,
+                p0 + glm::vec2(rect.getWidth(), 0.0f),
+                p0 + glm::vec2(rect.getWidth(), rect.getHeight()),
+                p0 + glm::vec2(0.0f, rect.getHeight())
+            };
+            if (version == DxfVersion::R2000) {
+                // R2000使用轻量多段线
+                writeEntityHeader(out, "LWPOLYLINE", layerName, rect, version, handle++);
+                out.group(100, "AcDbPolyline");
+                out.group(90, 4);
+                out.group(70, 1); // 闭合
+                for (const auto& corner : corners) {
+                    out.group(10, corner.x);
+                    out.group(20, corner.y);
+                }
+            } else {
+                // R12使用POLYLINE + VERTEX + SEQEND
+                writeEntityHeader(out, "POLYLINE", layerName, rect, version, handle++);
+                out.group(66, 1);
+                out.point(10, glm::vec2(0.0f, 0.0f));
+                out.group(70, 1); // 闭合
+                for (const auto& corner : corners) {
+                    out.group(0, "VERTEX");
+                    out.group(8, layerName);
+                    out.point(10, corner);
+                }
+                out.group(0, "SEQEND");
+                out.group(8, layerName);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+// 符号表起始
+void writeTableBegin(DxfBuffer& out, std::string_view name, std::uint64_t handle, int count, DxfVersion version) {
+    out.group(0, "TABLE");
+    out.group(2, name);
+    if (version == DxfVersion::R2000) {
+        out.handle(5, handle);
+        out.handle(330, 0);
+        out.group(100, "AcDbSymbolTable");
+    }
+    out.group(70, count);
+}
+
+// 符号表记录公共部分
+void writeTableRecord(DxfBuffer& out, std::string_view type, std::string_view subclass, std::uint64_t handle, std::uint64_t owner, DxfVersion version) {
+    out.group(0, type);
+    if (version == DxfVersion::R2000) {
+        out.handle(5, handle);
+        out.handle(330, owner);
+        out.group(100, "AcDbSymbolTableRecord");
+        out.group(100, subclass);
+    }
+}
+
+// 线型记录
+void writeLtype(DxfBuffer& out, std::string_view name, std::string_view description, std::uint64_t handle, DxfVersion version) {
+    writeTableRecord(out, "LTYPE", "AcDbLinetypeTableRecord", handle, kDxfLtypeTableHandle, version);
+    out.group(2, name);
+    out.group(70, 0);
+    out.group(3, description);
+    out.group(72, 65);
+    out.group(73, 0);
+    out.group(40, 0.0f);
+}
+
+// 输出HEADER与TABLES段
+void writeDxfPrologue(DxfBuffer& out, const std::vector<const Layer*>& layers, bool needLayerZero, DxfVersion version, std::uint64_t handleSeed) {
+    const bool r2000 = version == DxfVersion::R2000;
+    
+    // HEADER
+    out.group(0, "SECTION");
+    out.group(2, "HEADER");
+    out.group(9, "$ACADVER");
+    out.group(1, r2000 ? "AC1015" : "AC1009");
+    if (r2000) {
+        out.group(9, "$HANDSEED");
+        out.handle(5, handleSeed);
+    }
+    out.group(0, "ENDSEC");
+    
+    // TABLES
+    out.group(0, "SECTION");
+    out.group(2, "TABLES");
+    
+    if (r2000) {
+        writeTableBegin(out, "VPORT", kDxfVportTableHandle, 0, version);
+        out.group(0, "ENDTAB");
+    }
+    
+    // 线型表：ByBlock、ByLayer仅R2000需要，Continuous两者都需要
+    writeTableBegin(out, "LTYPE", kDxfLtypeTableHandle, r2000 ? 3 : 1, version);
+    if (r2000) {
+        writeLtype(out, "ByBlock", "", kDxfLtypeByBlockHandle, version);
+        writeLtype(out, "ByLayer", "", kDxfLtypeByLayerHandle, version);
+    }
+    writeLtype(out, "Continuous", "Solid line", kDxfLtypeContinuousHandle, version);
+    out.group(0, "ENDTAB");
+    
+    // 图层表，DXF要求必须存在0层
+    int layerCount = static_cast<int>(layers.size()) + (needLayerZero ? 1 : 0);
+    writeTableBegin(out, "LAYER", kDxfLayerTableHandle, layerCount, version);
+    std::uint64_t layerHandle = kDxfFirstLayerHandle;
+    auto writeLayer = [&](std::string_view name, bool visible) {
+        writeTableRecord(out, "LAYER", "AcDbLayerTableRecord", layerHandle++, kDxfLayerTableHandle, version);
+        out.group(2, name);
+        out.group(70, 0);
+        out.group(62, visible ? 7 : -7); // 颜色为负表示图层关闭
+        out.group(6, "Continuous");
+    };
+    if (needLayerZero) {
+        writeLayer("0", true);
+    }
+    for (const Layer* layer : layers) {
+        writeLayer(layer->getName(), layer->isVisible());
+    }
+    out.group(0, "ENDTAB");
+    
+    // 文字样式表
+    writeTableBegin(out, "STYLE", kDxfStyleTableHandle, 1, version);
+    writeTableRecord(out, "STYLE", "AcDbTextStyleTableRecord", kDxfStyleStandardHandle, kDxfStyleTableHandle, version);
+    out.group(2, "Standard");
+    out.group(70, 0);
+    out.group(40, 0.0f);
+    out.group(41, 1.0f);
+    out.group(50, 0.0f);
+    out.group(71, 0);
+    out.group(42, 2.5f);
+    out.group(3, "txt");
+    out.group(4, "");
+    out.group(0, "ENDTAB");
+    
+    if (r2000) {
+        writeTableBegin(out, "VIEW", kDxfViewTableHandle, 0, version);
+        out.group(0, "ENDTAB");
+        writeTableBegin(out, "UCS", kDxfUcsTableHandle, 0, version);
+        out.group(0, "ENDTAB");
+        
+        writeTableBegin(out, "APPID", kDxfAppIdTableHandle, 1, version);
+        writeTableRecord(out, "APPID", "AcDbRegAppTableRecord", kDxfAppIdAcadHandle, kDxfAppIdTableHandle, version);
+        out.group(2, "ACAD");
+        out.group(70, 0);
+        out.group(0, "ENDTAB");
+        
+        writeTableBegin(out, "DIMSTYLE", kDxfDimStyleTableHandle, 0, version);
+        out.group(100, "AcDbDimStyleTable");
+        out.group(0, "ENDTAB");
+        
+        writeTableBegin(out, "BLOCK_RECORD", kDxfBlockRecordTableHandle, 2, version);
+        writeTableRecord(out, "BLOCK_RECORD", "AcDbBlockTableRecord", kDxfModelSpaceRecordHandle, kDxfBlockRecordTableHandle, version);
+        out.group(2, "*Model_Space");
+        writeTableRecord(out, "BLOCK_RECORD", "AcDbBlockTableRecord", kDxfPaperSpaceRecordHandle, kDxfBlockRecordTableHandle, version);
+        out.group(2, "*Paper_Space");
+        out.group(0, "ENDTAB");
+    }
+    out.group(0, "ENDSEC");
+    
+    // BLOCKS：R2000要求模型空间与图纸空间块定义
+    if (r2000) {
+        out.group(0, "SECTION");
+        out.group(2, "BLOCKS");
+        auto writeBlock = [&](std::string_view name, std::uint64_t blockHandle, std::uint64_t endBlkHandle, std::uint64_t recordHandle) {
+            out.group(0, "BLOCK");
+            out.handle(5, blockHandle);
+            out.handle(330, recordHandle);
+            out.group(100, "AcDbEntity");
+            out.group(8, "0");
+            out.group(100, "AcDbBlockBegin");
+            out.group(2, name);
+            out.group(70, 0);
+            out.point(10, glm::vec2(0.0f, 0.0f));
+            out.group(3, name);
+            out.group(1, "");
+            out.group(0, "ENDBLK");
+            out.handle(5, endBlkHandle);
+            out.handle(330, recordHandle);
+            out.group(100, "AcDbEntity");
+            out.group(8, "0");
+            out.group(100, "AcDbBlockEnd");
+        };
+        writeBlock("*Model_Space", kDxfModelSpaceBlockHandle, kDxfModelSpaceEndBlkHandle, kDxfModelSpaceRecordHandle);
+        writeBlock("*Paper_Space", kDxfPaperSpaceBlockHandle, kDxfPaperSpaceEndBlkHandle, kDxfPaperSpaceRecordHandle);
+        out.group(0, "ENDSEC");
+    }
+    
+    // ENTITIES段开始，实体内容由各图层缓冲区拼接
+    out.group(0, "SECTION");
+    out.group(2, "ENTITIES");
+}
+
+// 输出ENTITIES段结束以及OBJECTS段
+void writeDxfEpilogue(DxfBuffer& out, DxfVersion version) {
+    out.group(0, "ENDSEC");
+    
+    if (version == DxfVersion::R2000) {
+        out.group(0, "SECTION");
+        out.group(2, "OBJECTS");
+        out.group(0, "DICTIONARY");
+        out.handle(5, kDxfRootDictionaryHandle);
+        out.handle(330, 0);
+        out.group(100, "AcDbDictionary");
+        out.group(281, 1);
+        out.group(3, "ACAD_GROUP");
+        out.handle(350, kDxfGroupDictionaryHandle);
+        out.group(0, "DICTIONARY");
+        out.handle(5, kDxfGroupDictionaryHandle);
+        out.handle(330, kDxfRootDictionaryHandle);
+        out.group(100, "AcDbDictionary");
+        out.group(281, 1);
+        out.group(0, "ENDSEC");
+    }
+    
+    out.group(0, "EOF");
+}
+
+// 写入二维坐标对象
+void writeJsonVec2(rapidjson::Writer<rapidjson::StringBuffer>& writer, const char* key, const glm::vec2& value) {
+    writer.Key(key);
+    writer.StartObject();
+    writer.Key("x");
+    writer.Double(value.x);
+    writer.Key("y");
+    writer.Double(value.y);
+    writer.EndObject();
+}
+
+// 写入单个图形对象
+void writeShapeJson(rapidjson::Writer<rapidjson::StringBuffer>& writer, const Shape& shape) {
+    writer.StartObject();
+    
+    // 图形类型
+    writer.Key("type");
+    switch (shape.getType()) {
+    case ShapeType::POINT:
+        writer.String("POINT");
+        break;
+    case ShapeType::LINE:
+        writer.String("LINE");
+        break;
+    case ShapeType::CIRCLE:
+        writer.String("CIRCLE");
+        break;
+    case ShapeType::RECTANGLE:
+        writer.String("RECTANGLE");
+        break;
+    default:
+        writer.String("UNKNOWN");
+        break;
+    }
+    
+    // 颜色信息
+    auto color = shape.getColor();
+    writer.Key("color");
+    writer.StartObject();
+    writer.Key("r");
+    writer.Double(color.r);
+    writer.Key("g");
+    writer.Double(color.g);
+    writer.Key("b");
+    writer.Double(color.b);
+    writer.EndObject();
+    
+    // 特定图形的属性
+    switch (shape.getType()) {
+    case ShapeType::POINT:
+        writeJsonVec2(writer, "position", static_cast<const Point&>(shape).getPosition());
+        break;
+    case ShapeType::LINE: {
+        const auto& line = static_cast<const Line&>(shape);
+        writeJsonVec2(writer, "start", line.getStart());
+        writeJsonVec2(writer, "end", line.getEnd());
+        break;
+    }
+    case ShapeType::CIRCLE: {
+        const auto& circle = static_cast<const Circle&>(shape);
+        writeJsonVec2(writer, "center", circle.getCenter());
+        writer.Key("radius");
+        writer.Double(circle.getRadius());
+        break;
+    }
+    case ShapeType::RECTANGLE: {
+        const auto& rectangle = static_cast<const Rectangle&>(shape);
+        writeJsonVec2(writer, "position", rectangle.getPosition());
+        writer.Key("width");
+        writer.Double(rectangle.getWidth());
+        writer.Key("height");
+        writer.Double(rectangle.getHeight());
+        break;
+    }
+    }
+    
+    writer.EndObject();
+}
+
+// 序列化图层中一个哈希块内的图形，输出以逗号分隔的图形对象（不含外层方括号）
+std::string serializeShapeChunk(const Layer& layer, std::size_t chunkIndex) {
+    const auto& shapes = layer.getShapes();
+    std::size_t begin = chunkIndex * Layer::kHashChunkSize;
+    std::size_t end = std::min(begin + Layer::kHashChunkSize, shapes.size());
+    
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    for (std::size_t i = begin; i < end; ++i) {
+        if (i > begin) {
+            buffer.Put(',');
+        }
+        // 每个图形作为独立的根值写出
+        writer.Reset(buffer);
+        writeShapeJson(writer, *shapes[i]);
+    }
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+} // namespace
+
+
 // 保存图形到文件
-bool SaveLoad::saveToFile(const std::string& filePath) {
+bool SaveLoad::saveToFile(const LayerManager& layerManager, const std::string& filePath, JsonChunkCache* cache) {
     try {
-        // 创建文档
-        rapidjson::Document doc;
-        doc.SetObject();
-        auto& allocator = doc.GetAllocator();
+        // 按图层ID排序，保证相同内容得到相同输出
+        std::vector<const Layer*> layers;
+        layers.reserve(layerManager.getLayers().size());
+        for (const auto& pair : layerManager.getLayers()) {
+            layers.push_back(pair.second.get());
+        }
+        std::sort(layers.begin(), layers.end(), [](const Layer* a, const Layer* b) {
+            return a->getId() < b->getId();
+        });
+        
+        JsonChunkCache localCache;
+        JsonChunkCache& chunkCache = cache ? *cache : localCache;
+        chunkCache.reusedChunks = 0;
+        chunkCache.writtenChunks = 0;
+        
+        // 只保留现存图层的缓存
+        std::unordered_map<int, std::vector<JsonChunkCache::Chunk>> previousChunks;
+        previousChunks.swap(chunkCache.layers);
+        
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
         
         // 添加版本信息
-        doc.AddMember("version", "1.0", allocator);
+        writer.Key("version");
+        writer.String("1.0");
         
         // 添加图层信息
-        rapidjson::Value layers(rapidjson::kArrayType);
-        auto& layerManager = LayerManager::getInstance();
-        auto& allLayers = layerManager.getLayers();
-        
-        for (const auto& pair : allLayers) {
-            const auto& layer = pair.second;
-            rapidjson::Value layerObj(rapidjson::kObjectType);
-            
-            // 添加图层ID
-            layerObj.AddMember("id", layer->getId(), allocator);
-            
-            // 添加图层名称
-            rapidjson::Value name(layer->getName().c_str(), allocator);
-            layerObj.AddMember("name", name, allocator);
-            
-            // 添加图层可见性
-            layerObj.AddMember("visible", layer->isVisible(), allocator);
-            
-            // 添加图形信息
-            rapidjson::Value shapes(rapidjson::kArrayType);
-            const auto& layerShapes = layer->getShapes();
+        writer.Key("layers");
+        writer.StartArray();
+        std::string shapesText;
+        for (const Layer* layer : layers) {
+            std::vector<JsonChunkCache::Chunk> chunks;
+            auto previous = previousChunks.find(layer->getId());
+            if (previous != previousChunks.end()) {
+                chunks.swap(previous->second);
+            }
             
-            for (const auto& shape : layerShapes) {
-                rapidjson::Value shapeObj(rapidjson::kObjectType);
-                
-                // 添加图形类型
-                std::string typeName;
-                switch (shape->getType()) {
-                case ShapeType::POINT:
-                    typeName = "POINT";
-                    break;
-                case ShapeType::LINE:
-                    typeName = "LINE";
-                    break;
-                case ShapeType::CIRCLE:
-                    typeName = "CIRCLE";
-                    break;
-                case ShapeType::RECTANGLE:
-                    typeName = "RECTANGLE";
-                    break;
-                default:
-                    typeName = "UNKNOWN";
-                    break;
+            // 逐块序列化图形，块哈希未变化时复用上次的文本
+            std::size_t chunkCount = layer->getChunkCount();
+            chunks.resize(chunkCount);
+            shapesText.assign(1, '[');
+            for (std::size_t i = 0; i < chunkCount; ++i) {
+                std::uint64_t chunkHash = layer->getChunkHash(i);
+                JsonChunkCache::Chunk& chunk = chunks[i];
+                if (chunk.text.empty() || chunk.hash != chunkHash) {
+                    chunk.text = serializeShapeChunk(*layer, i);
+                    chunk.hash = chunkHash;
+                    ++chunkCache.writtenChunks;
+                } else {
+                    ++chunkCache.reusedChunks;
                 }
-                rapidjson::Value typeVal(typeName.c_str(), allocator);
-                shapeObj.AddMember("type", typeVal, allocator);
-                
-                // 添加颜色信息
-                auto color = shape->getColor();
-                rapidjson::Value colorObj(rapidjson::kObjectType);
-                colorObj.AddMember("r", color.r, allocator);
-                colorObj.AddMember("g", color.g, allocator);
-                colorObj.AddMember("b", color.b, allocator);
-                shapeObj.AddMember("color", colorObj, allocator);
-                
-                // 添加特定图形的属性
-                if (auto point = std::dynamic_pointer_cast<Point>(shape)) {
-                    auto pos = point->getPosition();
-                    rapidjson::Value posObj(rapidjson::kObjectType);
-                    posObj.AddMember("x", pos.x, allocator);
-                    posObj.AddMember("y", pos.y, allocator);
-                    shapeObj.AddMember("position", posObj, allocator);
-                } else if (auto line = std::dynamic_pointer_cast<Line>(shape)) {
-                    auto start = line->getStart();
-                    auto end = line->getEnd();
-                    rapidjson::Value startObj(rapidjson::kObjectType);
-                    startObj.AddMember("x", start.x, allocator);
-                    startObj.AddMember("y", start.y, allocator);
-                    shapeObj.AddMember("start", startObj, allocator);
-                    
-                    rapidjson::Value endObj(rapidjson::kObjectType);
-                    endObj.AddMember("x", end.x, allocator);
-                    endObj.AddMember("y", end.y, allocator);
-                    shapeObj.AddMember("end", endObj, allocator);
-                } else if (auto circle = std::dynamic_pointer_cast<Circle>(shape)) {
-                    auto center = circle->getCenter();
-                    rapidjson::Value centerObj(rapidjson::kObjectType);
-                    centerObj.AddMember("x", center.x, allocator);
-                    centerObj.AddMember("y", center.y, allocator);
-                    shapeObj.AddMember("center", centerObj, allocator);
-                    shapeObj.AddMember("radius", circle->getRadius(), allocator);
-                } else if (auto rectangle = std::dynamic_pointer_cast<Rectangle>(shape)) {
-                    auto pos = rectangle->getPosition();
-                    rapidjson::Value posObj(rapidjson::kObjectType);
-                    posObj.AddMember("x", pos.x, allocator);
-                    posObj.AddMember("y", pos.y, allocator);
-                    shapeObj.AddMember("position", posObj, allocator);
-                    shapeObj.AddMember("width", rectangle->getWidth(), allocator);
-                    shapeObj.AddMember("height", rectangle->getHeight(), allocator);
+                if (i > 0) {
+                    shapesText.push_back(',');
                 }
-                
-                shapes.PushBack(shapeObj, allocator);
+                shapesText.append(chunk.text);
             }
+            shapesText.push_back(']');
+            
+            writer.StartObject();
+            writer.Key("id");
+            writer.Int(layer->getId());
+            writer.Key("name");
+            std::string name = layer->getName();
+            writer.String(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+            writer.Key("visible");
+            writer.Bool(layer->isVisible());
+            writer.Key("shapes");
+            writer.RawValue(shapesText.c_str(), shapesText.size(), rapidjson::kArrayType);
+            writer.EndObject();
             
-            layerObj.AddMember("shapes", shapes, allocator);
-            layers.PushBack(layerObj, allocator);
+            chunkCache.layers.emplace(layer->getId(), std::move(chunks));
         }
+        writer.EndArray();
+        writer.EndObject();
         
-        doc.AddMember("layers", layers, allocator);
-        
-        // 序列化到文件
-        rapidjson::StringBuffer buffer;
-        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-        doc.Accept(writer);
-        
-        std::ofstream file(filePath);
+        // 写入文件
+        std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
         if (!file.is_open()) {
             return false;
         }
         
-        file << buffer.GetString();
+        file.write(buffer.GetString(), static_cast<std::streamsize>(buffer.GetSize()));
         file.close();
         
-        return true;
+        return !file.fail();
     } catch (...) {
         return false;
     }
 }
 
 // 从文件加载图形
-bool SaveLoad::loadFromFile(const std::string& filePath) {
+bool SaveLoad::loadFromFile(LayerManager& layerManager, const std::string& filePath) {
+    std::vector<LoadedLayer> layers;
+    if (!parseFile(filePath, layers)) {
+        return false;
+    }
+    applyLayers(layerManager, std::move(layers));
+    return true;
+}
+
+// 从内存中的JSON文本加载图形
+bool SaveLoad::loadFromString(LayerManager& layerManager, std::string_view content) {
+    std::vector<LoadedLayer> layers;
+    if (!parseString(content, layers)) {
+        return false;
+    }
+    applyLayers(layerManager, std::move(layers));
+    return true;
+}
+
+// 解析文件
+bool SaveLoad::parseFile(const std::string& filePath, std::vector<LoadedLayer>& layers, ProgressMonitor* progress) {
     try {
         // 读取文件
         std::ifstream file(filePath);
@@ -151,93 +669,110 @@ bool SaveLoad::loadFromFile(const std::string& filePath) {
         std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
         file.close();
         
-        // 解析JSON
+        return parseString(content, layers, progress);
+    } catch (...) {
+        return false;
+    }
+}
+
+// 解析内存中的JSON文本
+bool SaveLoad::parseString(std::string_view content, std::vector<LoadedLayer>& layers, ProgressMonitor* progress) {
+    try {
+        // 解析JSON，内容不要求以\0结尾（可直接来自文件映射）
         rapidjson::Document doc;
-        doc.Parse(content.c_str());
+        doc.Parse(content.data(), content.size());
         
         if (doc.HasParseError()) {
             return false;
         }
         
-        // 清空现有图层
-        auto& layerManager = LayerManager::getInstance();
-        layerManager.clearAllLayers();
+        layers.clear();
+        if (!doc.HasMember("layers") || !doc["layers"].IsArray()) {
+            return true;
+        }
+        const auto& layerArray = doc["layers"];
+        
+        // 以图形总数作为进度的总工作量
+        if (progress) {
+            std::size_t total = 0;
+            for (size_t i = 0; i < layerArray.Size(); ++i) {
+                const auto& layerObj = layerArray[i];
+                if (layerObj.HasMember("shapes") && layerObj["shapes"].IsArray()) {
+                    total += layerObj["shapes"].Size();
+                }
+            }
+            progress->setTotal(total);
+        }
         
-        // 加载图层
-        if (doc.HasMember("layers") && doc["layers"].IsArray()) {
-            const auto& layers = doc["layers"];
+        std::size_t pending = 0;
+        layers.reserve(layerArray.Size());
+        for (size_t i = 0; i < layerArray.Size(); ++i) {
+            const auto& layerObj = layerArray[i];
             
-            for (size_t i = 0; i < layers.Size(); ++i) {
-                const auto& layerObj = layers[i];
-                
-                // 获取图层信息
-                int layerId = layerObj["id"].GetInt();
-                std::string layerName = layerObj["name"].GetString();
-                bool visible = layerObj["visible"].GetBool();
+            // 获取图层信息
+            LoadedLayer& layer = layers.emplace_back();
+            layer.name = layerObj["name"].GetString();
+            layer.visible = layerObj["visible"].GetBool();
+            
+            // 解析图形
+            if (layerObj.HasMember("shapes") && layerObj["shapes"].IsArray()) {
+                const auto& shapes = layerObj["shapes"];
+                layer.shapes.reserve(shapes.Size());
                 
-                // 创建图层
-                int newLayerId = layerManager.createLayer(layerName);
-                auto layer = layerManager.getLayer(newLayerId);
-                if (layer) {
-                    layer->setVisible(visible);
+                for (size_t j = 0; j < shapes.Size(); ++j) {
+                    const auto& shapeObj = shapes[j];
+                    
+                    // 获取图形类型
+                    std::string typeName = shapeObj["type"].GetString();
                     
-                    // 加载图形
-                    if (layerObj.HasMember("shapes") && layerObj["shapes"].IsArray()) {
-                        const auto& shapes = layerObj["shapes"];
-                        
-                        for (size_t j = 0; j < shapes.Size(); ++j) {
-                            const auto& shapeObj = shapes[j];
-                            
-                            // 获取图形类型
-                            std::string typeName = shapeObj["type"].GetString();
-                            
-                            // 获取颜色
-                            glm::vec3 color(1.0f, 1.0f, 1.0f);
-                            if (shapeObj.HasMember("color")) {
-                                const auto& colorObj = shapeObj["color"];
-                                color.r = colorObj["r"].GetFloat();
-                                color.g = colorObj["g"].GetFloat();
-                                color.b = colorObj["b"].GetFloat();
-                            }
-                            
-                            // 创建图形
-                            std::shared_ptr<Shape> shape;
-                            
-                            if (typeName == "POINT") {
-                                const auto& posObj = shapeObj["position"];
-                                float x = posObj["x"].GetFloat();
-                                float y = posObj["y"].GetFloat();
-                                shape = std::make_shared<Point>(glm::vec2(x, y));
-                            } else if (typeName == "LINE") {
-                                const auto& startObj = shapeObj["start"];
-                                const auto& endObj = shapeObj["end"];
-                                float startX = startObj["x"].GetFloat();
-                                float startY = startObj["y"].GetFloat();
-                                float endX = endObj["x"].GetFloat();
-                                float endY = endObj["y"].GetFloat();
-                                shape = std::make_shared<Line>(glm::vec2(startX, startY), glm::vec2(endX, endY));
-                            } else if (typeName == "CIRCLE") {
-                                const auto& centerObj = shapeObj["center"];
-                                float centerX = centerObj["x"].GetFloat();
-                                float centerY = centerObj["y"].GetFloat();
-                                float radius = shapeObj["radius"].GetFloat();
-                                shape = std::make_shared<Circle>(glm::vec2(centerX, centerY), radius);
-                            } else if (typeName == "RECTANGLE") {
-                                const auto& posObj = shapeObj["position"];
-                                float x = posObj["x"].GetFloat();
-                                float y = posObj["y"].GetFloat();
-                                float width = shapeObj["width"].GetFloat();
-                                float height = shapeObj["height"].GetFloat();
-                                shape = std::make_shared<Rectangle>(glm::vec2(x, y), width, height);
-                            }
-                            
-                            // 设置颜色和图层
-                            if (shape) {
-                                shape->setColor(color);
-                                shape->setLayer(newLayerId);
-                                layer->addShape(shape);
-                            }
-                        }
+                    // 获取颜色
+                    glm::vec3 color(1.0f, 1.0f, 1.0f);
+                    if (shapeObj.HasMember("color")) {
+                        const auto& colorObj = shapeObj["color"];
+                        color.r = colorObj["r"].GetFloat();
+                        color.g = colorObj["g"].GetFloat();
+                        color.b = colorObj["b"].GetFloat();
+                    }
+                    
+                    // 创建图形
+                    std::shared_ptr<Shape> shape;
+                    
+                    if (typeName == "POINT") {
+                        const auto& posObj = shapeObj["position"];
+                        float x = posObj["x"].GetFloat();
+                        float y = posObj["y"].GetFloat();
+                        shape = std::make_shared<Point>(glm::vec2(x, y));
+                    } else if (typeName == "LINE") {
+                        const auto& startObj = shapeObj["start"];
+                        const auto& endObj = shapeObj["end"];
+                        float startX = startObj["x"].GetFloat();
+                        float startY = startObj["y"].GetFloat();
+                        float endX = endObj["x"].GetFloat();
+                        float endY = endObj["y"].GetFloat();
+                        shape = std::make_shared<Line>(glm::vec2(startX, startY), glm::vec2(endX, endY));
+                    } else if (typeName == "CIRCLE") {
+                        const auto& centerObj = shapeObj["center"];
+                        float centerX = centerObj["x"].GetFloat();
+                        float centerY = centerObj["y"].GetFloat();
+                        float radius = shapeObj["radius"].GetFloat();
+                        shape = std::make_shared<Circle>(glm::vec2(centerX, centerY), radius);
+                    } else if (typeName == "RECTANGLE") {
+                        const auto& posObj = shapeObj["position"];
+                        float x = posObj["x"].GetFloat();
+                        float y = posObj["y"].GetFloat();
+                        float width = shapeObj["width"].GetFloat();
+                        float height = shapeObj["height"].GetFloat();
+                        shape = std::make_shared<Rectangle>(glm::vec2(x, y), width, height);
+                    }
+                    
+                    // 设置颜色，所属图层在加入图层管理器时设置
+                    if (shape) {
+                        shape->setColor(color);
+                        layer.shapes.push_back(std::move(shape));
+                    }
+                    
+                    if (!ProgressMonitor::step(progress, pending)) {
+                        return false;
                     }
                 }
             }
@@ -249,8 +784,27 @@ bool SaveLoad::loadFromFile(const std::string& filePath) {
     }
 }
 
+// 用解析结果替换图层管理器中的全部图层
+void SaveLoad::applyLayers(LayerManager& layerManager, std::vector<LoadedLayer> layers) {
+    // 清空现有图层
+    layerManager.clearAllLayers();
+    
+    for (auto& loaded : layers) {
+        // 创建图层
+        int layerId = layerManager.createLayer(loaded.name);
+        auto layer = layerManager.getLayer(layerId);
+        if (!layer) {
+            continue;
+        }
+        layer->setVisible(loaded.visible);
+        
+        // 整批加入图层，所属图层由addShapes设置
+        layer->addShapes(loaded.shapes);
+    }
+}
+
 // 导出为SVG格式
-bool SaveLoad::exportToSVG(const std::string& filePath) {
+bool SaveLoad::exportToSVG(const LayerManager& layerManager, const std::string& filePath, ProgressMonitor* progress) {
     try {
         std::ofstream file(filePath);
         if (!file.is_open()) {
@@ -262,9 +816,16 @@ bool SaveLoad::exportToSVG(const std::string& filePath) {
         file << "<svg width=\"800\" height=\"600\" xmlns=\"http://www.w3.org/2000/svg\">";
         
         // 写入图形
-        auto& layerManager = LayerManager::getInstance();
         auto& allLayers = layerManager.getLayers();
+        if (progress) {
+            std::size_t total = 0;
+            for (const auto& pair : allLayers) {
+                total += pair.second->isVisible() ? pair.second->getShapes().size() : 0;
+            }
+            progress->setTotal(total);
+        }
         
+        std::size_t pending = 0;
         for (const auto& pair : allLayers) {
             const auto& layer = pair.second;
             if (!layer->isVisible()) {
@@ -295,6 +856,13 @@ bool SaveLoad::exportToSVG(const std::string& filePath) {
                     float height = rectangle->getHeight();
                     file << "  <rect x=\"" << pos.x << "\" y=\"" << pos.y << "\" width=\"" << width << "\" height=\"" << height << "\" fill=\"none\" stroke=\"" << colorStr << "\" stroke-width=\"2\" />";
                 }
+                
+                // 取消时不保留写了一半的文件
+                if (!ProgressMonitor::step(progress, pending)) {
+                    file.close();
+                    std::remove(filePath.c_str());
+                    return false;
+                }
             }
         }
         
@@ -308,8 +876,101 @@ bool SaveLoad::exportToSVG(const std::string& filePath) {
     }
 }
 
+// 导出为DXF格式
+bool SaveLoad::exportToDXF(const LayerManager& layerManager, const std::string& filePath, DxfVersion version, ProgressMonitor* progress) {
+    try {
+        // 按图层ID排序，保证输出稳定
+        auto& allLayers = layerManager.getLayers();
+        std::vector<const Layer*> layers;
+        layers.reserve(allLayers.size());
+        bool needLayerZero = true;
+        for (const auto& pair : allLayers) {
+            layers.push_back(pair.second.get());
+            if (pair.second->getName() == "0") {
+                needLayerZero = false;
+            }
+        }
+        std::sort(layers.begin(), layers.end(), [](const Layer* a, const Layer* b) {
+            return a->getId() < b->getId();
+        });
+        
+        // 预先计算各图层实体的起始句柄，使各图层可以独立并行生成
+        std::vector<std::uint64_t> firstHandles(layers.size());
+        std::uint64_t nextHandle = kDxfFirstLayerHandle + layers.size() + 1;
+        std::size_t totalShapes = 0;
+        for (std::size_t i = 0; i < layers.size(); ++i) {
+            firstHandles[i] = nextHandle;
+            nextHandle += layers[i]->getShapes().size();
+            totalShapes += layers[i]->getShapes().size();
+        }
+        if (progress) {
+            progress->setTotal(totalShapes);
+        }
+        
+        // 生成各图层实体段
+        std::vector<DxfBuffer> layerBuffers;
+        layerBuffers.reserve(layers.size());
+        for (const Layer* layer : layers) {
+            // 经验值：每个实体约150字节
+            layerBuffers.emplace_back(layer->getShapes().size() * 150 + 64);
+        }
+        
+        unsigned workerCount = std::min<unsigned>(std::max(1u, std::thread::hardware_concurrency()), static_cast<unsigned>(layers.size()));
+        if (workerCount > 1 && totalShapes >= kDxfParallelShapeThreshold) {
+            std::atomic<std::size_t> nextLayer{0};
+            auto worker = [&]() {
+                for (std::size_t i = nextLayer++; i < layers.size(); i = nextLayer++) {
+                    writeLayerEntities(layerBuffers[i], *layers[i], version, firstHandles[i], progress);
+                }
+            };
+            std::vector<std::thread> workers;
+            workers.reserve(workerCount - 1);
+            for (unsigned i = 1; i < workerCount; ++i) {
+                workers.emplace_back(worker);
+            }
+            worker();
+            for (auto& thread : workers) {
+                thread.join();
+            }
+        } else {
+            for (std::size_t i = 0; i < layers.size(); ++i) {
+                writeLayerEntities(layerBuffers[i], *layers[i], version, firstHandles[i], progress);
+            }
+        }
+        
+        // 取消时各图层已提前结束，内容不完整，不写文件
+        if (progress && progress->isCancelled()) {
+            return false;
+        }
+        
+        DxfBuffer prologue(64 * 1024);
+        writeDxfPrologue(prologue, layers, needLayerZero, version, nextHandle);
+        DxfBuffer epilogue(4 * 1024);
+        writeDxfEpilogue(epilogue, version);
+        
+        // 按顺序整块写入，避免再拼接一次
+        std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        auto writeBuffer = [&file](const DxfBuffer& buffer) {
+            file.write(buffer.data().data(), static_cast<std::streamsize>(buffer.data().size()));
+        };
+        writeBuffer(prologue);
+        for (const auto& buffer : layerBuffers) {
+            writeBuffer(buffer);
+        }
+        writeBuffer(epilogue);
+        file.close();
+        
+        return !file.fail();
+    } catch (...) {
+        return false;
+    }
+}
+
 // 导出为PNG格式
-bool SaveLoad::exportToPNG(const std::string& filePath) {
+bool SaveLoad::exportToPNG(const LayerManager& layerManager, const std::string& filePath) {
     // 这里简化处理，实际应该使用OpenGL截图或其他库来实现
     // 暂时返回false
     return false;
@@ -0,0 +1,278 @@
+#include "Selection.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace tch {
+
+namespace {
+
+// 矩形的四个顶点，按边的顺序排列
+std::array<glm::vec2, 4> rectangleCorners(const Rectangle& rectangle) {
+    glm::vec2 position = rectangle.getPosition();
+    return {position,
+            position + glm::vec2(rectangle.getWidth(), 0.0f),
+            position + glm::vec2(rectangle.getWidth(), rectangle.getHeight()),
+            position + glm::vec2(0.0f, rectangle.getHeight())};
+}
+
+// 点到图形轮廓的距离是否不超过tolerance：圆与矩形只有轮廓可选，内部的点不算命中
+bool isNearOutline(const Shape& shape, const glm::vec2& point, float tolerance) {
+    switch (shape.getType()) {
+        case ShapeType::POINT:
+            return glm::distance(point, static_cast<const Point&>(shape).getPosition()) <= tolerance;
+        case ShapeType::LINE: {
+            const auto& line = static_cast<const Line&>(shape);
+            return GeometryUtils::distanceToSegment(point, line.getStart(), line.getEnd()) <= tolerance;
+        }
+        case ShapeType::CIRCLE: {
+            const auto& circle = static_cast<const Circle&>(shape);
+            return std::abs(glm::distance(point, circle.getCenter()) - circle.getRadius()) <= tolerance;
+        }
+        case ShapeType::RECTANGLE: {
+            auto corners = rectangleCorners(static_cast<const Rectangle&>(shape));
+            for (std::size_t i = 0; i < corners.size(); ++i) {
+                if (GeometryUtils::distanceToSegment(point, corners[i], corners[(i + 1) % corners.size()]) <= tolerance) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+// 图形轮廓是否与矩形相交（含轮廓完全位于矩形内）
+bool crossesBox(const Shape& shape, const glm::vec2& minPoint, const glm::vec2& maxPoint) {
+    switch (shape.getType()) {
+        case ShapeType::POINT: {
+            glm::vec2 position = static_cast<const Point&>(shape).getPosition();
+            return position.x >= minPoint.x && position.x <= maxPoint.x && position.y >= minPoint.y && position.y <= maxPoint.y;
+        }
+        case ShapeType::LINE: {
+            const auto& line = static_cast<const Line&>(shape);
+            return GeometryUtils::segmentIntersectsBox(line.getStart(), line.getEnd(), minPoint, maxPoint);
+        }
+        case ShapeType::CIRCLE: {
+            // 圆周与矩形相交：矩形上离圆心最近的点在圆内（或圆上），且最远的顶点不在圆内
+            const auto& circle = static_cast<const Circle&>(shape);
+            glm::vec2 center = circle.getCenter();
+            glm::vec2 nearest = glm::max(minPoint, glm::min(center, maxPoint));
+            glm::vec2 farthest(std::abs(minPoint.x - center.x) > std::abs(maxPoint.x - center.x) ? minPoint.x : maxPoint.x,
+                               std::abs(minPoint.y - center.y) > std::abs(maxPoint.y - center.y) ? minPoint.y : maxPoint.y);
+            float radius = circle.getRadius();
+            return glm::distance(nearest, center) <= radius && glm::distance(farthest, center) >= radius;
+        }
+        case ShapeType::RECTANGLE: {
+            auto corners = rectangleCorners(static_cast<const Rectangle&>(shape));
+            for (std::size_t i = 0; i < corners.size(); ++i) {
+                if (GeometryUtils::segmentIntersectsBox(corners[i], corners[(i + 1) % corners.size()], minPoint, maxPoint)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// 窗口选择
+std::size_t SelectionSet::selectWindow(const SpatialIndex& index, const glm::vec2& corner1, const glm::vec2& corner2, SelectMode mode) {
+    glm::vec2 minPoint = glm::min(corner1, corner2);
+    glm::vec2 maxPoint = glm::max(corner1, corner2);
+    
+    std::vector<std::shared_ptr<Shape>> candidates;
+    index.query(minPoint, maxPoint, candidates);
+    
+    // 候选图形只保证相交，窗口选择要求完全包含
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const std::shared_ptr<Shape>& shape) {
+        glm::vec2 shapeMin, shapeMax;
+        shape->getBounds(shapeMin, shapeMax);
+        return shapeMin.x < minPoint.x || shapeMin.y < minPoint.y || shapeMax.x > maxPoint.x || shapeMax.y > maxPoint.y;
+    }), candidates.end());
+    
+    apply(candidates, mode);
+    return m_count;
+}
+
+// 交叉选择
+std::size_t SelectionSet::selectCrossing(const SpatialIndex& index, const glm::vec2& corner1, const glm::vec2& corner2, SelectMode mode) {
+    glm::vec2 minPoint = glm::min(corner1, corner2);
+    glm::vec2 maxPoint = glm::max(corner1, corner2);
+    
+    std::vector<std::shared_ptr<Shape>> candidates;
+    index.query(minPoint, maxPoint, candidates);
+    
+    // 候选图形只保证包围盒相交，再按轮廓精确判断（如斜线只有包围盒的空角落在矩形内时不选）
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](const std::shared_ptr<Shape>& shape) {
+        return !crossesBox(*shape, minPoint, maxPoint);
+    }), candidates.end());
+    
+    apply(candidates, mode);
+    return m_count;
+}
+
+// 点选
+std::size_t SelectionSet::selectAtPoint(const SpatialIndex& index, const glm::vec2& point, float tolerance, SelectMode mode) {
+    std::vector<std::shared_ptr<Shape>> candidates;
+    index.query(point - glm::vec2(tolerance), point + glm::vec2(tolerance), candidates);
+    
+    // 句柄按创建顺序递增，取轮廓在容差内的图形中最后绘制的一个；点击大图形的内部不会选中它
+    std::shared_ptr<Shape> picked;
+    for (const auto& shape : candidates) {
+        if ((!picked || shape->getHandle() > picked->getHandle()) && isNearOutline(*shape, point, tolerance)) {
+            picked = shape;
+        }
+    }
+    
+    std::vector<std::shared_ptr<Shape>> shapes;
+    if (picked) {
+        shapes.push_back(picked);
+    }
+    apply(shapes, mode);
+    return m_count;
+}
+
+// 全选
+std::size_t SelectionSet::selectAll(const LayerManager& layerManager, SelectMode mode) {
+    if (mode == SelectMode::Remove) {
+        clear();
+        return m_count;
+    }
+    
+    // 按句柄表逐字填充，只需一次顺序遍历
+    std::uint32_t limit = layerManager.getHandleLimit();
+    m_words.assign((limit + 63) / 64, 0);
+    m_count = 0;
+    for (std::uint32_t handle = 1; handle < limit; ++handle) {
+        if (layerManager.getShape(handle)) {
+            m_words[handle / 64] |= std::uint64_t(1) << (handle % 64);
+            ++m_count;
+        }
+    }
+    return m_count;
+}
+
+// 按属性选择
+std::size_t SelectionSet::selectByAttributes(const LayerManager& layerManager, const AttributeQuery& query, SelectMode mode) {
+    std::vector<std::uint32_t> handles;
+    layerManager.getAttributeIndex().query(query, handles);
+    apply(handles, mode);
+    return m_count;
+}
+
+// 过滤
+std::size_t SelectionSet::filter(const LayerManager& layerManager, const std::function<bool(const Shape&)>& predicate) {
+    std::vector<std::uint32_t> rejected;
+    forEach([&](std::uint32_t handle) {
+        auto shape = layerManager.getShape(handle);
+        if (!shape || !predicate(*shape)) {
+            rejected.push_back(handle);
+        }
+    });
+    for (std::uint32_t handle : rejected) {
+        reset(handle);
+    }
+    return m_count;
+}
+
+// 清空选择
+void SelectionSet::clear() {
+    m_words.clear();
+    m_count = 0;
+}
+
+// 句柄是否被选中
+bool SelectionSet::contains(std::uint32_t handle) const {
+    std::size_t word = handle / 64;
+    return word < m_words.size() && (m_words[word] >> (handle % 64)) & 1;
+}
+
+// 获取选中的图形
+std::vector<std::shared_ptr<Shape>> SelectionSet::resolve(const LayerManager& layerManager) {
+    std::vector<std::shared_ptr<Shape>> shapes;
+    shapes.reserve(m_count);
+    std::vector<std::uint32_t> stale;
+    forEach([&](std::uint32_t handle) {
+        if (auto shape = layerManager.getShape(handle)) {
+            shapes.push_back(std::move(shape));
+        } else {
+            stale.push_back(handle);
+        }
+    });
+    for (std::uint32_t handle : stale) {
+        reset(handle);
+    }
+    return shapes;
+}
+
+// 按选择方式合并一组图形
+void SelectionSet::apply(const std::vector<std::shared_ptr<Shape>>& shapes, SelectMode mode) {
+    if (mode == SelectMode::Replace) {
+        clear();
+    }
+    for (const auto& shape : shapes) {
+        if (mode == SelectMode::Remove) {
+            reset(shape->getHandle());
+        } else {
+            set(shape->getHandle());
+        }
+    }
+}
+
+// 按选择方式合并一组句柄
+void SelectionSet::apply(const std::vector<std::uint32_t>& handles, SelectMode mode) {
+    if (mode == SelectMode::Replace) {
+        clear();
+    }
+    
+    // 句柄有序，末尾句柄决定位集大小，只需扩容一次
+    if (mode != SelectMode::Remove && !handles.empty()) {
+        std::size_t words = handles.back() / 64 + 1;
+        if (words > m_words.size()) {
+            m_words.resize(words, 0);
+        }
+    }
+    for (std::uint32_t handle : handles) {
+        if (mode == SelectMode::Remove) {
+            reset(handle);
+        } else {
+            set(handle);
+        }
+    }
+}
+
+// 设置单个句柄
+void SelectionSet::set(std::uint32_t handle) {
+    // 句柄0表示未加入图层的图形，不参与选择
+    if (handle == 0) {
+        return;
+    }
+    
+    std::size_t word = handle / 64;
+    if (word >= m_words.size()) {
+        m_words.resize(word + 1, 0);
+    }
+    std::uint64_t mask = std::uint64_t(1) << (handle % 64);
+    if (!(m_words[word] & mask)) {
+        m_words[word] |= mask;
+        ++m_count;
+    }
+}
+
+// 清除单个句柄
+void SelectionSet::reset(std::uint32_t handle) {
+    std::size_t word = handle / 64;
+    if (word >= m_words.size()) {
+        return;
+    }
+    std::uint64_t mask = std::uint64_t(1) << (handle % 64);
+    if (m_words[word] & mask) {
+        m_words[word] &= ~mask;
+        --m_count;
+    }
+}
+
+} // namespace tch
@@ -0,0 +1,245 @@
+#include "SpatialIndex.h"
+#include "Layer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tch {
+
+namespace {
+
+// 每个图形平均占用的网格数，用于估算网格边长
+constexpr float kShapesPerCell = 4.0f;
+
+// 单个图形最多登记的网格数，超过则作为大图形单独存放
+constexpr long long kMaxCellsPerShape = 256;
+
+// 网格坐标的范围，远离网格原点的坐标收拢到边界网格，避免换算时溢出
+constexpr float kMaxCellCoord = 16777216.0f;
+
+// 图形数量增长到建立网格时的这么多倍后重新划分网格
+constexpr std::size_t kRebuildGrowth = 2;
+
+// 图形较少时不因数量增长而重建
+constexpr std::size_t kRebuildMinShapes = 64;
+
+} // namespace
+
+// 根据图层管理器中的所有图形重建索引
+void SpatialIndex::build(const LayerManager& layerManager) {
+    clear();
+    
+    // 收集所有图形及其包围盒
+    m_entries.resize(layerManager.getHandleLimit());
+    glm::vec2 sceneMin(std::numeric_limits<float>::max());
+    glm::vec2 sceneMax(std::numeric_limits<float>::lowest());
+    for (const auto& pair : layerManager.getLayers()) {
+        for (const auto& shape : pair.second->getShapes()) {
+            std::uint32_t handle = shape->getHandle();
+            if (handle == 0 || handle >= m_entries.size()) {
+                continue;
+            }
+            Entry& entry = m_entries[handle];
+            entry.shape = shape;
+            shape->getBounds(entry.minPoint, entry.maxPoint);
+            sceneMin = glm::min(sceneMin, entry.minPoint);
+            sceneMax = glm::max(sceneMax, entry.maxPoint);
+            ++m_size;
+        }
+    }
+    m_builtSize = m_size;
+    if (m_size == 0) {
+        return;
+    }
+    
+    // 网格边长按场景面积与图形数量估算，使每个网格平均容纳少量图形
+    glm::vec2 extent = glm::max(sceneMax - sceneMin, glm::vec2(1e-3f));
+    float area = extent.x * extent.y;
+    m_cellSize = std::max(std::sqrt(area * kShapesPerCell / static_cast<float>(m_size)), 1e-3f);
+    m_origin = sceneMin;
+    m_sceneMin = sceneMin;
+    m_sceneMax = sceneMax;
+    
+    m_cells.reserve(m_size);
+    for (std::uint32_t handle = 0; handle < m_entries.size(); ++handle) {
+        if (m_entries[handle].shape) {
+            link(handle);
+        }
+    }
+}
+
+// 清空索引
+void SpatialIndex::clear() {
+    m_entries.clear();
+    m_cells.clear();
+    m_oversized.clear();
+    m_size = 0;
+    m_builtSize = 0;
+    m_origin = glm::vec2(0.0f);
+    m_sceneMin = glm::vec2(0.0f);
+    m_sceneMax = glm::vec2(0.0f);
+    m_cellSize = 1.0f;
+}
+
+// 登记图形
+void SpatialIndex::insert(const std::shared_ptr<Shape>& shape) {
+    std::uint32_t handle = shape->getHandle();
+    if (handle == 0) {
+        return;
+    }
+    if (handle >= m_entries.size()) {
+        m_entries.resize(handle + 1);
+    }
+    
+    Entry& entry = m_entries[handle];
+    if (entry.shape) {
+        unlink(handle);
+    } else {
+        ++m_size;
+    }
+    entry.shape = shape;
+    shape->getBounds(entry.minPoint, entry.maxPoint);
+    
+    // 场景范围只扩大不缩小，查询裁剪时保守即可
+    if (m_size == 1) {
+        m_sceneMin = entry.minPoint;
+        m_sceneMax = entry.maxPoint;
+    } else {
+        m_sceneMin = glm::min(m_sceneMin, entry.minPoint);
+        m_sceneMax = glm::max(m_sceneMax, entry.maxPoint);
+    }
+    link(handle);
+}
+
+// 移除指定句柄的图形
+void SpatialIndex::erase(std::uint32_t handle) {
+    if (handle >= m_entries.size() || !m_entries[handle].shape) {
+        return;
+    }
+    unlink(handle);
+    m_entries[handle].shape.reset();
+    --m_size;
+}
+
+// 增量修改后网格是否需要重新划分
+bool SpatialIndex::needsRebuild() const {
+    return m_size > std::max(m_builtSize, kRebuildMinShapes) * kRebuildGrowth;
+}
+
+// 查询包围盒与指定矩形相交的图形
+void SpatialIndex::query(const glm::vec2& minPoint, const glm::vec2& maxPoint, std::vector<std::shared_ptr<Shape>>& result) const {
+    if (m_size == 0) {
+        return;
+    }
+    if (minPoint.x > m_sceneMax.x || minPoint.y > m_sceneMax.y || maxPoint.x < m_sceneMin.x || maxPoint.y < m_sceneMin.y) {
+        return;
+    }
+    
+    auto intersects = [&](const Entry& entry) {
+        return entry.shape
+            && entry.minPoint.x <= maxPoint.x && entry.maxPoint.x >= minPoint.x
+            && entry.minPoint.y <= maxPoint.y && entry.maxPoint.y >= minPoint.y;
+    };
+    
+    // 查询范围覆盖的网格过多时直接遍历全部条目
+    std::vector<std::uint32_t> candidates;
+    glm::ivec2 first = cellOf(glm::max(minPoint, m_sceneMin));
+    glm::ivec2 last = cellOf(glm::min(maxPoint, m_sceneMax));
+    long long cellCount = static_cast<long long>(last.x - first.x + 1) * (last.y - first.y + 1);
+    if (cellCount > static_cast<long long>(m_cells.size())) {
+        for (const Entry& entry : m_entries) {
+            if (intersects(entry)) {
+                result.push_back(entry.shape);
+            }
+        }
+        return;
+    }
+    
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            auto it = m_cells.find(cellKey(x, y));
+            if (it != m_cells.end()) {
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+    candidates.insert(candidates.end(), m_oversized.begin(), m_oversized.end());
+    
+    // 同一图形可能登记在多个网格中，去重后按句柄顺序输出
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (std::uint32_t handle : candidates) {
+        if (intersects(m_entries[handle])) {
+            result.push_back(m_entries[handle].shape);
+        }
+    }
+}
+
+// 获取索引中的图形数量
+std::size_t SpatialIndex::size() const {
+    return m_size;
+}
+
+// 把条目登记到其包围盒覆盖的网格
+void SpatialIndex::link(std::uint32_t handle) {
+    Entry& entry = m_entries[handle];
+    glm::ivec2 first = cellOf(entry.minPoint);
+    glm::ivec2 last = cellOf(entry.maxPoint);
+    long long cellCount = static_cast<long long>(last.x - first.x + 1) * (last.y - first.y + 1);
+    entry.oversized = cellCount > kMaxCellsPerShape;
+    if (entry.oversized) {
+        m_oversized.push_back(handle);
+        return;
+    }
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            m_cells[cellKey(x, y)].push_back(handle);
+        }
+    }
+}
+
+// 把条目从网格中移除，网格划分未变，按登记时的包围盒即可找回所在网格
+void SpatialIndex::unlink(std::uint32_t handle) {
+    const Entry& entry = m_entries[handle];
+    auto removeFrom = [handle](std::vector<std::uint32_t>& handles) {
+        auto it = std::find(handles.begin(), handles.end(), handle);
+        if (it != handles.end()) {
+            *it = handles.back();
+            handles.pop_back();
+        }
+    };
+    if (entry.oversized) {
+        removeFrom(m_oversized);
+        return;
+    }
+    
+    glm::ivec2 first = cellOf(entry.minPoint);
+    glm::ivec2 last = cellOf(entry.maxPoint);
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            auto it = m_cells.find(cellKey(x, y));
+            if (it == m_cells.end()) {
+                continue;
+            }
+            removeFrom(it->second);
+            if (it->second.empty()) {
+                m_cells.erase(it);
+            }
+        }
+    }
+}
+
+// 计算坐标所在的网格
+glm::ivec2 SpatialIndex::cellOf(const glm::vec2& point) const {
+    glm::vec2 cell = (point - m_origin) / m_cellSize;
+    float x = std::clamp(std::floor(cell.x), -kMaxCellCoord, kMaxCellCoord);
+    float y = std::clamp(std::floor(cell.y), -kMaxCellCoord, kMaxCellCoord);
+    return glm::ivec2(static_cast<int>(x), static_cast<int>(y));
+}
+
+// 网格坐标编码为哈希键
+std::uint64_t SpatialIndex::cellKey(int x, int y) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+}
+
+} // namespace tch
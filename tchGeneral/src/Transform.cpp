@@ -1,8 +1,66 @@
 #include "Transform.h"
+#include "Progress.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <thread>
 
 namespace tch {
 
+namespace {
+
+// 副本数达到该值时多线程生成
+constexpr std::size_t kParallelArrayThreshold = 4096;
+
+// 生成阵列副本：第item项（从1开始）的每个源图形复制后由place放到位，结果按项依次排列。
+// 各线程负责连续的一段项，直接写入预先分配好的结果数组，无需加锁；取消后各线程提前结束，返回空结果
+template <typename Place>
+std::vector<std::shared_ptr<Shape>> generateCopies(const std::vector<std::shared_ptr<Shape>>& sources, std::size_t itemCount, Place place,
+                                                   ProgressMonitor* progress) {
+    std::vector<std::shared_ptr<Shape>> copies(itemCount * sources.size());
+    if (progress) {
+        progress->setTotal(copies.size());
+    }
+    auto generate = [&](std::size_t beginItem, std::size_t endItem) {
+        std::size_t pending = 0;
+        for (std::size_t item = beginItem; item < endItem; ++item) {
+            for (std::size_t i = 0; i < sources.size(); ++i) {
+                auto copy = sources[i]->clone();
+                place(*copy, item + 1);
+                copies[item * sources.size() + i] = std::move(copy);
+                if (!ProgressMonitor::step(progress, pending)) {
+                    return;
+                }
+            }
+        }
+    };
+    
+    unsigned workerCount = std::max(1u, std::thread::hardware_concurrency());
+    if (workerCount > 1 && copies.size() >= kParallelArrayThreshold) {
+        workerCount = static_cast<unsigned>(std::min<std::size_t>(workerCount, itemCount));
+        std::size_t itemsPerWorker = (itemCount + workerCount - 1) / workerCount;
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount - 1);
+        for (unsigned w = 1; w < workerCount; ++w) {
+            std::size_t beginItem = std::min(itemCount, w * itemsPerWorker);
+            std::size_t endItem = std::min(itemCount, beginItem + itemsPerWorker);
+            workers.emplace_back(generate, beginItem, endItem);
+        }
+        generate(0, std::min(itemCount, itemsPerWorker));
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    } else {
+        generate(0, itemCount);
+    }
+    
+    if (progress && progress->isCancelled()) {
+        return {};
+    }
+    return copies;
+}
+
+} // namespace
+
 // 平移单个图形
 void Transform::translate(Shape& shape, const glm::vec2& delta) {
     shape.translate(delta);
@@ -39,6 +97,39 @@ void Transform::scale(const std::vector<std::shared_ptr<Shape>>& shapes, float f
     }
 }
 
+// 矩形阵列
+std::vector<std::shared_ptr<Shape>> Transform::rectangularArray(const std::vector<std::shared_ptr<Shape>>& sources,
+                                                                int rows, int cols, float rowSpacing, float colSpacing,
+                                                                ProgressMonitor* progress) {
+    if (sources.empty() || rows < 1 || cols < 1) {
+        return {};
+    }
+    
+    std::size_t columnCount = static_cast<std::size_t>(cols);
+    std::size_t itemCount = static_cast<std::size_t>(rows) * columnCount - 1;
+    return generateCopies(sources, itemCount, [=](Shape& shape, std::size_t item) {
+        float row = static_cast<float>(item / columnCount);
+        float col = static_cast<float>(item % columnCount);
+        shape.translate(glm::vec2(col * colSpacing, row * rowSpacing));
+    }, progress);
+}
+
+// 环形阵列
+std::vector<std::shared_ptr<Shape>> Transform::polarArray(const std::vector<std::shared_ptr<Shape>>& sources,
+                                                          int count, float fillAngle, const glm::vec2& center,
+                                                          ProgressMonitor* progress) {
+    if (sources.empty() || count < 2) {
+        return {};
+    }
+    
+    // 整圆时count项均分360度，否则首尾两项分别位于起止角度
+    bool fullCircle = std::abs(std::abs(fillAngle) - 2.0f * static_cast<float>(M_PI)) < 1e-4f;
+    float step = fillAngle / static_cast<float>(fullCircle ? count : count - 1);
+    return generateCopies(sources, static_cast<std::size_t>(count - 1), [=](Shape& shape, std::size_t item) {
+        shape.rotate(step * static_cast<float>(item), center);
+    }, progress);
+}
+
 // 计算变换矩阵
 glm::mat3 Transform::calculateTransformMatrix(const glm::vec2& translation, float rotation, float scale) {
     // 先缩放，再旋转，最后平移
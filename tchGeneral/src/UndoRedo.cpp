@@ -5,17 +5,18 @@ namespace tch {
 
 // 撤销/重做管理器实现
 
-// 获取单例实例
-UndoRedoManager& UndoRedoManager::getInstance() {
-    static UndoRedoManager instance;
-    return instance;
-}
-
 // 添加操作
 void UndoRedoManager::addOperation(const std::shared_ptr<Operation>& operation) {
     // 执行操作
     operation->execute();
     
+    // 事务进行中，归入事务，提交时整体入栈
+    if (m_transaction) {
+        m_transaction->add(operation);
+        m_redoStack.clear();
+        return;
+    }
+    
     // 添加到撤销栈
     m_undoStack.push_back(operation);
     
@@ -28,9 +29,54 @@ void UndoRedoManager::addOperation(const std::shared_ptr<Operation>& operation)
     m_redoStack.clear();
 }
 
+// 开始事务
+void UndoRedoManager::beginTransaction(const std::string& name) {
+    if (m_transactionDepth++ == 0) {
+        m_transaction = std::make_shared<CompoundOperation>(name);
+    }
+}
+
+// 提交事务
+bool UndoRedoManager::commitTransaction() {
+    if (m_transactionDepth == 0) {
+        return false;
+    }
+    if (--m_transactionDepth > 0) {
+        return false;
+    }
+    
+    // 空事务不入栈
+    auto transaction = std::move(m_transaction);
+    if (transaction->size() > 0) {
+        transaction->mergeDrawOperations();
+        m_undoStack.push_back(transaction);
+        
+        // 限制栈大小
+        if (m_undoStack.size() > m_maxStackSize) {
+            m_undoStack.erase(m_undoStack.begin());
+        }
+    }
+    return true;
+}
+
+// 是否有进行中的事务
+bool UndoRedoManager::isInTransaction() const {
+    return m_transactionDepth > 0;
+}
+
+// 当前事务中的操作个数
+size_t UndoRedoManager::getTransactionSize() const {
+    return m_transaction ? m_transaction->size() : 0;
+}
+
+// 事务嵌套层数
+size_t UndoRedoManager::getTransactionDepth() const {
+    return m_transactionDepth;
+}
+
 // 撤销
 bool UndoRedoManager::undo() {
-    if (m_undoStack.empty()) {
+    if (m_undoStack.empty() || m_transaction) {
         return false;
     }
     
@@ -54,7 +100,7 @@ bool UndoRedoManager::undo() {
 
 // 重做
 bool UndoRedoManager::redo() {
-    if (m_redoStack.empty()) {
+    if (m_redoStack.empty() || m_transaction) {
         return false;
     }
     
@@ -80,6 +126,9 @@ bool UndoRedoManager::redo() {
 void UndoRedoManager::clear() {
     m_undoStack.clear();
     m_redoStack.clear();
+    if (m_transaction) {
+        m_transaction = std::make_shared<CompoundOperation>(m_transaction->getName());
+    }
 }
 
 // 检查是否可以撤销
@@ -0,0 +1,174 @@
+#include "BinaryLog.h"
+#include "LogLine.h"
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using namespace tch;
+
+// 解码选项
+struct DecodeOptions {
+    std::string inputPath;                                          // 二进制日志文件
+    std::string outputPath;                                         // --output：写入该文件，默认写到标准输出
+    int lowestLevel = 0;                                            // --level：只输出不低于该级别的日志
+    std::int64_t fromMicros = std::numeric_limits<std::int64_t>::min(); // --from：只输出不早于该时间的日志
+    std::int64_t toMicros = std::numeric_limits<std::int64_t>::max();   // --to：只输出不晚于该时间的日志
+    std::string file;                                               // --file：只输出该源文件的日志
+};
+
+constexpr std::size_t kDecodeFlushSize = 256 * 1024; // 输出缓冲区超过该大小时写出
+
+// 解析"YYYY-MM-DD HH:MM:SS[.mmm]"格式的本地时间，返回自1970-01-01 UTC起的微秒数
+static bool parseLocalTime(std::string_view text, std::int64_t& micros)
+{
+    std::tm local{};
+    std::istringstream stream{ std::string(text) };
+    stream >> std::get_time(&local, "%Y-%m-%d %H:%M:%S");
+    if (stream.fail()) {
+        return false;
+    }
+    
+    int ms = 0;
+    if (stream.peek() == '.') {
+        stream.get();
+        stream >> ms;
+        if (stream.fail() || ms < 0 || ms > 999) {
+            return false;
+        }
+    }
+    if (stream.peek() != std::char_traits<char>::eof()) {
+        return false;
+    }
+    
+    local.tm_isdst = -1;
+    std::time_t seconds = std::mktime(&local);
+    if (seconds == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    micros = static_cast<std::int64_t>(seconds) * 1000000 + static_cast<std::int64_t>(ms) * 1000;
+    return true;
+}
+
+// 解析命令行参数
+static bool parseDecodeOptions(int argc, char* argv[], DecodeOptions& options, std::string& error)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--level" || arg == "--from" || arg == "--to" || arg == "--file" || arg == "--output") {
+            if (i + 1 >= argc) {
+                error = std::format("Missing value for {}", arg);
+                return false;
+            }
+            std::string_view value = argv[++i];
+            if (arg == "--level") {
+                options.lowestLevel = LogLineFormatter::findLevel(value);
+                if (options.lowestLevel < 0) {
+                    error = std::format("Unknown level: {}", value);
+                    return false;
+                }
+            } else if (arg == "--from" || arg == "--to") {
+                if (!parseLocalTime(value, arg == "--from" ? options.fromMicros : options.toMicros)) {
+                    error = std::format("{} must be \"YYYY-MM-DD HH:MM:SS[.mmm]\"", arg);
+                    return false;
+                }
+            } else if (arg == "--file") {
+                options.file = value;
+            } else {
+                options.outputPath = value;
+            }
+        } else if (options.inputPath.empty() && !arg.starts_with("--")) {
+            options.inputPath = arg;
+        } else {
+            error = std::format("Unknown option: {}", arg);
+            return false;
+        }
+    }
+    
+    if (options.inputPath.empty()) {
+        error = "Missing binary log file";
+        return false;
+    }
+    return true;
+}
+
+// 获取命令行用法说明
+static std::string decodeUsage(const char* exeName)
+{
+    return std::format("Usage: {} LOG_FILE [--level Trace|Debug|Info|Warning|Error|Fatal] [--from TIME] [--to TIME] [--file SOURCE_FILE] [--output FILE]\n"
+                       "       TIME is local time \"YYYY-MM-DD HH:MM:SS[.mmm]\"", exeName);
+}
+
+// 把二进制日志还原为Logger的文本格式，按级别、时间范围与源文件过滤
+int main(int argc, char* argv[])
+{
+    DecodeOptions options;
+    std::string optionError;
+    if (!parseDecodeOptions(argc, argv, options, optionError)) {
+        std::cerr << optionError << std::endl << decodeUsage(argv[0]) << std::endl;
+        return 1;
+    }
+    
+    std::ifstream input(options.inputPath, std::ios::in | std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Failed to open: " << options.inputPath << std::endl;
+        return 1;
+    }
+    std::ofstream outputFile;
+    if (!options.outputPath.empty()) {
+        outputFile.open(options.outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outputFile.is_open()) {
+            std::cerr << "Failed to open: " << options.outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = options.outputPath.empty() ? std::cout : outputFile;
+    
+    BinaryLogReader reader(input);
+    BinaryLogEntry entry;
+    LogLineFormatter formatter;
+    std::string buffer;
+    std::size_t decoded = 0;
+    std::size_t written = 0;
+    while (reader.next(entry)) {
+        ++decoded;
+        if (entry.level < options.lowestLevel || entry.micros < options.fromMicros || entry.micros > options.toMicros ||
+            (!options.file.empty() && entry.file != options.file)) {
+            continue;
+        }
+        
+        LogLinePrefix prefix;
+        prefix.level = entry.level;
+        prefix.time = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(entry.micros)));
+        prefix.file = entry.file;
+        prefix.line = entry.line;
+        prefix.function = entry.function;
+        formatter.appendPrefix(buffer, prefix);
+        formatBinaryLogMessage(buffer, entry.format, entry.args);
+        buffer += '\n';
+        ++written;
+        
+        if (buffer.size() >= kDecodeFlushSize) {
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    output.flush();
+    
+    // 最后一条记录被截断（程序异常退出时常见）也报告为错误，之前的日志已经输出
+    if (!reader.getError().empty()) {
+        std::cerr << std::format("{}: {} after {} messages", options.inputPath, reader.getError(), decoded) << std::endl;
+        return 1;
+    }
+    std::cerr << std::format("{} of {} messages written", written, decoded) << std::endl;
+    return 0;
+}
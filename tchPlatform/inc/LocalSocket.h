@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace tch {
+
+// 本机流式套接字（Unix域套接字），用于同一台机器上的进程间通信
+class LocalSocket {
+public:
+    LocalSocket() = default;
+    ~LocalSocket();
+    
+    // 禁止拷贝，允许移动
+    LocalSocket(const LocalSocket&) = delete;
+    LocalSocket& operator=(const LocalSocket&) = delete;
+    LocalSocket(LocalSocket&& other) noexcept;
+    LocalSocket& operator=(LocalSocket&& other) noexcept;
+    
+    // 在path上监听，路径上遗留的套接字文件会被替换
+    bool listen(const std::string& path);
+    
+    // 等待一个连接，失败或监听被中断时返回未打开的套接字
+    LocalSocket accept();
+    
+    // 读取最多size字节，返回读取的字节数，0表示对端已关闭，-1表示出错
+    std::ptrdiff_t read(char* buffer, std::size_t size);
+    
+    // 写入全部数据
+    bool writeAll(std::string_view data);
+    
+    // 中断阻塞在accept或read上的调用，可从其他线程调用
+    void shutdown();
+    
+    // 关闭套接字，监听套接字同时删除套接字文件
+    void close();
+    
+    // 是否已打开
+    bool isOpen() const {
+        return m_handle != kInvalidHandle;
+    }
+
+private:
+    static constexpr std::intptr_t kInvalidHandle = -1;
+    
+    explicit LocalSocket(std::intptr_t handle) : m_handle(handle) {}
+    
+    std::intptr_t m_handle = kInvalidHandle; // 套接字句柄
+    std::string m_listenPath;                // 监听路径，关闭时删除
+};
+
+} // namespace tch
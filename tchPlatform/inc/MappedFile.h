@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace tch {
+
+// 只读内存映射文件，文件内容由操作系统按需换入，不占用进程堆内存
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    
+    // 禁止拷贝，允许移动
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    
+    // 以只读方式映射文件，空文件也视为成功
+    bool open(const std::string& filePath);
+    
+    // 解除映射
+    void close();
+    
+    // 是否已映射
+    bool isOpen() const {
+        return m_isOpen;
+    }
+    
+    // 获取映射内容
+    std::string_view view() const {
+        return std::string_view(m_data, m_size);
+    }
+    
+    const char* data() const {
+        return m_data;
+    }
+    
+    std::size_t size() const {
+        return m_size;
+    }
+    
+    // 获取映射的文件路径
+    const std::string& getFilePath() const {
+        return m_filePath;
+    }
+
+private:
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_isOpen = false;
+    std::string m_filePath;
+    
+    // 平台相关的解除映射
+    void unmap();
+};
+
+} // namespace tch
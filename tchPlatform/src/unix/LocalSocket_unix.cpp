@@ -0,0 +1,138 @@
+#include "LocalSocket.h"
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace tch {
+
+namespace {
+
+// 子进程不继承套接字；macOS没有MSG_NOSIGNAL，改为在套接字上屏蔽SIGPIPE
+void configureSocket(int fd) {
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+} // namespace
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, kInvalidHandle))
+    , m_listenPath(std::move(other.m_listenPath)) {
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_handle = std::exchange(other.m_handle, kInvalidHandle);
+        m_listenPath = std::move(other.m_listenPath);
+    }
+    return *this;
+}
+
+// 在path上监听
+bool LocalSocket::listen(const std::string& path) {
+    close();
+    
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    configureSocket(fd);
+    
+    // 上次异常退出可能遗留套接字文件
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    m_handle = fd;
+    m_listenPath = path;
+    return true;
+}
+
+// 等待一个连接
+LocalSocket LocalSocket::accept() {
+    while (isOpen()) {
+        int fd = ::accept(static_cast<int>(m_handle), nullptr, nullptr);
+        if (fd >= 0) {
+            configureSocket(fd);
+            return LocalSocket(fd);
+        }
+        if (errno != EINTR) {
+            break;
+        }
+    }
+    return LocalSocket();
+}
+
+// 读取数据
+std::ptrdiff_t LocalSocket::read(char* buffer, std::size_t size) {
+    while (true) {
+        ssize_t count = ::recv(static_cast<int>(m_handle), buffer, size, 0);
+        if (count >= 0 || errno != EINTR) {
+            return count;
+        }
+    }
+}
+
+// 写入全部数据
+bool LocalSocket::writeAll(std::string_view data) {
+    while (!data.empty()) {
+        // 对端已关闭时返回错误而不是触发SIGPIPE
+        ssize_t count = ::send(static_cast<int>(m_handle), data.data(), data.size(), kSendFlags);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(count));
+    }
+    return true;
+}
+
+// 中断阻塞的调用
+void LocalSocket::shutdown() {
+    if (isOpen()) {
+        ::shutdown(static_cast<int>(m_handle), SHUT_RDWR);
+    }
+}
+
+// 关闭套接字
+void LocalSocket::close() {
+    if (isOpen()) {
+        ::close(static_cast<int>(m_handle));
+        m_handle = kInvalidHandle;
+    }
+    if (!m_listenPath.empty()) {
+        ::unlink(m_listenPath.c_str());
+        m_listenPath.clear();
+    }
+}
+
+} // namespace tch
@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tch {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_isOpen(std::exchange(other.m_isOpen, false))
+    , m_filePath(std::move(other.m_filePath)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_isOpen = std::exchange(other.m_isOpen, false);
+        m_filePath = std::move(other.m_filePath);
+    }
+    return *this;
+}
+
+// 以只读方式映射文件
+bool MappedFile::open(const std::string& filePath) {
+    close();
+    
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    if (size > 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        // 顺序解析为主，提示内核预读
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(addr);
+    }
+    // 映射建立后即可关闭文件描述符
+    ::close(fd);
+    
+    m_size = size;
+    m_isOpen = true;
+    m_filePath = filePath;
+    return true;
+}
+
+// 解除映射
+void MappedFile::close() {
+    unmap();
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+    m_filePath.clear();
+}
+
+void MappedFile::unmap() {
+    if (m_data && m_size > 0) {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+} // namespace tch
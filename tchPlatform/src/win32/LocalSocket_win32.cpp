@@ -0,0 +1,142 @@
+#include "LocalSocket.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+
+namespace tch {
+
+namespace {
+
+// Winsock只需初始化一次，进程退出时由系统回收
+bool ensureWinsock() {
+    static std::once_flag s_once;
+    static bool s_ready = false;
+    std::call_once(s_once, [] {
+        WSADATA data;
+        s_ready = ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    });
+    return s_ready;
+}
+
+SOCKET toSocket(std::intptr_t handle) {
+    return static_cast<SOCKET>(handle);
+}
+
+} // namespace
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, kInvalidHandle))
+    , m_listenPath(std::move(other.m_listenPath)) {
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_handle = std::exchange(other.m_handle, kInvalidHandle);
+        m_listenPath = std::move(other.m_listenPath);
+    }
+    return *this;
+}
+
+// 在path上监听（需要Windows 10 1803及以上版本的AF_UNIX支持）
+bool LocalSocket::listen(const std::string& path) {
+    close();
+    if (!ensureWinsock()) {
+        return false;
+    }
+    
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    
+    SOCKET socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket == INVALID_SOCKET) {
+        return false;
+    }
+    
+    // 上次异常退出可能遗留套接字文件
+    ::DeleteFileA(path.c_str());
+    if (::bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(socket, SOMAXCONN) != 0) {
+        ::closesocket(socket);
+        return false;
+    }
+    
+    m_handle = static_cast<std::intptr_t>(socket);
+    m_listenPath = path;
+    return true;
+}
+
+// 等待一个连接
+LocalSocket LocalSocket::accept() {
+    if (!isOpen()) {
+        return LocalSocket();
+    }
+    SOCKET socket = ::accept(toSocket(m_handle), nullptr, nullptr);
+    if (socket == INVALID_SOCKET) {
+        return LocalSocket();
+    }
+    return LocalSocket(static_cast<std::intptr_t>(socket));
+}
+
+// 读取数据
+std::ptrdiff_t LocalSocket::read(char* buffer, std::size_t size) {
+    int count = ::recv(toSocket(m_handle), buffer, static_cast<int>(std::min<std::size_t>(size, INT_MAX)), 0);
+    return count == SOCKET_ERROR ? -1 : count;
+}
+
+// 写入全部数据
+bool LocalSocket::writeAll(std::string_view data) {
+    while (!data.empty()) {
+        int count = ::send(toSocket(m_handle), data.data(), static_cast<int>(std::min<std::size_t>(data.size(), INT_MAX)), 0);
+        if (count == SOCKET_ERROR) {
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(count));
+    }
+    return true;
+}
+
+// 中断阻塞的调用
+void LocalSocket::shutdown() {
+    if (!isOpen()) {
+        return;
+    }
+    // 监听套接字上的accept只能通过关闭句柄中断
+    if (!m_listenPath.empty()) {
+        ::closesocket(toSocket(std::exchange(m_handle, kInvalidHandle)));
+    } else {
+        ::shutdown(toSocket(m_handle), SD_BOTH);
+    }
+}
+
+// 关闭套接字
+void LocalSocket::close() {
+    if (isOpen()) {
+        ::closesocket(toSocket(m_handle));
+        m_handle = kInvalidHandle;
+    }
+    if (!m_listenPath.empty()) {
+        ::DeleteFileA(m_listenPath.c_str());
+        m_listenPath.clear();
+    }
+}
+
+} // namespace tch
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+#include <utility>
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+namespace tch {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_isOpen(std::exchange(other.m_isOpen, false))
+    , m_filePath(std::move(other.m_filePath)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_isOpen = std::exchange(other.m_isOpen, false);
+        m_filePath = std::move(other.m_filePath);
+    }
+    return *this;
+}
+
+// 以只读方式映射文件
+bool MappedFile::open(const std::string& filePath) {
+    close();
+    
+    HANDLE file = ::CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(file, &fileSize)) {
+        ::CloseHandle(file);
+        return false;
+    }
+    
+    std::size_t size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (size > 0) {
+        HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            ::CloseHandle(file);
+            return false;
+        }
+        void* addr = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // 视图建立后即可关闭映射与文件句柄，视图本身保持映射对象存活
+        ::CloseHandle(mapping);
+        if (!addr) {
+            ::CloseHandle(file);
+            return false;
+        }
+        m_data = static_cast<const char*>(addr);
+    }
+    ::CloseHandle(file);
+    
+    m_size = size;
+    m_isOpen = true;
+    m_filePath = filePath;
+    return true;
+}
+
+// 解除映射
+void MappedFile::close() {
+    unmap();
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+    m_filePath.clear();
+}
+
+void MappedFile::unmap() {
+    if (m_data && m_size > 0) {
+        ::UnmapViewOfFile(m_data);
+    }
+}
+
+} // namespace tch